@@ -45,7 +45,7 @@ net::awaitable<void> do_http_recv(http_server_ex& server, std::shared_ptr<net::h
 		// Send the response
 		if (need_response)
 		{
-			auto [e2, n2] = co_await beast::async_write(session->socket, std::move(rep));
+			auto [e2, n2] = co_await http::async_write_response(session->socket, std::move(rep));
 			if (e2)
 				break;
 		}
@@ -1,5 +1,6 @@
 #include <asio3/core/fmt.hpp>
 #include <asio3/http/http_server.hpp>
+#include <asio3/http/sse.hpp>
 
 #ifdef ASIO_STANDALONE
 namespace net = ::asio;
@@ -7,56 +8,6 @@ namespace net = ::asio;
 namespace net = boost::asio;
 #endif
 
-net::awaitable<void> do_http_recv(net::http_server& server, std::shared_ptr<net::http_session> session)
-{
-	// This buffer is required to persist across reads
-	beast::flat_buffer buf;
-
-	for (;;)
-	{
-		// Read a request
-		http::web_request req;
-		auto [e1, n1] = co_await http::async_read(session->socket, buf, req);
-		if (e1)
-			break;
-
-		session->update_alive_time();
-
-		http::web_response rep;
-		bool result = co_await server.router.route(req, rep);
-
-		// Send the response
-		auto [e2, n2] = co_await beast::async_write(session->socket, std::move(rep));
-		if (e2)
-			break;
-
-		if (!result || !req.keep_alive())
-		{
-			// This means we should close the connection, usually because
-			// the response indicated the "Connection: close" semantic.
-			break;
-		}
-	}
-
-	session->close();
-}
-
-net::awaitable<void> client_join(net::http_server& server, std::shared_ptr<net::http_session> session)
-{
-	auto addr = session->get_remote_address();
-	auto port = session->get_remote_port();
-
-	fmt::print("+ client join: {} {}\n", addr, port);
-
-	co_await server.session_map.async_add(session);
-
-	co_await(do_http_recv(server, session) || net::watchdog(session->alive_time, net::http_idle_timeout));
-
-	co_await server.session_map.async_remove(session);
-
-	fmt::print("- client exit: {} {}\n", addr, port);
-}
-
 net::awaitable<void> start_server(net::http_server& server, std::string listen_address, std::uint16_t listen_port)
 {
 	auto [ec, ep] = co_await server.async_listen(listen_address, listen_port);
@@ -68,19 +19,21 @@ net::awaitable<void> start_server(net::http_server& server, std::string listen_a
 
 	fmt::print("listen success: {} {}\n", server.get_listen_address(), server.get_listen_port());
 
-	while (!server.is_aborted())
-	{
-		auto [e1, client] = co_await server.acceptor.async_accept();
-		if (e1)
-		{
-			co_await net::delay(std::chrono::milliseconds(100));
-		}
-		else
-		{
-			net::co_spawn(server.get_executor(), client_join(server,
-				std::make_shared<net::http_session>(std::move(client))), net::detached);
-		}
-	}
+	// read ahead the pipelined requests, limit the request size and close the idle connections.
+	// the connections which start with the preface of HTTP/2 are served as HTTP/2 connections,
+	// eg: curl --http2-prior-knowledge http://127.0.0.1:8080/
+	net::http_serve_option opt;
+	opt.max_requests = 1000;
+	opt.body_limit = 16 * 1024 * 1024;
+	opt.stream_body_limit = 4ull * 1024 * 1024 * 1024;
+
+	// close the clients which send the body too slowly, and answer 503 if a handler hangs.
+	opt.min_body_rate = 1024;
+	opt.handler_timeout = std::chrono::seconds(60);
+
+	auto [e1] = co_await server.async_serve(opt);
+
+	fmt::print("serve finished: {}\n", e1.message());
 }
 
 auto response_404()
@@ -113,7 +66,7 @@ int main()
 
 	server.router.add("/", [&server](http::web_request& req, http::web_response& rep) -> net::awaitable<bool>
 	{
-		auto res = http::make_file_response(server.webroot, "/index.html");
+		auto res = http::make_native_file_response(server.webroot, "/index.html");
 		if (res.has_value())
 			rep = std::move(res.value());
 		else
@@ -127,21 +80,109 @@ int main()
 		co_return true;
 	}, aop_auth{});
 
+	server.router.add("/user/:id", [](http::web_request& req, http::web_response& rep,
+		const http::path_params& params) -> net::awaitable<bool>
+	{
+		// compressed with gzip or deflate if the client accepts it and the body is big enough.
+		rep = http::make_compressed_response(req,
+			http::make_text_response(std::string("user id: ") + std::string(params["id"])));
+		co_return true;
+	});
+
+	// the body of the upload is pulled chunk by chunk instead of being read into the memory,
+	// eg: curl --data-binary @file http://127.0.0.1:8080/upload
+	server.router.add<http::verb::post, http::verb::put>("/upload", [](http::web_request& req, http::web_response& rep,
+		http::body_reader& body) -> net::awaitable<bool>
+	{
+		std::array<char, 16 * 1024> buf;
+		std::uint64_t total = 0;
+
+		for (;;)
+		{
+			auto [ec, n] = co_await body.async_read_some(net::buffer(buf));
+			if (ec)
+				co_return false;
+			if (n == 0)
+				break;
+			total += n;
+		}
+
+		rep = http::make_text_response("received " + std::to_string(total) + " bytes");
+		co_return true;
+	});
+
+	// the parts of the form are parsed while the body is pulled, the text fields are kept in
+	// the memory and the files are written to the temp directory directly,
+	// eg: curl -F name=test -F file=@file http://127.0.0.1:8080/form
+	server.router.add<http::verb::post>("/form", [](http::web_request& req, http::web_response& rep,
+		http::body_reader& body) -> net::awaitable<bool>
+	{
+		std::map<std::string, std::string> fields;
+		std::vector<std::string> files;
+
+		auto ec = co_await http::async_read_multipart(body, http::multipart_boundary(req[http::field::content_type]),
+			[&fields, &files](const http::multipart_part_header& part) -> std::unique_ptr<http::multipart_sink>
+		{
+			if (part.filename.empty())
+				return std::make_unique<http::multipart_memory_sink>(fields[std::string(part.name)], 4096);
+
+			// never trust the path of the filename.
+			auto filepath = std::filesystem::temp_directory_path() /
+				std::filesystem::path(part.filename).filename();
+			files.emplace_back(filepath.string());
+			return std::make_unique<http::multipart_file_sink>(filepath.string());
+		});
+
+		if (ec)
+		{
+			rep = http::make_error_page_response(ec == http::error::body_limit ?
+				http::status::payload_too_large : http::status::bad_request);
+			co_return true;
+		}
+
+		rep = http::make_text_response("received " + std::to_string(fields.size()) + " fields and " +
+			std::to_string(files.size()) + " files");
+		co_return true;
+	});
+
+	// the events of the channel are pushed to the subscribers with the text/event-stream,
+	// eg: curl -N http://127.0.0.1:8080/events
+	http::sse_hub hub;
+
+	server.router.add("/events", [&hub](http::web_request& req, http::web_response& rep) -> net::awaitable<bool>
+	{
+		rep = http::make_sse_response(hub.subscribe(co_await net::this_coro::executor, "clock", req));
+		co_return true;
+	});
+
+	// the static files are served by the open file cache, which also answers the Range requests.
 	server.router.add("*", [&server](http::web_request& req, http::web_response& rep) -> net::awaitable<bool>
 	{
-		auto res = http::make_file_response(server.webroot, req.target());
+		auto res = http::make_file_response(server.file_cache, server.webroot, req);
 		if (res.has_value())
 			rep = std::move(res.value());
 		else
 			rep = response_404();
 		co_return true;
-	}, http::enable_cache);
+	});
+
+	// all routes are added, build the perfect hash table of the static routes.
+	server.router.freeze();
 
 	net::co_spawn(ctx.get_executor(), start_server(server, "0.0.0.0", 8080), net::detached);
 
+	// publish the current time to the subscribers every second.
+	auto clock = net::create_timer(ctx.get_executor(), std::chrono::seconds(1), [&hub]() -> net::awaitable<bool>
+	{
+		hub.publish("clock", http::current_date());
+		co_return true;
+	});
+
 	net::signal_set sigset(ctx.get_executor(), SIGINT);
-	sigset.async_wait([&server](net::error_code, int) mutable
+	sigset.async_wait([&server, &hub, clock](net::error_code, int) mutable
 	{
+		clock->cancel();
+		hub.close();
 		server.async_stop([](auto) {});
 	});
 
@@ -39,9 +39,12 @@ net::awaitable<void> do_recv(net::rpc_server& server, std::shared_ptr<net::rpc_s
 	std::string strbuf;
 	rpc::serializer& sr = session->serializer;
 	rpc::deserializer& dr = session->deserializer;
+	std::chrono::steady_clock::time_point recv_time{};
 
 	for (;;)
 	{
+		std::size_t buffered = strbuf.size();
+
 		auto [e1, n1] = co_await net::async_read_until(
 			session->get_stream(), net::dynamic_buffer(strbuf), net::length_payload_match_condition{});
 		if (e1)
@@ -49,6 +52,11 @@ net::awaitable<void> do_recv(net::rpc_server& server, std::shared_ptr<net::rpc_s
 		if (n1 == 0)
 			break;
 
+		// the requests which were received together wait behind the previous ones, so their
+		// queueing delay is counted from the time when they were received.
+		if (n1 > buffered)
+			recv_time = std::chrono::steady_clock::now();
+
 		session->update_alive_time();
 
 		std::string_view data = net::length_payload_match_condition::get_payload(strbuf.data(), n1);
@@ -66,7 +74,8 @@ net::awaitable<void> do_recv(net::rpc_server& server, std::shared_ptr<net::rpc_s
 
 		if (head.is_request())
 		{
-			auto [e2, resp] = co_await server.invoker.invoke(sr, dr, std::move(head), data);
+			// the request which has been queued too long is answered with rpc::error::overloaded.
+			auto [e2, resp] = co_await server.invoker.invoke(recv_time, sr, dr, std::move(head), data);
 
 			if (!resp.empty())
 			{
@@ -79,7 +88,7 @@ net::awaitable<void> do_recv(net::rpc_server& server, std::shared_ptr<net::rpc_s
 				co_await session->async_send(buffers);
 			}
 
-			if (e2)
+			if (e2 && e2 != rpc::make_error_code(rpc::error::overloaded))
 				break;
 		}
 		else if (head.is_response())
@@ -146,6 +155,9 @@ int main()
 
 	server.invoker.bind("echo", echo);
 
+	// shed the requests when they are queued longer than 5ms for more than 100ms.
+	server.invoker.get_admission_controller().set_option({ .enabled = true });
+
 	net::co_spawn(listen_ctx.get_executor(), start_server(session_ctxs, server, "0.0.0.0", 8038), net::detached);
 
 	net::signal_set sigset(listen_ctx.get_executor(), SIGINT);
@@ -12,68 +12,6 @@ namespace net = ::asio;
 namespace net = boost::asio;
 #endif
 
-net::awaitable<void> do_http_recv(net::https_server& server, std::shared_ptr<net::https_session> session)
-{
-	// This buffer is required to persist across reads
-	beast::flat_buffer buf;
-
-	for (;;)
-	{
-		// Read a request
-		http::web_request req;
-		auto [e1, n1] = co_await http::async_read(session->ssl_stream, buf, req);
-		if (e1)
-			break;
-
-		session->update_alive_time();
-
-		http::web_response rep;
-		bool result = co_await server.router.route(req, rep);
-
-		// Send the response
-		auto [e2, n2] = co_await beast::async_write(session->ssl_stream, std::move(rep));
-		if (e2)
-			break;
-
-		if (!result || !req.keep_alive())
-		{
-			// This means we should close the connection, usually because
-			// the response indicated the "Connection: close" semantic.
-			break;
-		}
-	}
-
-	co_await session->ssl_stream.async_shutdown();
-
-	session->close();
-}
-
-net::awaitable<void> client_join(net::https_server& server, std::shared_ptr<net::https_session> session)
-{
-	session->socket.set_option(net::ip::tcp::no_delay(true));
-	session->socket.set_option(net::socket_base::keep_alive(true));
-
-	auto [e2] = co_await net::async_handshake(session->ssl_stream, net::ssl::stream_base::handshake_type::server);
-	if (e2)
-	{
-		fmt::print("handshake failure: {}\n", e2.message());
-		co_return;
-	}
-
-	auto addr = session->get_remote_address();
-	auto port = session->get_remote_port();
-
-	fmt::print("+ client join: {} {}\n", addr, port);
-
-	co_await server.session_map.async_add(session);
-
-	co_await(do_http_recv(server, session) || net::watchdog(session->alive_time, net::http_idle_timeout));
-
-	co_await server.session_map.async_remove(session);
-
-	fmt::print("- client exit: {} {}\n", addr, port);
-}
-
 net::awaitable<void> start_server(net::https_server& server, std::string listen_address, std::uint16_t listen_port)
 {
 	auto [ec, ep] = co_await server.async_listen(listen_address, listen_port);
@@ -85,19 +23,14 @@ net::awaitable<void> start_server(net::https_server& server, std::string listen_
 
 	fmt::print("listen success: {} {}\n", server.get_listen_address(), server.get_listen_port());
 
-	while (!server.is_aborted())
-	{
-		auto [e1, client] = co_await server.acceptor.async_accept();
-		if (e1)
-		{
-			co_await net::delay(std::chrono::milliseconds(100));
-		}
-		else
-		{
-			net::co_spawn(server.get_executor(), client_join(server,
-				std::make_shared<net::https_session>(std::move(client), server.ssl_context)), net::detached);
-		}
-	}
+	// "h2" is offered by ALPN, the browsers which support HTTP/2 multiplex the requests on
+	// one connection, eg: curl -k --http2 https://127.0.0.1:8443/
+	net::http_serve_option opt;
+	opt.enable_http2 = true;
+
+	auto [e1] = co_await server.async_serve(opt);
+
+	fmt::print("serve finished: {}\n", e1.message());
 }
 
 auto response_404()
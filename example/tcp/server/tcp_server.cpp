@@ -60,19 +60,10 @@ net::awaitable<void> start_server(net::tcp_server& server, net::timer_map& timer
 
 	auto [timer_ptr] = co_await timers.async_find("1");
 
-	while (!server.is_aborted())
+	co_await server.async_serve([&server](net::tcp_socket sock) -> net::awaitable<void>
 	{
-		auto [e1, client] = co_await server.acceptor.async_accept();
-		if (e1)
-		{
-			co_await net::delay(std::chrono::milliseconds(100));
-		}
-		else
-		{
-			net::co_spawn(server.get_executor(), client_join(server,
-				std::make_shared<net::tcp_session>(std::move(client))), net::detached);
-		}
-	}
+		co_await client_join(server, std::make_shared<net::tcp_session>(std::move(sock)));
+	});
 }
 
 int main()
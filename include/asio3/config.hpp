@@ -19,6 +19,15 @@
 // ssl must be before crypto.
 //#define ASIO3_ENABLE_SSL
 
+// Define ASIO3_ENABLE_IO_URING to use io_uring instead of epoll as the linux backend of the
+// io_context. All socket, acceptor, timer and file operations are then submitted through the
+// io_uring, and multiple operations that become ready at the same time are completed by one
+// io_uring_enter call. This requires linux kernel 5.10 or later and liburing, and the linker
+// need "uring" (cmake : -DASIO3_ENABLE_IO_URING=ON).
+// Note : asio::stream_file and asio::random_access_file on linux are only available when the
+// io_uring is enabled, so the functions in /asio3/core/file.hpp require this macro on linux.
+//#define ASIO3_ENABLE_IO_URING
+
 // Define ASIO_NO_EXCEPTIONS to disable the exception. so when the exception occurs, you can
 // check the stack trace.
 // If the ASIO_NO_EXCEPTIONS is defined, you can impl the throw_exception function by youself,
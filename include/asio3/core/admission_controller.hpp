@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2017-2023 zhllxt
+ *
+ * author   : zhllxt
+ * email    : 37792738@qq.com
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include <asio3/core/asio.hpp>
+
+#ifdef ASIO_STANDALONE
+namespace asio
+#else
+namespace boost::asio
+#endif
+{
+	struct admission_option
+	{
+		// The admission control is disabled by default, all the requests are admitted.
+		bool enabled = false;
+
+		// The acceptable queueing delay of the requests, while the server is overloaded, the
+		// requests which have been queued longer than it are shed.
+		std::chrono::steady_clock::duration target = std::chrono::milliseconds(5);
+
+		// The server is overloaded when the minimum queueing delay of the requests in the last
+		// interval is above the target, that is, the queue hasn't been drained in the interval.
+		std::chrono::steady_clock::duration interval = std::chrono::milliseconds(100);
+	};
+
+	/**
+	 * @brief Request level overload control based on the CoDel algorithm, as it is applied
+	 * to the request queues of the RPC servers.
+	 * The queueing delay of a request is the duration between the request is parsed and
+	 * the handler of the request is started. The minimum queueing delay of each interval is
+	 * tracked, if it stays above the target for a whole interval, the queue is a standing
+	 * one, and in the next interval every request which has been queued longer than the
+	 * target is shed. So a short burst is absorbed, but a standing queue is drained quickly
+	 * with fast failures instead of timing out everything, however high the request rate is.
+	 * The controller is shared by all the sessions of a server, so the MutexT must be a real
+	 * mutex if the sessions run in more than one thread.
+	 * see: https://queue.acm.org/detail.cfm?id=2209336
+	 */
+	template<class MutexT>
+	class basic_admission_controller
+	{
+	public:
+		using clock_type = std::chrono::steady_clock;
+		using time_point = clock_type::time_point;
+		using duration   = clock_type::duration;
+		using mutex_type = MutexT;
+
+		/**
+		 * @brief constructor
+		 */
+		basic_admission_controller() = default;
+
+		/**
+		 * @brief constructor
+		 */
+		explicit basic_admission_controller(admission_option opt)
+			: option_(std::move(opt)), enabled_(option_.enabled)
+		{
+		}
+
+		/**
+		 * @brief destructor
+		 */
+		~basic_admission_controller() = default;
+
+		/**
+		 * @brief Check whether the request should be handled or shed.
+		 * @param queue_delay - The duration between the request is parsed and now.
+		 * @return true if the request should be handled, false if it should be shed.
+		 */
+		inline bool admit(duration queue_delay, time_point now = clock_type::now())
+		{
+			if (!this->enabled_.load(std::memory_order_relaxed))
+				return true;
+
+			std::lock_guard guard(this->mutex_);
+
+			if (now >= this->interval_end_)
+			{
+				// no request in the whole last interval means the queue was empty.
+				bool idle = now - this->interval_end_ >= this->option_.interval;
+
+				this->overloaded_ = !idle && this->min_delay_ > this->option_.target;
+				this->min_delay_ = queue_delay;
+				this->interval_end_ = now + this->option_.interval;
+			}
+			else if (queue_delay < this->min_delay_)
+			{
+				this->min_delay_ = queue_delay;
+			}
+
+			if (this->overloaded_ && queue_delay > this->option_.target)
+			{
+				++this->dropped_;
+				return false;
+			}
+
+			return true;
+		}
+
+		/**
+		 * @brief Get the total count of the shed requests.
+		 */
+		inline std::uint64_t dropped_count() const noexcept
+		{
+			std::lock_guard guard(this->mutex_);
+			return this->dropped_;
+		}
+
+		/**
+		 * @brief Set the admission options.
+		 */
+		inline void set_option(admission_option opt)
+		{
+			std::lock_guard guard(this->mutex_);
+			this->option_ = std::move(opt);
+			this->interval_end_ = time_point{};
+			this->min_delay_ = duration::zero();
+			this->overloaded_ = false;
+			this->enabled_.store(this->option_.enabled, std::memory_order_relaxed);
+		}
+
+		/**
+		 * @brief Get the admission options.
+		 */
+		inline admission_option get_option() const
+		{
+			std::lock_guard guard(this->mutex_);
+			return this->option_;
+		}
+
+	protected:
+		mutable MutexT    mutex_;
+
+		admission_option  option_{};
+
+		std::atomic<bool> enabled_{ false };
+
+		time_point        interval_end_{};
+
+		duration          min_delay_{};
+
+		std::uint64_t     dropped_ = 0;
+
+		bool              overloaded_ = false;
+	};
+
+	using admission_controller = basic_admission_controller<std::mutex>;
+}
@@ -26,6 +26,24 @@
 #  endif
 #endif
 
+#if defined(ASIO3_ENABLE_IO_URING) && defined(__linux__)
+#  ifdef ASIO_STANDALONE
+#    ifndef ASIO_HAS_IO_URING
+#    define ASIO_HAS_IO_URING 1
+#    endif
+#    ifndef ASIO_DISABLE_EPOLL
+#    define ASIO_DISABLE_EPOLL 1
+#    endif
+#  else
+#    ifndef BOOST_ASIO_HAS_IO_URING
+#    define BOOST_ASIO_HAS_IO_URING 1
+#    endif
+#    ifndef BOOST_ASIO_DISABLE_EPOLL
+#    define BOOST_ASIO_DISABLE_EPOLL 1
+#    endif
+#  endif
+#endif
+
 #include <asio3/core/detail/push_options.hpp>
 
 #ifdef ASIO_STANDALONE
@@ -119,6 +137,15 @@
 	#if !defined(ASIO_SYNC_OP_VOID_RETURN) && defined(BOOST_ASIO_SYNC_OP_VOID_RETURN)
 	#define ASIO_SYNC_OP_VOID_RETURN BOOST_ASIO_SYNC_OP_VOID_RETURN
 	#endif
+	#if !defined(ASIO_HAS_IO_URING) && defined(BOOST_ASIO_HAS_IO_URING)
+	#define ASIO_HAS_IO_URING BOOST_ASIO_HAS_IO_URING
+	#endif
+	#if !defined(ASIO_HAS_IO_URING_AS_DEFAULT) && defined(BOOST_ASIO_HAS_IO_URING_AS_DEFAULT)
+	#define ASIO_HAS_IO_URING_AS_DEFAULT BOOST_ASIO_HAS_IO_URING_AS_DEFAULT
+	#endif
+	#if !defined(ASIO_HAS_FILE) && defined(BOOST_ASIO_HAS_FILE)
+	#define ASIO_HAS_FILE BOOST_ASIO_HAS_FILE
+	#endif
 #endif // ASIO_STANDALONE
 
 #ifdef ASIO_STANDALONE
@@ -0,0 +1,376 @@
+/*
+ * Copyright (c) 2017-2023 zhllxt
+ *
+ * author   : zhllxt
+ * email    : 37792738@qq.com
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <asio3/core/asio.hpp>
+
+#ifdef ASIO_STANDALONE
+namespace asio
+#else
+namespace boost::asio
+#endif
+{
+	// The interval of the deadline sweeper, the deadlines are enforced with this precision.
+	constexpr ::std::chrono::milliseconds deadline_sweep_interval = ::std::chrono::milliseconds(250);
+}
+
+#ifdef ASIO_STANDALONE
+namespace asio::detail
+#else
+namespace boost::asio::detail
+#endif
+{
+	/**
+	 * @brief The state of a connection_deadline which is shared with the sweeper. The expiry
+	 * and the throughput fields are written by the owner and read by the sweeper, so they're
+	 * atomic. The sweeper only finds the candidates, the final check and the cancellation is
+	 * done on the executor of the owner.
+	 */
+	struct connection_deadline_state
+	{
+		using clock_type = std::chrono::steady_clock;
+		using rep        = clock_type::rep;
+
+		static constexpr rep never = (std::numeric_limits<rep>::max)();
+
+		explicit connection_deadline_state(asio::any_io_executor ex) : executor(std::move(ex))
+		{
+		}
+
+		inline bool is_due(rep now) const noexcept
+		{
+			if (!this->armed.load(std::memory_order_relaxed))
+				return false;
+
+			if (now >= this->expiry.load(std::memory_order_relaxed))
+				return true;
+
+			std::uint64_t rate = this->min_rate.load(std::memory_order_relaxed);
+			if (rate == 0)
+				return false;
+
+			// the time is only counted while the deadline is armed, that is, while the peer is
+			// waited, and the rate is checked after the grace period.
+			rep elapsed = this->rate_elapsed.load(std::memory_order_relaxed) +
+				(now - this->rate_start.load(std::memory_order_relaxed));
+			if (elapsed <= this->rate_grace.load(std::memory_order_relaxed))
+				return false;
+
+			double seconds = std::chrono::duration<double>(clock_type::duration(elapsed)).count();
+
+			return static_cast<double>(this->bytes.load(std::memory_order_relaxed)) < seconds * static_cast<double>(rate);
+		}
+
+		asio::any_io_executor        executor;
+
+		asio::cancellation_signal    signal;
+
+		std::atomic<bool>            armed{ false };
+
+		std::atomic<rep>             expiry{ never };
+
+		std::atomic<std::uint64_t>   min_rate{ 0 };
+
+		std::atomic<rep>             rate_start{ 0 };
+
+		std::atomic<rep>             rate_elapsed{ 0 };
+
+		std::atomic<rep>             rate_grace{ 0 };
+
+		std::atomic<std::uint64_t>   bytes{ 0 };
+
+		std::atomic<std::uint32_t>   generation{ 0 };
+
+		bool                         expired = false;
+	};
+
+	/**
+	 * @brief The sweeper of the deadlines of one thread. All the deadlines which are created in
+	 * the thread are checked by one timer periodically, so arming a deadline is only a few
+	 * atomic stores instead of starting a timer. The timer is stopped when there is no deadline.
+	 */
+	class deadline_sweeper : public std::enable_shared_from_this<deadline_sweeper>
+	{
+	public:
+		using state_ptr = std::shared_ptr<connection_deadline_state>;
+
+		explicit deadline_sweeper(asio::any_io_executor ex) : timer_(std::move(ex))
+		{
+		}
+
+		/**
+		 * @brief Get the sweeper of the current thread, create it if there isn't one.
+		 */
+		static std::shared_ptr<deadline_sweeper> current(const asio::any_io_executor& ex)
+		{
+			thread_local std::weak_ptr<deadline_sweeper> sweeper;
+
+			std::shared_ptr<deadline_sweeper> p = sweeper.lock();
+			if (!p)
+			{
+				p = std::make_shared<deadline_sweeper>(ex);
+				sweeper = p;
+			}
+			return p;
+		}
+
+		void add(state_ptr s)
+		{
+			std::lock_guard guard{ this->mutex_ };
+
+			this->states_.emplace_back(std::move(s));
+
+			if (!this->running_)
+			{
+				this->running_ = true;
+
+				asio::post(this->timer_.get_executor(), [self = this->shared_from_this()]() mutable
+				{
+					self->start();
+				});
+			}
+		}
+
+		void remove(const connection_deadline_state* s)
+		{
+			std::lock_guard guard{ this->mutex_ };
+
+			for (std::size_t i = 0; i < this->states_.size(); ++i)
+			{
+				if (this->states_[i].get() == s)
+				{
+					this->states_[i] = std::move(this->states_.back());
+					this->states_.pop_back();
+					break;
+				}
+			}
+
+			// stop the timer at once, so the io_context isn't kept running by the sweeper.
+			if (this->states_.empty() && this->running_)
+			{
+				asio::post(this->timer_.get_executor(), [self = this->shared_from_this()]() mutable
+				{
+					std::lock_guard guard{ self->mutex_ };
+					if (self->states_.empty())
+						self->timer_.cancel();
+				});
+			}
+		}
+
+	protected:
+		void start()
+		{
+			this->timer_.expires_after(asio::deadline_sweep_interval);
+			this->timer_.async_wait([self = this->shared_from_this()](const asio::error_code&) mutable
+			{
+				if (self->sweep())
+					self->start();
+			});
+		}
+
+		bool sweep()
+		{
+			std::lock_guard guard{ this->mutex_ };
+
+			if (this->states_.empty())
+			{
+				this->running_ = false;
+				return false;
+			}
+
+			auto now = connection_deadline_state::clock_type::now().time_since_epoch().count();
+
+			for (const state_ptr& s : this->states_)
+			{
+				if (!s->is_due(now))
+					continue;
+
+				asio::post(s->executor, [s, gen = s->generation.load(std::memory_order_relaxed)]() mutable
+				{
+					if (s->generation.load(std::memory_order_relaxed) != gen || s->expired)
+						return;
+
+					if (!s->is_due(connection_deadline_state::clock_type::now().time_since_epoch().count()))
+						return;
+
+					s->expired = true;
+					s->armed.store(false, std::memory_order_relaxed);
+					s->signal.emit(asio::cancellation_type::terminal);
+				});
+			}
+
+			return true;
+		}
+
+	protected:
+		std::mutex                 mutex_;
+
+		asio::steady_timer         timer_;
+
+		std::vector<state_ptr>     states_;
+
+		bool                       running_ = false;
+	};
+}
+
+#ifdef ASIO_STANDALONE
+namespace asio
+#else
+namespace boost::asio
+#endif
+{
+	/**
+	 * @brief The deadline of the operations of a connection, eg: reading the header, reading
+	 * the body, writing the response. The operation is bound to the cancellation slot of the
+	 * deadline, and it's cancelled when the deadline has expired or the throughput is lower
+	 * than the min rate. The deadlines of a thread are checked by one sweeper, no timer is
+	 * started for each operation.
+	 * The deadline must be used in the executor which is passed to the constructor.
+	 * eg:
+	 *   asio::connection_deadline deadline(co_await asio::this_coro::executor);
+	 *   deadline.expires_after(std::chrono::seconds(30));
+	 *   auto [ec, n] = co_await sock.async_read_some(buf, deadline.bind(asio::use_nothrow_awaitable));
+	 *   deadline.expires_never();
+	 *   if (deadline.expired())
+	 *       ec = asio::error::timed_out;
+	 */
+	class connection_deadline
+	{
+	public:
+		using clock_type = std::chrono::steady_clock;
+		using duration   = clock_type::duration;
+
+		/**
+		 * @brief constructor, the deadline isn't armed.
+		 */
+		explicit connection_deadline(asio::any_io_executor ex)
+			: state_(std::make_shared<detail::connection_deadline_state>(ex))
+			, sweeper_(detail::deadline_sweeper::current(ex))
+		{
+			this->sweeper_->add(this->state_);
+		}
+
+		/**
+		 * @brief destructor
+		 */
+		~connection_deadline()
+		{
+			this->sweeper_->remove(this->state_.get());
+		}
+
+		connection_deadline(const connection_deadline&) = delete;
+		connection_deadline& operator=(const connection_deadline&) = delete;
+
+		/**
+		 * @brief Arm the deadline before waiting for the peer, the operations bound to it are
+		 * cancelled after the duration. A zero duration means only the min throughput is checked.
+		 */
+		inline void expires_after(duration d) noexcept
+		{
+			using rep = detail::connection_deadline_state::rep;
+
+			detail::connection_deadline_state& s = *this->state_;
+
+			rep now = clock_type::now().time_since_epoch().count();
+
+			s.expired = false;
+			s.generation.fetch_add(1, std::memory_order_relaxed);
+			s.rate_start.store(now, std::memory_order_relaxed);
+			s.expiry.store(d > duration::zero() && d.count() < s.never - now ? now + d.count() : s.never,
+				std::memory_order_relaxed);
+			s.armed.store(true, std::memory_order_relaxed);
+		}
+
+		/**
+		 * @brief Disarm the deadline after the operation has completed, the time before it's
+		 * armed again isn't counted by the min throughput rule.
+		 */
+		inline void expires_never() noexcept
+		{
+			using rep = detail::connection_deadline_state::rep;
+
+			detail::connection_deadline_state& s = *this->state_;
+
+			s.generation.fetch_add(1, std::memory_order_relaxed);
+
+			if (s.armed.exchange(false, std::memory_order_relaxed))
+			{
+				rep now = clock_type::now().time_since_epoch().count();
+
+				s.rate_elapsed.fetch_add(now - s.rate_start.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			}
+		}
+
+		/**
+		 * @brief Start the min throughput rule, the operations bound to the deadline are also
+		 * cancelled if the average rate of the bytes reported by consume() is lower than the
+		 * min_rate (bytes per second) after the grace period. Only the time while the deadline
+		 * is armed is counted. A zero min_rate stops the rule.
+		 */
+		inline void min_rate(std::uint64_t bytes_per_second, duration grace = duration::zero()) noexcept
+		{
+			detail::connection_deadline_state& s = *this->state_;
+
+			s.bytes.store(0, std::memory_order_relaxed);
+			s.rate_elapsed.store(0, std::memory_order_relaxed);
+			s.rate_start.store(clock_type::now().time_since_epoch().count(), std::memory_order_relaxed);
+			s.rate_grace.store(grace.count(), std::memory_order_relaxed);
+			s.min_rate.store(bytes_per_second, std::memory_order_relaxed);
+		}
+
+		/**
+		 * @brief Report the bytes which have been transferred for the min throughput rule.
+		 */
+		inline void consume(std::size_t bytes) noexcept
+		{
+			this->state_->bytes.fetch_add(bytes, std::memory_order_relaxed);
+		}
+
+		/**
+		 * @brief Returns true if the operations have been cancelled by the deadline since it
+		 * was armed last time.
+		 */
+		inline bool expired() const noexcept
+		{
+			return this->state_->expired;
+		}
+
+		/**
+		 * @brief Get the cancellation slot which the operations should be bound to.
+		 */
+		inline asio::cancellation_slot slot() noexcept
+		{
+			return this->state_->signal.slot();
+		}
+
+		/**
+		 * @brief Bind the completion token to the cancellation slot of the deadline.
+		 */
+		template<class CompletionToken>
+		inline auto bind(CompletionToken&& token) noexcept
+		{
+			return asio::bind_cancellation_slot(this->slot(), std::forward<CompletionToken>(token));
+		}
+
+	protected:
+		std::shared_ptr<detail::connection_deadline_state> state_;
+
+		std::shared_ptr<detail::deadline_sweeper>          sweeper_;
+	};
+}
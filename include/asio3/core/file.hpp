@@ -52,16 +52,38 @@ namespace boost::asio::detail
 			auto fsize = ::std::filesystem::file_size(filepath, ec);
 			if (!ec)
 			{
-				buffer.reserve(::std::size_t(fsize));
+				buffer.resize(::std::size_t(fsize));
 			}
 
 			file.open(filepath, asio::stream_file::read_only, ec);
 
 			if (ec)
 			{
+				buffer.clear();
 				co_return{ ec, ::std::move(file), ::std::move(buffer) };
 			}
 
+			// When the file size is known, read the whole content into the pre-sized buffer, so
+			// the file is read with as few large read operations as possible (with io_uring, each
+			// read operation is a single submission), instead of growing the dynamic buffer chunk
+			// by chunk. The content is the snapshot of the size which was queried, a full read or
+			// a short read at eof both complete it, no extra read is issued just to hit the eof.
+			if (!buffer.empty())
+			{
+				auto [e0, n0] = co_await asio::async_read(
+					file, asio::buffer(buffer), asio::transfer_all(), asio::use_deferred_executor(file));
+
+				buffer.resize(n0);
+
+				if (e0 == asio::error::eof)
+				{
+					e0 = {};
+				}
+
+				co_return{ e0, ::std::move(file), ::std::move(buffer) };
+			}
+
+			// The file size is unknown, eg: the size of the file is zero in the procfs.
 			auto [e1, n1] = co_await asio::async_read(
 				file, asio::dynamic_buffer(buffer), asio::transfer_all(), asio::use_deferred_executor(file));
 
@@ -10,8 +10,102 @@
 
 #pragma once
 
+#include <chrono>
+
 #include <asio3/core/asio.hpp>
 
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#endif
+
+#ifdef ASIO_STANDALONE
+namespace asio
+#else
+namespace boost::asio
+#endif
+{
+	struct busy_poll_option
+	{
+		// How long the thread keeps polling the io_context after the last handler was executed,
+		// before it falls back to block in the run_one() (epoll_wait). Zero means the thread
+		// always blocks in the run(), this is the default run mode.
+		::std::chrono::steady_clock::duration spin_budget = ::std::chrono::microseconds(0);
+	};
+
+	/**
+	 * @brief Set the SO_BUSY_POLL option of the socket, so the kernel busy polls the device
+	 * queue for the duration when there is no data in the socket receive queue.
+	 * @return false if the option is not supported or failed.
+	 */
+	inline bool set_busy_poll([[maybe_unused]] auto& sock, [[maybe_unused]] ::std::chrono::microseconds duration) noexcept
+	{
+	#if defined(SO_BUSY_POLL)
+		asio::error_code ec{};
+		sock.set_option(asio::detail::socket_option::integer<SOL_SOCKET, SO_BUSY_POLL>(
+			static_cast<int>(duration.count())), ec);
+		return !ec;
+	#else
+		return false;
+	#endif
+	}
+}
+
+#ifdef ASIO_STANDALONE
+namespace asio::detail
+#else
+namespace boost::asio::detail
+#endif
+{
+	inline void cpu_relax() noexcept
+	{
+	#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+		_mm_pause();
+	#elif defined(__i386__) || defined(__x86_64__)
+		__builtin_ia32_pause();
+	#elif defined(__aarch64__) || defined(__arm__)
+		asm volatile("yield" ::: "memory");
+	#else
+		::std::this_thread::yield();
+	#endif
+	}
+
+	/**
+	 * @brief Run the io_context in busy poll mode.
+	 * The io_context is polled without blocking, and when there is no ready handler, the
+	 * thread keeps spinning until the spin budget is exhausted, then blocks in the run_one()
+	 * until the next handler is executed. So the wake-up latency of the blocking run (futex
+	 * and epoll_wait) is avoided while the traffic is continuous, at the cost of cpu.
+	 */
+	inline void busy_poll_run(asio::io_context& context, busy_poll_option opt)
+	{
+		auto last_active = ::std::chrono::steady_clock::now();
+
+		while (!context.stopped())
+		{
+			if (context.poll() > 0)
+			{
+				last_active = ::std::chrono::steady_clock::now();
+				continue;
+			}
+
+			if (context.stopped())
+				break;
+
+			if (::std::chrono::steady_clock::now() - last_active < opt.spin_budget)
+			{
+				detail::cpu_relax();
+				continue;
+			}
+
+			// idle for a period, fall back to blocking.
+			if (context.run_one() == 0)
+				break;
+
+			last_active = ::std::chrono::steady_clock::now();
+		}
+	}
+}
+
 #ifdef ASIO_STANDALONE
 namespace asio
 #else
@@ -25,7 +119,20 @@ namespace boost::asio
 		{
 			thread = ::std::thread([this]() mutable
 			{
-				context.run();
+				run();
+			});
+		}
+
+		/**
+		 * @brief Create the thread which runs the io_context in busy poll mode.
+		 * @param opt - The busy poll options, see busy_poll_option.
+		 */
+		explicit io_context_thread(busy_poll_option opt, int concurrency_hint = 1)
+			: context(concurrency_hint), busy_poll(opt)
+		{
+			thread = ::std::thread([this]() mutable
+			{
+				run();
 			});
 		}
 
@@ -61,7 +168,7 @@ namespace boost::asio
 
 			thread = ::std::thread([this]() mutable
 			{
-				context.run();
+				run();
 			});
 		}
 
@@ -73,6 +180,15 @@ namespace boost::asio
 			return context.get_executor();
 		}
 
+	protected:
+		inline void run()
+		{
+			if (busy_poll.spin_budget > ::std::chrono::steady_clock::duration::zero())
+				detail::busy_poll_run(context, busy_poll);
+			else
+				context.run();
+		}
+
 	public:
 		::std::thread        thread{};
 
@@ -80,5 +196,7 @@ namespace boost::asio
 
 		std::unique_ptr<asio::executor_guard> guard{
 			std::make_unique<asio::executor_guard>(context.get_executor()) };
+
+		busy_poll_option     busy_poll{};
 	};
 }
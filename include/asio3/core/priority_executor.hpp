@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2017-2023 zhllxt
+ *
+ * author   : zhllxt
+ * email    : 37792738@qq.com
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include <asio3/core/asio.hpp>
+
+#ifdef ASIO_STANDALONE
+namespace asio
+#else
+namespace boost::asio
+#endif
+{
+	enum class priority : std::uint8_t
+	{
+		low,
+		high,
+	};
+}
+
+#ifdef ASIO_STANDALONE
+namespace asio::detail
+#else
+namespace boost::asio::detail
+#endif
+{
+	/**
+	 * @brief The shared queues of the priority_scheduler and the priority_executors.
+	 * Each submitted handler posts a "run one" token into the underlying io_context, and the
+	 * token executes the highest priority handler which is queued at the time the token runs,
+	 * not necessarily the handler it was posted for. So the handlers are still executed by
+	 * all the threads of the io_context concurrently, but the high priority ones jump ahead.
+	 * Note: the tokens are queued in the FIFO of the io_context together with all the other
+	 * handlers, so a high priority handler only jumps ahead of the handlers which are submitted
+	 * through the priority executors, not ahead of the ordinary io completions.
+	 */
+	class priority_scheduler_state
+	{
+	public:
+		using function_type = std::move_only_function<void()>;
+
+		explicit priority_scheduler_state(std::size_t fairness) : fairness_(fairness)
+		{
+		}
+
+		inline void enqueue(priority p, function_type f)
+		{
+			std::lock_guard guard(this->mutex_);
+
+			if (p == priority::high)
+				this->high_.emplace_back(std::move(f));
+			else
+				this->low_.emplace_back(std::move(f));
+		}
+
+		inline void run_one()
+		{
+			function_type f;
+
+			{
+				std::lock_guard guard(this->mutex_);
+
+				// After "fairness" high priority handlers are executed in a row, a low priority
+				// handler is executed, so the bulk work is never starved.
+				bool take_low = !this->low_.empty() &&
+					(this->high_.empty() || (this->fairness_ && this->high_streak_ >= this->fairness_));
+
+				if (take_low)
+				{
+					f = std::move(this->low_.front());
+					this->low_.pop_front();
+					this->high_streak_ = 0;
+				}
+				else if (!this->high_.empty())
+				{
+					f = std::move(this->high_.front());
+					this->high_.pop_front();
+					++this->high_streak_;
+				}
+			}
+
+			if (f)
+				f();
+		}
+
+		inline std::size_t size(priority p)
+		{
+			std::lock_guard guard(this->mutex_);
+
+			return p == priority::high ? this->high_.size() : this->low_.size();
+		}
+
+	protected:
+		std::mutex                 mutex_;
+
+		std::deque<function_type>  high_;
+
+		std::deque<function_type>  low_;
+
+		std::size_t                fairness_ = 8;
+
+		std::size_t                high_streak_ = 0;
+	};
+}
+
+#ifdef ASIO_STANDALONE
+namespace asio
+#else
+namespace boost::asio
+#endif
+{
+	/**
+	 * @brief An executor which submits the handlers into the high or low priority queue of a
+	 * priority_scheduler. It can be used as the executor of sessions, timers and co_spawn.
+	 * The outstanding work is tracked by the inner executor, eg: the executor which is
+	 * required with asio::execution::outstanding_work.tracked keeps the io_context running.
+	 * eg:
+	 * asio::priority_scheduler sched(ctx.get_executor());
+	 * asio::co_spawn(sched.get_executor(asio::priority::high), heartbeat(), asio::detached);
+	 * asio::co_spawn(sched.get_executor(asio::priority::low), download(), asio::detached);
+	 */
+	template<class Executor>
+	class basic_priority_executor
+	{
+	public:
+		using inner_executor_type = Executor;
+
+		explicit basic_priority_executor(
+			inner_executor_type ex, std::shared_ptr<detail::priority_scheduler_state> state, priority p) noexcept
+			: inner_(std::move(ex)), state_(std::move(state)), priority_(p)
+		{
+		}
+
+		template<class Function>
+		inline void execute(Function&& f) const
+		{
+			this->state_->enqueue(this->priority_, std::forward<Function>(f));
+
+			asio::post(this->inner_, [state = this->state_]() mutable
+			{
+				state->run_one();
+			});
+		}
+
+		inline decltype(auto) query(asio::execution::context_t) const noexcept
+		{
+			return asio::query(this->inner_, asio::execution::context);
+		}
+
+		static constexpr asio::execution::blocking_t query(asio::execution::blocking_t) noexcept
+		{
+			return asio::execution::blocking.never;
+		}
+
+		inline asio::execution::outstanding_work_t query(asio::execution::outstanding_work_t) const noexcept
+		{
+			return asio::query(this->inner_, asio::execution::outstanding_work);
+		}
+
+		inline basic_priority_executor require(asio::execution::blocking_t::never_t) const noexcept
+		{
+			return *this;
+		}
+
+		inline auto require(asio::execution::outstanding_work_t::tracked_t t) const
+		{
+			return this->rebind(asio::require(this->inner_, t));
+		}
+
+		inline auto require(asio::execution::outstanding_work_t::untracked_t t) const
+		{
+			return this->rebind(asio::require(this->inner_, t));
+		}
+
+		/**
+		 * @brief Get an executor which shares the same scheduler but has another priority.
+		 */
+		inline basic_priority_executor with_priority(priority p) const noexcept
+		{
+			return basic_priority_executor(this->inner_, this->state_, p);
+		}
+
+		inline priority get_priority() const noexcept
+		{
+			return this->priority_;
+		}
+
+		inline const inner_executor_type& get_inner_executor() const noexcept
+		{
+			return this->inner_;
+		}
+
+		friend bool operator==(const basic_priority_executor& a, const basic_priority_executor& b) noexcept
+		{
+			return a.state_ == b.state_ && a.priority_ == b.priority_ && a.inner_ == b.inner_;
+		}
+
+		friend bool operator!=(const basic_priority_executor& a, const basic_priority_executor& b) noexcept
+		{
+			return !(a == b);
+		}
+
+	protected:
+		template<class> friend class basic_priority_executor;
+
+		template<class OtherExecutor>
+		inline basic_priority_executor<OtherExecutor> rebind(OtherExecutor ex) const
+		{
+			return basic_priority_executor<OtherExecutor>(std::move(ex), this->state_, this->priority_);
+		}
+
+	protected:
+		inner_executor_type                               inner_;
+
+		std::shared_ptr<detail::priority_scheduler_state> state_;
+
+		priority                                          priority_ = priority::low;
+	};
+
+	using priority_executor = basic_priority_executor<asio::io_context::executor_type>;
+
+	/**
+	 * @brief Two priority handler queues over an io_context.
+	 * The queued handlers are kept alive by the executors, so the scheduler can be destroyed
+	 * before the io_context is stopped.
+	 */
+	class priority_scheduler
+	{
+	public:
+		using executor_type       = priority_executor;
+		using inner_executor_type = priority_executor::inner_executor_type;
+
+		/**
+		 * @brief constructor
+		 * @param ex - The executor of the io_context which executes the handlers.
+		 * @param fairness - At most how many high priority handlers are executed in a row while
+		 *                   there are low priority handlers waiting, zero means no limit.
+		 */
+		explicit priority_scheduler(inner_executor_type ex, std::size_t fairness = 8)
+			: inner_(std::move(ex)), state_(std::make_shared<detail::priority_scheduler_state>(fairness))
+		{
+		}
+
+		/**
+		 * @brief Get the executor of the priority.
+		 */
+		inline priority_executor get_executor(priority p = priority::low) const noexcept
+		{
+			return priority_executor(this->inner_, this->state_, p);
+		}
+
+		/**
+		 * @brief Get the count of the handlers which are waiting in the queue of the priority.
+		 */
+		inline std::size_t queued_count(priority p) const
+		{
+			return this->state_->size(p);
+		}
+
+	protected:
+		inner_executor_type                               inner_;
+
+		std::shared_ptr<detail::priority_scheduler_state> state_;
+	};
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2017-2023 zhllxt
+ *
+ * author   : zhllxt
+ * email    : 37792738@qq.com
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <asio3/core/asio.hpp>
+
+#ifdef ASIO_STANDALONE
+namespace asio
+#else
+namespace boost::asio
+#endif
+{
+	/**
+	 * @brief A per-thread free list of the objects (or the memory blocks) which are expensive to
+	 * create, the object which is released on a thread joins the free list of that thread, and
+	 * the objects which are left in the free list are destroyed by the Deleter when the thread
+	 * exits. Each Tag has its own free lists.
+	 * The free list of a thread is destroyed with the other thread_local objects, so an object
+	 * which is acquired or released by the destructor of another thread_local object, after the
+	 * free list is destroyed, isn't pooled: the acquire returns nullptr, and the release returns
+	 * false, the caller creates or destroys the object itself then.
+	 * eg:
+	 * @code
+	 * using pool = asio::thread_local_pool<foo, 8>;
+	 * foo* p = pool::acquire();
+	 * if (!p) p = new foo();
+	 * if (!pool::release(p)) delete p;
+	 * @endcode
+	 */
+	template<class T, std::size_t MaxCount, class Deleter = std::default_delete<T>, class Tag = T>
+	class thread_local_pool
+	{
+	public:
+		using value_type   = T;
+		using pointer      = T*;
+		using deleter_type = Deleter;
+
+		static constexpr std::size_t max_count = MaxCount;
+
+		/**
+		 * @brief Get an object from the free list of the current thread.
+		 * @return The pooled object, or nullptr if the free list is empty or destroyed already.
+		 */
+		static inline pointer acquire()
+		{
+			if (state() == list_state::destroyed)
+				return nullptr;
+
+			auto& objects = local().objects;
+			if (objects.empty())
+				return nullptr;
+
+			pointer p = objects.back();
+			objects.pop_back();
+			return p;
+		}
+
+		/**
+		 * @brief Give the object back to the free list of the current thread.
+		 * @return false if the object isn't kept (the free list is full or destroyed already),
+		 * the caller must destroy it.
+		 */
+		static inline bool release(pointer p) noexcept
+		{
+			if (state() != list_state::alive)
+				return false;
+
+			auto& objects = local().objects;
+			if (objects.size() >= max_count)
+				return false;
+
+			objects.push_back(p);
+			return true;
+		}
+
+		/**
+		 * @brief Get the count of the objects in the free list of the current thread.
+		 */
+		static inline std::size_t size() noexcept
+		{
+			return state() == list_state::alive ? local().objects.size() : 0;
+		}
+
+	protected:
+		enum class list_state : std::uint8_t { fresh, alive, destroyed };
+
+		struct free_list
+		{
+			std::vector<pointer> objects;
+
+			free_list()
+			{
+				objects.reserve(max_count);
+				state() = list_state::alive;
+			}
+
+			~free_list()
+			{
+				state() = list_state::destroyed;
+				for (pointer p : objects)
+					Deleter{}(p);
+			}
+		};
+
+		static inline list_state& state() noexcept
+		{
+			thread_local list_state s = list_state::fresh;
+			return s;
+		}
+
+		static inline free_list& local()
+		{
+			thread_local free_list l;
+			return l;
+		}
+	};
+}
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <asio3/config.hpp>
+#include <asio3/core/thread_local_pool.hpp>
 
 #include <expected>
 
@@ -23,7 +24,13 @@
 #include <boost/beast/http/serializer.hpp>
 #include <boost/beast/http/string_body.hpp>
 #endif
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <new>
+#include <optional>
+#include <string>
+#include <vector>
 
 #ifdef ASIO3_HEADER_ONLY
 namespace bho
@@ -34,6 +41,88 @@ namespace boost
 namespace beast {
 namespace http {
 
+namespace detail {
+
+// A per-thread free list of the memory blocks of the advanced_message_generator
+// implementations, so once it's warmed up, a response doesn't allocate its type-erased
+// implementation from the heap. A block which is freed on another thread joins the
+// free list of that thread.
+struct generator_impl_pool
+{
+    // Big enough for the implementation of the string_body and empty_body messages.
+    static constexpr std::size_t block_size = 1024;
+    static constexpr std::size_t max_blocks = 64;
+
+    struct block_deleter
+    {
+        void operator()(void* p) const noexcept
+        {
+            ::operator delete(p);
+        }
+    };
+
+    using pool_type = asio::thread_local_pool<void, max_blocks, block_deleter, generator_impl_pool>;
+
+    static void* allocate(std::size_t n)
+    {
+        if (n <= block_size)
+        {
+            if (void* p = pool_type::acquire())
+                return p;
+            return ::operator new(block_size);
+        }
+        return ::operator new(n);
+    }
+
+    static void deallocate(void* p, std::size_t n) noexcept
+    {
+        if (n <= block_size && pool_type::release(p))
+            return;
+        ::operator delete(p);
+    }
+};
+
+} // detail
+
+/** A response which has been serialized into the wire format
+
+    It's written with a single buffer, e.g. the responses of the cache are
+    serialized once and shared by all the sessions which send them.
+*/
+struct serialized_response
+{
+    /// The header of the response, the fields are also contained in the data.
+    http::response_header<> header;
+
+    /// The start line, the header fields and the body.
+    std::string data;
+
+    /// The size of the start line and the header fields in the data.
+    std::size_t header_size = 0;
+
+    /// The result of `keep_alive()` of the message.
+    bool keep_alive = true;
+};
+
+/** The part of the file which is the body of a message
+
+    The body can be written to a socket by the kernel (e.g. with sendfile)
+    after the header was written, see @ref advanced_message_generator::split_file_body.
+*/
+struct file_body_range
+{
+    /// The file descriptor.
+    int native_handle = -1;
+
+    /// The offset of the body in the file.
+    std::uint64_t offset = 0;
+
+    /// The size of the body.
+    std::uint64_t size = 0;
+};
+
+class sse_stream;
+
 /** Type-erased buffers generator for @ref http::message
    
     Implements the BuffersGenerator concept for any concrete instance of the
@@ -70,6 +159,14 @@ public:
     template <bool isRequest, class Body, class Fields>
     advanced_message_generator(http::message<isRequest, Body, Fields>&&);
 
+    /// Share the message, it's kept alive until the generator is destroyed and it must not be modified.
+    template <bool isRequest, class Body, class Fields>
+    advanced_message_generator(std::shared_ptr<http::message<isRequest, Body, Fields>>);
+
+    /// Share the serialized response, its data is written without serializing again.
+    template<typename = void>
+    advanced_message_generator(std::shared_ptr<serialized_response>);
+
     /// `BuffersGenerator`
     bool is_done() const {
         return impl_->is_done();
@@ -89,6 +186,53 @@ public:
         impl_->consume(n);
     }
 
+    /** Split the file body from the header
+
+        If the underlying message is a response with a file body which isn't
+        chunked, the generator is switched to produce the header only and the
+        file range of the body is returned, the caller writes the header and
+        then the body of the range by itself. Otherwise returns nothing and
+        the generator is unchanged.
+    */
+    std::optional<file_body_range>
+    split_file_body()
+    {
+        return impl_->split_file_body();
+    }
+
+    /** Split the event stream from the header
+
+        If the underlying message is a response of @ref make_sse_response,
+        the generator is switched to produce the header only and the event
+        stream is returned, the caller writes the header and then the events
+        of the stream by itself. Otherwise returns nothing and the generator
+        is unchanged.
+    */
+    std::shared_ptr<sse_stream>
+    split_event_stream()
+    {
+        return impl_->split_event_stream();
+    }
+
+    /** Split the payload of the body from the header
+        The generator is switched to produce the payload of the body only,
+        without the header and the chunked framing, e.g. the payload is sent
+        in the DATA frames of HTTP/2 and the header is taken from
+        @ref get_response_header. It must be called before @ref prepare.
+    */
+    void
+    split_body(error_code& ec)
+    {
+        impl_->split_body(ec);
+    }
+
+    /// Returns true if the header has been produced completely
+    bool
+    is_header_done()
+    {
+        return impl_->is_header_done();
+    }
+
     /// Returns the result of `m.keep_alive()` on the underlying message
     bool
     keep_alive() const noexcept
@@ -111,10 +255,24 @@ public:
 private:
     struct impl_base
     {
+        static void* operator new(std::size_t n)
+        {
+            return detail::generator_impl_pool::allocate(n);
+        }
+
+        static void operator delete(void* p, std::size_t n) noexcept
+        {
+            detail::generator_impl_pool::deallocate(p, n);
+        }
+
         virtual ~impl_base() = default;
         virtual bool is_done() = 0;
         virtual const_buffers_type prepare(error_code& ec) = 0;
         virtual void consume(std::size_t n) = 0;
+        virtual std::optional<file_body_range> split_file_body() { return std::nullopt; }
+        virtual std::shared_ptr<sse_stream> split_event_stream() { return nullptr; }
+        virtual void split_body(error_code& ec) = 0;
+        virtual bool is_header_done() { return is_done(); }
         virtual bool keep_alive() const noexcept = 0;
         virtual http::response_header<>& get_response_header() noexcept = 0;
         virtual std::expected<http::response<http::string_body>, error_code> to_string_body_response() = 0;
@@ -122,11 +280,12 @@ private:
 
     std::unique_ptr<impl_base> impl_;
 
-    template <bool isRequest, class Body, class Fields>
+    // The implementation of a message which is owned, referenced or shared, see the
+    // holders of the message in the detail namespace.
+    template <class Holder>
     struct generator_impl;
 
-    template <bool isRequest, class Body, class Fields>
-    struct ref_generator_impl;
+    struct serialized_generator_impl;
 };
 
 } // namespace http
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2017-2023 zhllxt
+ *
+ * author   : zhllxt
+ * email    : 37792738@qq.com
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include <asio3/core/beast.hpp>
+
+#ifdef ASIO3_HEADER_ONLY
+namespace bho::beast::http
+#else
+namespace boost::beast::http
+#endif
+{
+	/**
+	 * @brief A monotonic memory resource which is reused by the requests of one connection.
+	 * The deallocation does nothing, all the memory is reclaimed at once by reset(). If the
+	 * last use of the arena has overflowed the initial buffer, reset() enlarges the initial
+	 * buffer to the used size (but not beyond the max_retained), so after a few requests the
+	 * header fields and the body of a request are allocated without any malloc.
+	 */
+	class request_arena : public std::pmr::memory_resource
+	{
+	public:
+		/**
+		 * @brief constructor
+		 * @param initial_size - The size of the initial buffer.
+		 * @param max_retained - The max size of the initial buffer which is kept between the
+		 *                       requests, the memory above it is given back to the system.
+		 */
+		explicit request_arena(std::size_t initial_size = 4 * 1024, std::size_t max_retained = 1024 * 1024)
+			: size_(initial_size), max_retained_(max_retained)
+		{
+			this->buffer_ = std::make_unique<std::byte[]>(this->size_);
+			this->resource_.emplace(this->buffer_.get(), this->size_, std::pmr::new_delete_resource());
+		}
+
+		request_arena(const request_arena&) = delete;
+		request_arena& operator=(const request_arena&) = delete;
+
+		/**
+		 * @brief Reclaim all the memory allocated from the arena.
+		 * All the objects which use the arena must have been destroyed.
+		 */
+		inline void reset()
+		{
+			this->resource_.reset();
+
+			if (this->used_ > this->size_ && this->size_ < this->max_retained_)
+			{
+				this->size_ = (std::min)(this->used_ + this->used_ / 4, this->max_retained_);
+				this->buffer_ = std::make_unique<std::byte[]>(this->size_);
+			}
+
+			this->used_ = 0;
+			this->resource_.emplace(this->buffer_.get(), this->size_, std::pmr::new_delete_resource());
+		}
+
+		/**
+		 * @brief Get the size of the memory allocated since the last reset.
+		 */
+		inline std::size_t used() const noexcept
+		{
+			return this->used_;
+		}
+
+		/**
+		 * @brief Get the size of the initial buffer.
+		 */
+		inline std::size_t capacity() const noexcept
+		{
+			return this->size_;
+		}
+
+	protected:
+		virtual void* do_allocate(std::size_t bytes, std::size_t alignment) override
+		{
+			this->used_ += bytes;
+			return this->resource_->allocate(bytes, alignment);
+		}
+
+		virtual void do_deallocate(void*, std::size_t, std::size_t) override
+		{
+		}
+
+		virtual bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+		{
+			return this == &other;
+		}
+
+	protected:
+		std::unique_ptr<std::byte[]>                     buffer_;
+
+		std::size_t                                      size_ = 0;
+
+		std::size_t                                      max_retained_ = 0;
+
+		std::size_t                                      used_ = 0;
+
+		std::optional<std::pmr::monotonic_buffer_resource> resource_;
+	};
+
+	/**
+	 * @brief The arenas of a connection, one arena is used by each request which is being
+	 * handled, so the pipelined requests never share an arena.
+	 */
+	class request_arena_pool
+	{
+	public:
+		/**
+		 * @brief Get an unused arena, a new arena is created if all the arenas are in use.
+		 */
+		inline request_arena* acquire()
+		{
+			if (this->free_.empty())
+			{
+				return this->arenas_.emplace_back(std::make_unique<request_arena>()).get();
+			}
+
+			request_arena* arena = this->free_.back();
+			this->free_.pop_back();
+			return arena;
+		}
+
+		/**
+		 * @brief Give back the arena after the request which uses it has been destroyed.
+		 */
+		inline void release(request_arena* arena)
+		{
+			arena->reset();
+			this->free_.emplace_back(arena);
+		}
+
+		/**
+		 * @brief Give back all the arenas, all the requests must have been destroyed.
+		 */
+		inline void release_all()
+		{
+			this->free_.clear();
+
+			for (auto& arena : this->arenas_)
+			{
+				arena->reset();
+				this->free_.emplace_back(arena.get());
+			}
+		}
+
+	protected:
+		std::vector<std::unique_ptr<request_arena>> arenas_;
+
+		std::vector<request_arena*>                 free_;
+	};
+
+	using arena_allocator   = std::pmr::polymorphic_allocator<char>;
+	using arena_fields      = http::basic_fields<arena_allocator>;
+	using arena_string_body = http::basic_string_body<char, std::char_traits<char>, arena_allocator>;
+
+	/**
+	 * @brief A request whose header fields and body are allocated from a request_arena.
+	 * It can be used as the request type of the http session, eg:
+	 * asio::basic_http_server<asio::basic_http_session<asio::tcp_socket, http::arena_request>>
+	 * The request is destroyed after its response is written, so the handler must copy the
+	 * fields which are used later.
+	 */
+	using arena_request = http::request<arena_string_body, arena_fields>;
+
+	template<class RequestT>
+	inline constexpr bool is_arena_request_v = std::is_same_v<RequestT, arena_request>;
+
+	/**
+	 * @brief Make an empty arena_request which allocates from the arena.
+	 */
+	inline arena_request make_arena_request(request_arena& arena)
+	{
+		return arena_request(std::piecewise_construct,
+			std::make_tuple(arena_allocator(&arena)), std::make_tuple(arena_allocator(&arena)));
+	}
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2017-2023 zhllxt
+ *
+ * author   : zhllxt
+ * email    : 37792738@qq.com
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <optional>
+#include <string_view>
+#include <tuple>
+
+#include <asio3/core/asio.hpp>
+#include <asio3/core/beast.hpp>
+
+#ifdef ASIO3_HEADER_ONLY
+namespace bho::beast::http
+#else
+namespace boost::beast::http
+#endif
+{
+	/**
+	 * @brief The reader of the request body which is passed to the streaming route handler,
+	 * the handler gets the request with the header only, and pulls the body chunk by chunk.
+	 * eg:
+	 *   router.add<http::verb::post>("/upload", [](http::web_request& req, http::web_response& rep,
+	 *       http::body_reader& body) -> net::awaitable<bool>
+	 *   {
+	 *       std::array<char, 16 * 1024> buf;
+	 *       for (;;)
+	 *       {
+	 *           auto [ec, n] = co_await body.async_read_some(net::buffer(buf));
+	 *           if (ec)
+	 *               co_return false;
+	 *           if (n == 0)
+	 *               break;
+	 *           // consume the data of buf[0, n)
+	 *       }
+	 *       rep = http::make_text_response("ok");
+	 *       co_return true;
+	 *   });
+	 */
+	class body_reader
+	{
+	public:
+		virtual ~body_reader() = default;
+
+		/**
+		 * @brief Read some data of the body into the buffer.
+		 * @return The error and the size of the data, the zero size without error means the
+		 *         whole body has been read.
+		 */
+		virtual asio::awaitable<std::tuple<error_code, std::size_t>> async_read_some(asio::mutable_buffer buf) = 0;
+
+		/**
+		 * @brief Returns true if the whole body has been read.
+		 */
+		virtual bool is_done() const = 0;
+
+		/**
+		 * @brief Returns the value of the Content-Length, or nothing if the body is chunked.
+		 */
+		virtual std::optional<std::uint64_t> content_length() const = 0;
+	};
+
+	/**
+	 * @brief The reader of the body which has been read into the memory already, it's used
+	 * when the request is not streamed, eg: the request of HTTP/2.
+	 */
+	class buffered_body_reader final : public body_reader
+	{
+	public:
+		explicit buffered_body_reader(std::string_view body) noexcept : body_(body), size_(body.size())
+		{
+		}
+
+		asio::awaitable<std::tuple<error_code, std::size_t>> async_read_some(asio::mutable_buffer buf) override
+		{
+			std::size_t n = (std::min)(buf.size(), this->body_.size());
+
+			if (n > 0)
+				std::memcpy(buf.data(), this->body_.data(), n);
+
+			this->body_.remove_prefix(n);
+
+			co_return std::tuple{ error_code{}, n };
+		}
+
+		bool is_done() const override
+		{
+			return this->body_.empty();
+		}
+
+		std::optional<std::uint64_t> content_length() const override
+		{
+			return this->size_;
+		}
+
+	protected:
+		std::string_view body_;
+
+		std::size_t      size_ = 0;
+	};
+}
@@ -16,19 +16,27 @@
 #include <memory>
 #include <chrono>
 #include <functional>
-#include <atomic>
+#include <algorithm>
+#include <bit>
+#include <list>
+#include <mutex>
 #include <string>
 #include <string_view>
 #include <unordered_map>
 #include <type_traits>
-#include <shared_mutex>
+#include <vector>
+#include <charconv>
 
 #include <asio3/core/function_traits.hpp>
 #include <asio3/core/netutil.hpp>
+#include <asio3/core/strutil.hpp>
 #include <asio3/core/null_shared_mutex.hpp>
+#include <asio3/core/hash.hpp>
 
 #include <asio3/core/beast.hpp>
 #include <asio3/http/core.hpp>
+#include <asio3/http/header_cache.hpp>
+#include <asio3/http/compress.hpp>
 
 #ifdef ASIO3_HEADER_ONLY
 namespace bho::beast::http
@@ -57,36 +65,555 @@ namespace boost::beast::http
 		}
 	}
 
+	struct cache_option
+	{
+		// The max total size of the cached messages (the body and the header fields).
+		std::size_t max_bytes = 64 * 1024 * 1024;
+
+		// The max count of the cached messages.
+		std::size_t max_count = 0xffff;
+
+		// The count of the independently locked shards, rounded up to a power of two.
+		std::size_t shards = 16;
+
+		// The time to live of the messages which have no "Cache-Control: max-age", zero means
+		// these messages are kept until they are evicted.
+		std::chrono::steady_clock::duration default_ttl = std::chrono::steady_clock::duration::zero();
+
+		// How long an expired message is still served while the first request after its
+		// expiration is refreshing it, zero means the expired messages are never served.
+		std::chrono::steady_clock::duration stale_while_revalidate = std::chrono::steady_clock::duration::zero();
+	};
+}
+
+#ifdef ASIO3_HEADER_ONLY
+namespace bho::beast::http::detail
+#else
+namespace boost::beast::http::detail
+#endif
+{
+	/**
+	 * @brief A count-min sketch of 4 bits counters which estimates the access frequency of
+	 * the keys, all the counters are halved periodically so the old popularity fades out.
+	 */
+	class cache_frequency_sketch
+	{
+	public:
+		inline void resize(std::size_t expected_count)
+		{
+			std::size_t width = std::bit_ceil(std::clamp<std::size_t>(expected_count, 64, std::size_t(1) << 22));
+
+			this->table_.assign(width, 0);
+			this->mask_ = width - 1;
+			this->sample_size_ = width * 10;
+			this->additions_ = 0;
+		}
+
+		inline void increment(std::size_t hash) noexcept
+		{
+			std::size_t start = (hash & 3) << 2;
+
+			bool added = false;
+
+			for (std::size_t i = 0; i < 4; ++i)
+			{
+				std::size_t index = this->index_of(hash, i);
+				std::size_t offset = (start + i) << 2;
+
+				if (((this->table_[index] >> offset) & 0xf) != 0xf)
+				{
+					this->table_[index] += std::uint64_t(1) << offset;
+					added = true;
+				}
+			}
+
+			if (added && ++this->additions_ >= this->sample_size_)
+				this->reset();
+		}
+
+		inline std::uint32_t frequency(std::size_t hash) const noexcept
+		{
+			std::size_t start = (hash & 3) << 2;
+
+			std::uint32_t freq = 0xf;
+
+			for (std::size_t i = 0; i < 4; ++i)
+			{
+				std::size_t index = this->index_of(hash, i);
+				std::size_t offset = (start + i) << 2;
+
+				freq = (std::min)(freq, static_cast<std::uint32_t>((this->table_[index] >> offset) & 0xf));
+			}
+
+			return freq;
+		}
+
+	protected:
+		inline std::size_t index_of(std::size_t hash, std::size_t i) const noexcept
+		{
+			static constexpr std::uint64_t seeds[] = {
+				0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL, 0x9ae16a3b2f90404fULL, 0xcbf29ce484222325ULL };
+
+			std::uint64_t h = (static_cast<std::uint64_t>(hash) + seeds[i]) * seeds[i];
+			h += (h >> 32);
+			return static_cast<std::size_t>(h) & this->mask_;
+		}
+
+		inline void reset() noexcept
+		{
+			for (auto& v : this->table_)
+				v = (v >> 1) & 0x7777777777777777ULL;
+
+			this->additions_ /= 2;
+		}
+
+	protected:
+		std::vector<std::uint64_t> table_;
+
+		std::size_t                mask_ = 0;
+
+		std::size_t                sample_size_ = 0;
+
+		std::size_t                additions_ = 0;
+	};
+
+	/**
+	 * @brief One shard of the W-TinyLFU cache.
+	 * The new messages enter a small LRU window (1% of the bytes), the messages which leave
+	 * the window have to compete with the eldest message of the probation segment of the main
+	 * SLRU, and the one with the lower estimated frequency is evicted. A message which is hit
+	 * in the probation segment is promoted to the protected segment (80% of the main bytes).
+	 * Each insertion only evicts as many messages as needed, so there's never a full scan.
+	 */
 	template<class MessageT, class MutexT>
-	class basic_cache
+	class cache_shard
 	{
+	public:
+		using clock_type  = std::chrono::steady_clock;
+		using time_point  = clock_type::time_point;
+		using message_ptr = std::shared_ptr<MessageT>;
+
+		enum class region : std::uint8_t { window, probation, protected_ };
+
+		struct entry
+		{
+			std::string key;
+
+			message_ptr msg;
+
+			std::size_t hash = 0;
+
+			std::size_t size = 0;
+
+			time_point  expires{};
+
+			region      where = region::window;
+		};
+
+		using list_type = std::list<entry>;
+		using iterator  = typename list_type::iterator;
+
+		inline void set_limits(std::size_t max_bytes, std::size_t max_count, clock_type::duration stale)
+		{
+			std::lock_guard guard(this->mutex_);
+
+			this->stale_ = stale;
+
+			this->max_bytes_ = max_bytes;
+			this->max_count_ = max_count;
+			this->window_max_ = (std::max)(max_bytes / 100, std::size_t(1));
+			this->protected_max_ = (max_bytes - this->window_max_) / 5 * 4;
+
+			this->sketch_.resize(max_count);
+
+			this->evict();
+		}
+
+		inline message_ptr find(std::string_view key, std::size_t hash, time_point now, bool& stale)
+		{
+			stale = false;
+
+			std::lock_guard guard(this->mutex_);
+
+			this->sketch_.increment(hash);
+
+			auto it = this->map_.find(key);
+			if (it == this->map_.end())
+				return nullptr;
+
+			iterator e = it->second;
+
+			if (e->expires != time_point{} && now >= e->expires)
+			{
+				if (now >= e->expires + this->stale_)
+				{
+					this->erase(e);
+					return nullptr;
+				}
+
+				// it's replaced by the refreshed message later, so it's not promoted.
+				stale = true;
+				return e->msg;
+			}
+
+			switch (e->where)
+			{
+			case region::window:
+				this->window_.splice(this->window_.begin(), this->window_, e);
+				break;
+			case region::probation:
+				this->move_to(e, region::protected_);
+				this->demote();
+				break;
+			case region::protected_:
+				this->protected_.splice(this->protected_.begin(), this->protected_, e);
+				break;
+			}
+
+			return e->msg;
+		}
+
+		inline bool add(std::string_view key, std::size_t hash, message_ptr msg, std::size_t size, time_point expires)
+		{
+			std::lock_guard guard(this->mutex_);
+
+			if (size > this->max_bytes_ || this->max_count_ == 0)
+				return false;
+
+			// the old message may be still being sent by other sessions, it's kept alive by them.
+			if (auto it = this->map_.find(key); it != this->map_.end())
+				this->erase(it->second);
+
+			this->window_.emplace_front(entry{ std::string(key), std::move(msg), hash, size, expires, region::window });
+			this->window_bytes_ += size;
+
+			iterator e = this->window_.begin();
+
+			this->map_.emplace(std::string_view(e->key), e);
+
+			this->evict();
+
+			return true;
+		}
+
+		inline std::size_t count() const
+		{
+			std::lock_guard guard(this->mutex_);
+			return this->map_.size();
+		}
+
+		inline std::size_t bytes() const
+		{
+			std::lock_guard guard(this->mutex_);
+			return this->window_bytes_ + this->probation_bytes_ + this->protected_bytes_;
+		}
+
+		inline void clear()
+		{
+			std::lock_guard guard(this->mutex_);
+
+			this->map_.clear();
+			this->window_.clear();
+			this->probation_.clear();
+			this->protected_.clear();
+			this->window_bytes_ = this->probation_bytes_ = this->protected_bytes_ = 0;
+		}
+
 	protected:
-		struct cache_node
+		inline list_type& list_of(region r) noexcept
+		{
+			return r == region::window ? this->window_ : (r == region::probation ? this->probation_ : this->protected_);
+		}
+
+		inline std::size_t& bytes_of(region r) noexcept
+		{
+			return r == region::window ? this->window_bytes_ :
+				(r == region::probation ? this->probation_bytes_ : this->protected_bytes_);
+		}
+
+		inline void move_to(iterator e, region r)
+		{
+			this->bytes_of(e->where) -= e->size;
+			this->bytes_of(r) += e->size;
+
+			this->list_of(r).splice(this->list_of(r).begin(), this->list_of(e->where), e);
+
+			e->where = r;
+		}
+
+		inline void erase(iterator e)
+		{
+			this->map_.erase(std::string_view(e->key));
+			this->bytes_of(e->where) -= e->size;
+			this->list_of(e->where).erase(e);
+		}
+
+		// move the eldest protected messages back to the probation segment when it's over its share.
+		inline void demote()
 		{
-			std::chrono::steady_clock::time_point alive;
+			while (this->protected_bytes_ > this->protected_max_ && !this->protected_.empty())
+			{
+				this->move_to(std::prev(this->protected_.end()), region::probation);
+			}
+		}
+
+		inline bool over_budget() const noexcept
+		{
+			return this->window_bytes_ + this->probation_bytes_ + this->protected_bytes_ > this->max_bytes_ ||
+				this->map_.size() > this->max_count_;
+		}
+
+		inline void evict()
+		{
+			// the messages which leave the window become the candidates of the main segments.
+			while (this->window_bytes_ > this->window_max_ && !this->window_.empty())
+			{
+				this->move_to(std::prev(this->window_.end()), region::probation);
+			}
+
+			this->demote();
+
+			while (this->over_budget())
+			{
+				if (this->probation_.empty())
+				{
+					list_type& from = this->protected_.empty() ? this->window_ : this->protected_;
+					this->erase(std::prev(from.end()));
+					continue;
+				}
+
+				iterator victim = std::prev(this->probation_.end());
+				iterator candidate = this->probation_.begin();
+
+				if (candidate == victim)
+				{
+					this->erase(victim);
+					continue;
+				}
+
+				if (this->sketch_.frequency(candidate->hash) > this->sketch_.frequency(victim->hash))
+					this->erase(victim);
+				else
+					this->erase(candidate);
+			}
+		}
+
+	protected:
+		mutable MutexT                                  mutex_;
+
+		std::unordered_map<std::string_view, iterator>  map_;
+
+		list_type                                       window_;
+
+		list_type                                       probation_;
+
+		list_type                                       protected_;
+
+		std::size_t                                     window_bytes_ = 0;
+
+		std::size_t                                     probation_bytes_ = 0;
+
+		std::size_t                                     protected_bytes_ = 0;
+
+		std::size_t                                     max_bytes_ = 0;
+
+		std::size_t                                     max_count_ = 0;
+
+		std::size_t                                     window_max_ = 0;
+
+		std::size_t                                     protected_max_ = 0;
+
+		clock_type::duration                            stale_{};
+
+		cache_frequency_sketch                          sketch_;
+	};
+
+	/**
+	 * @brief Get the time to live from the "Cache-Control" field of the message.
+	 * @return false if the message must not be stored.
+	 */
+	template<class FieldsT>
+	requires requires(const FieldsT& fields) { fields.find(http::field::cache_control); }
+	inline bool cache_control_ttl(const FieldsT& fields, std::chrono::steady_clock::duration& ttl)
+	{
+		auto it = fields.find(http::field::cache_control);
+		if (it == fields.end())
+			return true;
+
+		std::string_view value = asio::to_string_view(it->value());
+
+		while (!value.empty())
+		{
+			std::size_t pos = value.find(',');
+			std::string_view directive = asio::trim_both(value.substr(0, pos));
+
+			value = (pos == std::string_view::npos) ? std::string_view{} : value.substr(pos + 1);
+
+			if (beast::iequals(directive, "no-store") || beast::iequals(directive, "no-cache") ||
+				beast::iequals(directive, "private"))
+				return false;
 
-			MessageT msg;
+			if (directive.size() > 8 && beast::iequals(directive.substr(0, 8), "max-age="))
+			{
+				std::uint64_t seconds = 0;
+				auto [p, ec] = std::from_chars(directive.data() + 8, directive.data() + directive.size(), seconds);
+				if (ec != std::errc{} || seconds == 0)
+					return false;
+
+				ttl = std::chrono::seconds(seconds);
+			}
+		}
+
+		return true;
+	}
+
+	/**
+	 * @brief Check whether the message can be shared by the requests which have the same
+	 * cache key, see http::make_cache_key. The message which sets a cookie, or varies with
+	 * any request field other than the Accept-Encoding (which is a part of the key), is
+	 * specific to the request, it must not be stored.
+	 */
+	template<class FieldsT>
+	requires requires(const FieldsT& fields) { fields.find(http::field::vary); }
+	inline bool cache_is_shareable(const FieldsT& fields)
+	{
+		if (fields.find(http::field::set_cookie) != fields.end())
+			return false;
+
+		for (auto it = fields.find(http::field::vary); it != fields.end() && it->name() == http::field::vary; ++it)
+		{
+			std::string_view value = asio::to_string_view(it->value());
 
-			cache_node(std::chrono::steady_clock::time_point t, MessageT m)
-				: alive(t), msg(std::move(m))
+			while (!value.empty())
 			{
+				std::size_t pos = value.find(',');
+				std::string_view name = asio::trim_both(value.substr(0, pos));
+
+				value = (pos == std::string_view::npos) ? std::string_view{} : value.substr(pos + 1);
+
+				if (!name.empty() && !beast::iequals(name, "accept-encoding"))
+					return false;
 			}
+		}
+
+		return true;
+	}
+
+	template<bool isRequest, class Body, class Fields>
+	inline std::size_t cache_message_size(const http::message<isRequest, Body, Fields>& msg)
+	{
+		std::size_t size = sizeof(http::message<isRequest, Body, Fields>);
+
+		for (auto& field : msg)
+			size += field.name_string().size() + field.value().size() + 4;
+
+		if constexpr (requires { msg.body().size(); })
+			size += msg.body().size();
 
-			inline void update_alive_time() noexcept
+		return size;
+	}
+
+	template<typename = void>
+	inline bool cache_control_ttl(const http::serialized_response& msg, std::chrono::steady_clock::duration& ttl)
+	{
+		return detail::cache_control_ttl(msg.header, ttl);
+	}
+
+	template<typename = void>
+	inline bool cache_is_shareable(const http::serialized_response& msg)
+	{
+		return detail::cache_is_shareable(msg.header);
+	}
+
+	template<typename = void>
+	inline std::size_t cache_message_size(const http::serialized_response& msg)
+	{
+		return sizeof(http::serialized_response) + msg.data.size();
+	}
+
+	template<class Serializer>
+	struct serialize_to_string_helper
+	{
+		Serializer& sr_;
+		std::string& out_;
+
+		template<class ConstBufferSequence>
+		void operator()(error_code& ec, ConstBufferSequence const& buffers) const
+		{
+			ec = {};
+
+			std::size_t n = 0;
+
+			for (auto it = net::buffer_sequence_begin(buffers); it != net::buffer_sequence_end(buffers); ++it)
 			{
-				alive = std::chrono::steady_clock::now();
+				net::const_buffer b = *it;
+				out_.append(static_cast<const char*>(b.data()), b.size());
+				n += b.size();
 			}
+
+			sr_.consume(n);
+		}
+	};
+
+	template<typename = void>
+	inline bool etag_list_contains(std::string_view list, std::string_view etag)
+	{
+		// weak comparison, the "W/" prefix is ignored.
+		auto strip = [](std::string_view v)
+		{
+			v = asio::trim_both(v);
+			if (v.size() > 2 && v[0] == 'W' && v[1] == '/')
+				v.remove_prefix(2);
+			return v;
 		};
 
+		etag = strip(etag);
+
+		while (!list.empty())
+		{
+			std::size_t pos = list.find(',');
+			std::string_view tag = strip(list.substr(0, pos));
+
+			list = (pos == std::string_view::npos) ? std::string_view{} : list.substr(pos + 1);
+
+			if (tag == "*" || tag == etag)
+				return true;
+		}
+
+		return false;
+	}
+}
+
+#ifdef ASIO3_HEADER_ONLY
+namespace bho::beast::http
+#else
+namespace boost::beast::http
+#endif
+{
+	/**
+	 * @brief A sharded W-TinyLFU cache of the messages, bounded by the total bytes.
+	 * The messages are shared by std::shared_ptr, so a message which is being sent by a
+	 * session is still alive after it's evicted or replaced, and the cached messages must
+	 * not be modified. The "Cache-Control: no-store/no-cache/private" messages are not
+	 * stored, and the "Cache-Control: max-age" is used as the time to live.
+	 */
+	template<class MessageT, class MutexT>
+	class basic_cache
+	{
 	public:
 		using message_type = MessageT;
-		using mutex_type = MutexT;
+		using mutex_type   = MutexT;
+		using message_ptr  = std::shared_ptr<MessageT>;
+		using shard_type   = detail::cache_shard<MessageT, MutexT>;
 
 		/**
 		 * @brief constructor
 		 */
-		basic_cache()
+		explicit basic_cache(cache_option opt = {}) : option_(std::move(opt))
 		{
+			this->shards_ = std::vector<shard_type>(std::bit_ceil((std::max)(this->option_.shards, std::size_t(1))));
+
+			this->apply_limits();
 		}
 
 		/**
@@ -95,69 +622,79 @@ namespace boost::beast::http
 		~basic_cache() = default;
 
 		/**
-		 * @brief Add a element into the cache.
+		 * @brief Add a element into the cache, the element with the same url is replaced.
+		 * @return false if the message is not stored, because of the "Cache-Control" or the size.
 		 */
 		template<class StringT>
-		inline cache_node* add(StringT&& url, MessageT msg)
+		inline bool add(StringT&& url, MessageT msg)
 		{
-			std::unique_lock guard(this->cache_mutex_);
+			return this->add(std::forward<StringT>(url), std::make_shared<MessageT>(std::move(msg)));
+		}
 
-			if (this->cache_map_.size() >= cache_max_count_)
-				return nullptr;
+		/**
+		 * @brief Add a shared element into the cache, the element with the same url is replaced.
+		 * The url should be made by the http::make_cache_key, if the message varies with the
+		 * Accept-Encoding.
+		 * @return false if the message is not stored, because of the "Cache-Control", the
+		 * "Set-Cookie", the "Vary" or the size.
+		 */
+		template<class StringT>
+		inline bool add(StringT&& url, message_ptr msg)
+		{
+			std::chrono::steady_clock::duration ttl = this->option_.default_ttl;
+
+			if (!msg || !detail::cache_control_ttl(*msg, ttl) || !detail::cache_is_shareable(*msg))
+				return false;
+
+			std::string_view key = asio::to_string_view(url);
+			std::size_t hash = std::hash<std::string_view>{}(key);
+			std::size_t size = detail::cache_message_size(*msg) + key.size();
 
-			// can't use insert_or_assign, it maybe cause the msg was changed in multithread, and 
-			// other thread are using the msg at this time.
-			return std::addressof(this->cache_map_.emplace(
-				asio::to_string(std::forward<StringT>(url)),
-				cache_node{ std::chrono::steady_clock::now(), std::move(msg) }).first->second);
+			auto expires = ttl > std::chrono::steady_clock::duration::zero() ?
+				std::chrono::steady_clock::now() + ttl : std::chrono::steady_clock::time_point{};
+
+			return this->shard_of(hash).add(key, hash, std::move(msg), size, expires);
 		}
 
 		/**
 		 * @brief Checks if the cache has no elements.
 		 */
-		inline bool empty() const noexcept
+		inline bool empty() const
 		{
-			std::shared_lock guard(this->cache_mutex_);
-
-			return this->cache_map_.empty();
+			return this->get_count() == 0;
 		}
 
 		/**
-		 * @brief Checks if the cache is full.
+		 * @brief Finds the cache with key equivalent to url, the expired element is removed.
 		 */
-		inline bool full() const noexcept
+		template<class StringT>
+		inline message_ptr find(const StringT& url)
 		{
-			std::shared_lock guard(this->cache_mutex_);
-
-			return this->cache_map_.size() >= cache_max_count_;
+			bool stale = false;
+			message_ptr msg = this->find(url, stale);
+			return stale ? nullptr : msg;
 		}
 
 		/**
-		 * @brief Finds the cache with key equivalent to url.
+		 * @brief Finds the cache with key equivalent to url, the expired element is returned
+		 * with the stale flag while it's in the stale_while_revalidate period.
 		 */
 		template<class StringT>
-		inline cache_node* find(const StringT& url)
+		inline message_ptr find(const StringT& url, bool& stale)
 		{
-			std::shared_lock guard(this->cache_mutex_);
-
-			if (this->cache_map_.empty())
-				return nullptr;
-
-			// If rehashing occurs due to the insertion, all iterators are invalidated.
-			// Otherwise iterators are not affected. References are not invalidated. 
-			std::string str = asio::to_string(url);
-			if (auto it = this->cache_map_.find(str); it != this->cache_map_.end())
-				return std::addressof(it->second);
+			std::string_view key = asio::to_string_view(url);
+			std::size_t hash = std::hash<std::string_view>{}(key);
 
-			return nullptr;
+			return this->shard_of(hash).find(key, hash, std::chrono::steady_clock::now(), stale);
 		}
 
 		/**
 		 * @brief Set the max number of elements in the container.
 		 */
-		inline void set_max_count(std::size_t count) noexcept
+		inline void set_max_count(std::size_t count)
 		{
-			this->cache_max_count_ = count;
+			this->option_.max_count = count;
+			this->apply_limits();
 		}
 
 		/**
@@ -165,63 +702,234 @@ namespace boost::beast::http
 		 */
 		inline std::size_t get_max_count() const noexcept
 		{
-			return this->cache_max_count_;
+			return this->option_.max_count;
 		}
 
 		/**
-		 * @brief Get the current number of elements in the container.
+		 * @brief Set the max total bytes of the elements in the container.
 		 */
-		inline std::size_t get_count() const noexcept
+		inline void set_max_bytes(std::size_t bytes)
 		{
-			std::shared_lock guard(this->cache_mutex_);
+			this->option_.max_bytes = bytes;
+			this->apply_limits();
+		}
 
-			return this->cache_map_.size();
+		/**
+		 * @brief Get the max total bytes of the elements in the container.
+		 */
+		inline std::size_t get_max_bytes() const noexcept
+		{
+			return this->option_.max_bytes;
 		}
 
 		/**
-		 * @brief Requests the removal of expired elements.
+		 * @brief Set the time to live of the elements which have no "Cache-Control: max-age".
 		 */
-		inline void shrink_to_fit()
+		inline void set_default_ttl(std::chrono::steady_clock::duration ttl) noexcept
 		{
-			std::unique_lock guard(this->cache_mutex_);
+			this->option_.default_ttl = ttl;
+		}
 
-			if (this->cache_map_.size() < cache_max_count_)
-				return;
+		/**
+		 * @brief Set how long the expired elements are still served while they are being refreshed.
+		 */
+		inline void set_stale_while_revalidate(std::chrono::steady_clock::duration duration)
+		{
+			this->option_.stale_while_revalidate = duration;
+			this->apply_limits();
+		}
 
-			std::multimap<std::chrono::steady_clock::duration::rep, const std::string*> mms;
-			for (auto& [url, node] : this->cache_map_)
-			{
-				mms.emplace(node.alive.time_since_epoch().count(), std::addressof(url));
-			}
+		/**
+		 * @brief Get the current number of elements in the container.
+		 */
+		inline std::size_t get_count() const
+		{
+			std::size_t n = 0;
+			for (auto& shard : this->shards_)
+				n += shard.count();
+			return n;
+		}
 
-			std::size_t i = 0, n = mms.size() / 3;
-			for (auto& [t, purl] : mms)
-			{
-				asio::ignore_unused(t);
-				if (++i > n)
-					break;
-				this->cache_map_.erase(*purl);
-			}
+		/**
+		 * @brief Get the current total bytes of the elements in the container.
+		 */
+		inline std::size_t get_bytes() const
+		{
+			std::size_t n = 0;
+			for (auto& shard : this->shards_)
+				n += shard.bytes();
+			return n;
 		}
 
 		/**
 		 * @brief Erases all elements from the container.
 		 */
-		inline void clear() noexcept
+		inline void clear()
 		{
-			std::unique_lock guard(this->cache_mutex_);
-			this->cache_map_.clear();
+			for (auto& shard : this->shards_)
+				shard.clear();
 		}
 
 	protected:
-		mutable MutexT                              cache_mutex_;
+		inline shard_type& shard_of(std::size_t hash) noexcept
+		{
+			// the low bits of the hash are used by the sketch of the shard.
+			return this->shards_[(hash >> 16) & (this->shards_.size() - 1)];
+		}
+
+		inline void apply_limits()
+		{
+			std::size_t n = this->shards_.size();
+
+			for (auto& shard : this->shards_)
+			{
+				shard.set_limits(this->option_.max_bytes / n, (this->option_.max_count + n - 1) / n,
+					this->option_.stale_while_revalidate);
+			}
+		}
 
-		std::unordered_map<std::string, cache_node> cache_map_;
+	protected:
+		cache_option            option_;
 
-		std::size_t                                 cache_max_count_ = 0xffff;
+		std::vector<shard_type> shards_;
 	};
 
-	using cache = basic_cache<http::response<http::string_body>, asio::null_shared_mutex>;
+	/**
+	 * @brief Make the key of the request for the response cache: the target, and the content
+	 * coding which is selected by the Accept-Encoding of the request, so the compressed and
+	 * the uncompressed responses of a target are cached apart, see make_compressed_response.
+	 */
+	template<class RequestT>
+	inline std::string make_cache_key(const RequestT& req)
+	{
+		std::string_view target = asio::to_string_view(req.target());
+
+		content_coding coding = content_coding::identity;
+
+		if (auto it = req.find(http::field::accept_encoding); it != req.end())
+			coding = http::select_content_coding(asio::to_string_view(it->value()));
+
+		if (coding == content_coding::identity)
+			return std::string(target);
+
+		// the space can't be a part of the target.
+		std::string key;
+		key.reserve(target.size() + 8);
+		key += target;
+		key += ' ';
+		key += http::to_string(coding);
+		return key;
+	}
+
+	/**
+	 * @brief Serialize the response into the wire format, a strong ETag which is computed
+	 * from the body is added if the response has no ETag.
+	 */
+	template<class Fields>
+	inline std::shared_ptr<http::serialized_response> make_serialized_response(
+		http::response<http::string_body, Fields>& res)
+	{
+		if (res.find(http::field::etag) == res.end())
+		{
+			const std::string& body = res.body();
+
+			std::uint64_t hash = asio::detail::fnv1a_hash<std::uint64_t>(
+				reinterpret_cast<const unsigned char*>(body.data()), static_cast<std::uint64_t>(body.size()));
+
+			char etag[48];
+			int n = std::snprintf(etag, sizeof(etag), "\"%016llx-%llx\"",
+				static_cast<unsigned long long>(hash), static_cast<unsigned long long>(body.size()));
+
+			res.set(http::field::etag, std::string_view(etag, static_cast<std::size_t>(n)));
+		}
+
+		auto sp = std::make_shared<http::serialized_response>();
+
+		sp->header = static_cast<http::response_header<>&>(res);
+		sp->keep_alive = res.keep_alive();
+		sp->data.reserve(res.body().size() + 256);
+
+		http::response_serializer<http::string_body, Fields> sr{ res };
+
+		sr.split(true);
+
+		error_code ec{};
+
+		detail::serialize_to_string_helper<decltype(sr)> visit{ sr, sp->data };
+
+		while (!sr.is_header_done())
+		{
+			sr.next(ec, visit);
+			if (ec)
+				return nullptr;
+		}
+
+		sp->header_size = sp->data.size();
+
+		while (!sr.is_done())
+		{
+			sr.next(ec, visit);
+			if (ec)
+				return nullptr;
+		}
+
+		return sp;
+	}
+
+	/**
+	 * @brief Check whether the cached response is not modified for the conditional request,
+	 * the "If-None-Match" is checked first, and the "If-Modified-Since" is only checked when
+	 * there's no "If-None-Match".
+	 */
+	template<class RequestT>
+	inline bool is_not_modified(const RequestT& req, const http::response_header<>& res)
+	{
+		if (auto it = req.find(http::field::if_none_match); it != req.end())
+		{
+			auto etag = res.find(http::field::etag);
+			if (etag == res.end())
+				return false;
+
+			return detail::etag_list_contains(
+				asio::to_string_view(it->value()), asio::to_string_view(etag->value()));
+		}
+
+		if (auto it = req.find(http::field::if_modified_since); it != req.end())
+		{
+			auto last_modified = res.find(http::field::last_modified);
+			if (last_modified == res.end())
+				return false;
+
+			auto since = http::parse_date(asio::to_string_view(it->value()));
+			auto modified = http::parse_date(asio::to_string_view(last_modified->value()));
+
+			return since && modified && *modified <= *since;
+		}
+
+		return false;
+	}
+
+	/**
+	 * @brief Make the "304 Not Modified" response of the cached response.
+	 */
+	template<typename = void>
+	inline http::response<http::empty_body> make_not_modified_response(const http::response_header<>& res)
+	{
+		http::response<http::empty_body> rep{ http::status::not_modified, res.version() };
+
+		for (http::field f : { http::field::etag, http::field::last_modified, http::field::cache_control,
+			http::field::expires, http::field::vary, http::field::content_location })
+		{
+			if (auto it = res.find(f); it != res.end())
+				rep.set(f, it->value());
+		}
+
+		http::set_server_and_date(rep);
+
+		return rep;
+	}
+
+	using cache = basic_cache<http::serialized_response, std::mutex>;
 }
 
 #include <asio3/core/detail/pop_options.hpp>
@@ -0,0 +1,952 @@
+/*
+ * Copyright (c) 2017-2023 zhllxt
+ *
+ * author   : zhllxt
+ * email    : 37792738@qq.com
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <asio3/core/asio.hpp>
+#include <asio3/core/beast.hpp>
+#include <asio3/core/strutil.hpp>
+#include <asio3/core/thread_local_pool.hpp>
+#include <asio3/http/core.hpp>
+#include <asio3/http/native_file.hpp>
+
+#ifdef ASIO3_HEADER_ONLY
+#include <asio3/bho/beast/zlib/deflate_stream.hpp>
+#include <asio3/bho/beast/zlib/inflate_stream.hpp>
+#else
+#include <boost/beast/zlib/deflate_stream.hpp>
+#include <boost/beast/zlib/inflate_stream.hpp>
+#endif
+
+#ifdef ASIO3_HEADER_ONLY
+namespace bho::beast::http
+#else
+namespace boost::beast::http
+#endif
+{
+	/**
+	 * @brief The content codings which are supported by the compress and the decompress.
+	 */
+	enum class content_coding : std::uint8_t
+	{
+		identity,
+		gzip,    // the gzip member of RFC 1952
+		deflate, // the zlib stream of RFC 1950
+	};
+
+	struct compress_option
+	{
+		// The compression level, from 1 (fastest) to 9 (best).
+		int level = 6;
+
+		// The body which is smaller than it isn't compressed, it's used when the size of
+		// the body is known before it's sent.
+		std::size_t min_size = 1024;
+	};
+}
+
+#ifdef ASIO3_HEADER_ONLY
+namespace bho::beast::http::detail
+#else
+namespace boost::beast::http::detail
+#endif
+{
+	inline constexpr std::array<std::uint32_t, 256> crc32_table = []()
+	{
+		std::array<std::uint32_t, 256> table{};
+
+		for (std::uint32_t i = 0; i < 256; ++i)
+		{
+			std::uint32_t c = i;
+			for (int k = 0; k < 8; ++k)
+				c = (c & 1) ? (0xedb88320u ^ (c >> 1)) : (c >> 1);
+			table[i] = c;
+		}
+
+		return table;
+	}();
+
+	// the fixed header of the gzip member of RFC 1952: magic, deflate, no flags, no mtime,
+	// no extra flags, unix.
+	inline constexpr unsigned char gzip_header[10] = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 3 };
+
+	// the header of the zlib stream of RFC 1950: deflate with 32K window, default level.
+	inline constexpr unsigned char zlib_header[2] = { 0x78, 0x9c };
+
+	/**
+	 * @brief A per-thread free list of the deflate streams. The memory of a deflate stream
+	 * (the window, the hash chains and the pending buffer) is about 256K, it's kept by the
+	 * reset of the stream, so a pooled stream compresses the next body without allocating.
+	 * A stream which is released on another thread joins the free list of that thread.
+	 */
+	using deflate_stream_pool = asio::thread_local_pool<beast::zlib::deflate_stream, 8>;
+
+	struct deflate_stream_deleter
+	{
+		inline void operator()(beast::zlib::deflate_stream* p) const noexcept
+		{
+			if (!deflate_stream_pool::release(p))
+				delete p;
+		}
+	};
+}
+
+#ifdef ASIO3_HEADER_ONLY
+namespace bho::beast::http
+#else
+namespace boost::beast::http
+#endif
+{
+	using deflate_stream_ptr = std::unique_ptr<beast::zlib::deflate_stream, detail::deflate_stream_deleter>;
+
+	/**
+	 * @brief Get a deflate stream from the pool of the current thread, it produces the raw
+	 * deflate data (without the gzip or zlib header). The stream is given back to the pool
+	 * when the pointer is destroyed.
+	 */
+	inline deflate_stream_ptr acquire_deflate_stream(int level)
+	{
+		beast::zlib::deflate_stream* p = detail::deflate_stream_pool::acquire();
+		deflate_stream_ptr ds{ p ? p : new beast::zlib::deflate_stream() };
+		ds->reset((std::clamp)(level, 0, 9), 15, 8, beast::zlib::Strategy::normal);
+		return ds;
+	}
+
+	/**
+	 * @brief Update the CRC-32 (the one of gzip and zip) with the data.
+	 * @param crc - The crc of the previous data, 0 for the first one.
+	 */
+	inline std::uint32_t crc32(std::uint32_t crc, const void* data, std::size_t size) noexcept
+	{
+		const unsigned char* p = static_cast<const unsigned char*>(data);
+
+		crc = ~crc;
+		for (std::size_t i = 0; i < size; ++i)
+			crc = detail::crc32_table[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+
+		return ~crc;
+	}
+
+	/**
+	 * @brief Update the Adler-32 (the one of zlib) with the data.
+	 * @param adler - The adler of the previous data, 1 for the first one.
+	 */
+	inline std::uint32_t adler32(std::uint32_t adler, const void* data, std::size_t size) noexcept
+	{
+		const unsigned char* p = static_cast<const unsigned char*>(data);
+
+		std::uint32_t a = adler & 0xffff, b = adler >> 16;
+
+		while (size > 0)
+		{
+			// the sums don't overflow in 5552 bytes, see the NMAX of zlib.
+			std::size_t n = (std::min)(size, std::size_t(5552));
+			size -= n;
+			while (n--)
+			{
+				a += *p++;
+				b += a;
+			}
+			a %= 65521;
+			b %= 65521;
+		}
+
+		return (b << 16) | a;
+	}
+
+	/**
+	 * @brief Check whether the content coding is acceptable by the value of the Accept-Encoding
+	 * header, eg: "gzip, deflate;q=0.5, br;q=0". The coding which is listed with q=0 is not
+	 * acceptable, the coding which isn't listed is acceptable by the wildcard "*" only.
+	 */
+	inline bool is_encoding_accepted(std::string_view accept_encoding, std::string_view coding) noexcept
+	{
+		int wildcard = -1;
+
+		while (!accept_encoding.empty())
+		{
+			std::size_t comma = accept_encoding.find(',');
+			std::string_view item = accept_encoding.substr(0, comma);
+			accept_encoding = comma == std::string_view::npos ?
+				std::string_view{} : accept_encoding.substr(comma + 1);
+
+			std::size_t semi = item.find(';');
+			std::string_view name = asio::trim_both(item.substr(0, semi));
+
+			bool accepted = true;
+
+			if (semi != std::string_view::npos)
+			{
+				std::string_view param = asio::trim_both(item.substr(semi + 1));
+
+				if (param.size() >= 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=')
+				{
+					// the qvalue is zero if all of its digits are zero, eg: "0", "0.0", "0.000"
+					std::string_view q = asio::trim_both(param.substr(2));
+					accepted = q.find_first_not_of("0.") != std::string_view::npos;
+				}
+			}
+
+			if (asio::iequals(name, coding))
+				return accepted;
+
+			if (name == "*")
+				wildcard = accepted ? 1 : 0;
+		}
+
+		return wildcard == 1;
+	}
+
+	/**
+	 * @brief Select the content coding of the response by the value of the Accept-Encoding
+	 * header of the request, the gzip is preferred to the deflate.
+	 */
+	inline content_coding select_content_coding(std::string_view accept_encoding) noexcept
+	{
+		if (http::is_encoding_accepted(accept_encoding, "gzip"))
+			return content_coding::gzip;
+
+		if (http::is_encoding_accepted(accept_encoding, "deflate"))
+			return content_coding::deflate;
+
+		return content_coding::identity;
+	}
+
+	/**
+	 * @brief Get the content coding by the value of the Content-Encoding header.
+	 * @return std::nullopt if the coding isn't supported, eg: "br".
+	 */
+	inline std::optional<content_coding> to_content_coding(std::string_view content_encoding) noexcept
+	{
+		content_encoding = asio::trim_both(content_encoding);
+
+		if (content_encoding.empty() || asio::iequals(content_encoding, "identity"))
+			return content_coding::identity;
+
+		if (asio::iequals(content_encoding, "gzip") || asio::iequals(content_encoding, "x-gzip"))
+			return content_coding::gzip;
+
+		if (asio::iequals(content_encoding, "deflate"))
+			return content_coding::deflate;
+
+		return std::nullopt;
+	}
+
+	inline std::string_view to_string(content_coding coding) noexcept
+	{
+		switch (coding)
+		{
+		case content_coding::gzip:    return "gzip";
+		case content_coding::deflate: return "deflate";
+		default:                      return "identity";
+		}
+	}
+
+	/**
+	 * @brief Check whether the content of the mimetype is worth compressing, the text alike
+	 * content is, but the images, the videos and the archives are compressed already.
+	 */
+	inline bool is_compressible_mimetype(std::string_view mimetype) noexcept
+	{
+		mimetype = asio::trim_both(mimetype.substr(0, mimetype.find(';')));
+
+		if (mimetype.size() > 5 && asio::iequals(mimetype.substr(0, 5), "text/"))
+			return true;
+
+		for (std::string_view suffix : { "+json", "+xml", "/json", "/xml", "/javascript", "/wasm", "/x-javascript" })
+		{
+			if (mimetype.size() > suffix.size() &&
+				asio::iequals(mimetype.substr(mimetype.size() - suffix.size()), suffix))
+				return true;
+		}
+
+		return false;
+	}
+}
+
+#ifdef ASIO3_HEADER_ONLY
+namespace bho::beast::http::detail
+#else
+namespace boost::beast::http::detail
+#endif
+{
+	/**
+	 * @brief The framing of the raw deflate data: the header, the checksum and the trailer
+	 * of the gzip member or the zlib stream.
+	 */
+	struct content_encoder
+	{
+		static constexpr std::size_t max_header_size = sizeof(detail::gzip_header);
+		static constexpr std::size_t max_trailer_size = 8;
+
+		content_coding     coding = content_coding::gzip;
+
+		deflate_stream_ptr ds;
+
+		std::uint32_t      check = 0;
+
+		std::uint64_t      size = 0;
+
+		content_encoder(content_coding c, int level)
+			: coding(c), ds(http::acquire_deflate_stream(level)), check(c == content_coding::gzip ? 0 : 1)
+		{
+		}
+
+		inline std::size_t header(char* p) const noexcept
+		{
+			if (this->coding == content_coding::gzip)
+			{
+				std::memcpy(p, detail::gzip_header, sizeof(detail::gzip_header));
+				return sizeof(detail::gzip_header);
+			}
+
+			std::memcpy(p, detail::zlib_header, sizeof(detail::zlib_header));
+			return sizeof(detail::zlib_header);
+		}
+
+		inline void update(const void* data, std::size_t n) noexcept
+		{
+			this->check = this->coding == content_coding::gzip ?
+				http::crc32(this->check, data, n) : http::adler32(this->check, data, n);
+			this->size += n;
+		}
+
+		inline std::size_t trailer(char* p) const noexcept
+		{
+			if (this->coding == content_coding::gzip)
+			{
+				// little endian crc and size.
+				for (int i = 0; i < 4; ++i)
+					p[i] = static_cast<char>((this->check >> (i * 8)) & 0xff);
+				for (int i = 0; i < 4; ++i)
+					p[4 + i] = static_cast<char>((std::uint32_t(this->size) >> (i * 8)) & 0xff);
+				return 8;
+			}
+
+			// big endian adler.
+			for (int i = 0; i < 4; ++i)
+				p[i] = static_cast<char>((this->check >> ((3 - i) * 8)) & 0xff);
+			return 4;
+		}
+
+		/**
+		 * @brief Compress the input into the output, the consumed input is added to the checksum.
+		 * @return The end_of_stream if the stream is finished, need_buffers if no progress is
+		 * possible, or the other error.
+		 */
+		inline error_code write(beast::zlib::z_params& zs, beast::zlib::Flush flush)
+		{
+			const void* in = zs.next_in;
+			std::size_t avail_in = zs.avail_in;
+
+			error_code ec{};
+			this->ds->write(zs, flush, ec);
+
+			this->update(in, avail_in - zs.avail_in);
+
+			return ec;
+		}
+	};
+
+	// skip the header of the gzip member, return the size of the header or zero if it's invalid.
+	inline std::size_t skip_gzip_header(std::string_view data) noexcept
+	{
+		if (data.size() < 10 || std::uint8_t(data[0]) != 0x1f || std::uint8_t(data[1]) != 0x8b || data[2] != 8)
+			return 0;
+
+		std::uint8_t flags = std::uint8_t(data[3]);
+		std::size_t pos = 10;
+
+		if (flags & 0x04) // FEXTRA
+		{
+			if (data.size() < pos + 2)
+				return 0;
+			pos += 2 + (std::size_t(std::uint8_t(data[pos])) | (std::size_t(std::uint8_t(data[pos + 1])) << 8));
+		}
+
+		for (std::uint8_t bit : { std::uint8_t(0x08), std::uint8_t(0x10) }) // FNAME, FCOMMENT
+		{
+			if (flags & bit)
+			{
+				std::size_t nul = pos < data.size() ? data.find('\0', pos) : std::string_view::npos;
+				if (nul == std::string_view::npos)
+					return 0;
+				pos = nul + 1;
+			}
+		}
+
+		if (flags & 0x02) // FHCRC
+			pos += 2;
+
+		return pos <= data.size() ? pos : 0;
+	}
+
+	inline std::uint32_t load_le32(const char* p) noexcept
+	{
+		return std::uint32_t(std::uint8_t(p[0])) | (std::uint32_t(std::uint8_t(p[1])) << 8) |
+			(std::uint32_t(std::uint8_t(p[2])) << 16) | (std::uint32_t(std::uint8_t(p[3])) << 24);
+	}
+
+	inline std::uint32_t load_be32(const char* p) noexcept
+	{
+		return (std::uint32_t(std::uint8_t(p[0])) << 24) | (std::uint32_t(std::uint8_t(p[1])) << 16) |
+			(std::uint32_t(std::uint8_t(p[2])) << 8) | std::uint32_t(std::uint8_t(p[3]));
+	}
+}
+
+#ifdef ASIO3_HEADER_ONLY
+namespace bho::beast::http
+#else
+namespace boost::beast::http
+#endif
+{
+	/**
+	 * @brief Compress the data with the content coding by the deflate of the beast zlib.
+	 * @param level - The compression level, from 0 (no compression) to 9 (best compression).
+	 */
+	inline std::string compress(std::string_view data, content_coding coding, int level, error_code& ec)
+	{
+		if (coding == content_coding::identity)
+		{
+			ec = {};
+			return std::string(data);
+		}
+
+		detail::content_encoder encoder(coding, level);
+
+		std::string out;
+		out.resize(detail::content_encoder::max_header_size + encoder.ds->upper_bound(data.size()) +
+			detail::content_encoder::max_trailer_size);
+
+		std::size_t n = encoder.header(out.data());
+
+		beast::zlib::z_params zs{};
+		zs.next_in = data.data();
+		zs.avail_in = data.size();
+		zs.next_out = out.data() + n;
+		zs.avail_out = out.size() - n - detail::content_encoder::max_trailer_size;
+
+		ec = encoder.write(zs, beast::zlib::Flush::finish);
+
+		// the output buffer is enough for the whole data, so the stream must be finished.
+		if (ec != beast::zlib::error::end_of_stream)
+		{
+			if (!ec)
+				ec = beast::zlib::error::need_buffers;
+			return {};
+		}
+
+		ec = {};
+
+		n += zs.total_out;
+		n += encoder.trailer(out.data() + n);
+
+		out.resize(n);
+
+		return out;
+	}
+
+	/**
+	 * @brief Decompress the data of the content coding by the inflate of the beast zlib.
+	 * The "deflate" coding is the zlib stream, but the raw deflate data which is sent by
+	 * some servers is accepted too.
+	 * @param max_size - The max size of the decompressed data, the body_limit error is set
+	 * if it's exceeded.
+	 */
+	inline std::string decompress(std::string_view data, content_coding coding, error_code& ec,
+		std::size_t max_size = 64 * 1024 * 1024)
+	{
+		ec = {};
+
+		if (coding == content_coding::identity)
+			return std::string(data);
+
+		std::size_t head = 0, tail = 0;
+
+		if (coding == content_coding::gzip)
+		{
+			head = detail::skip_gzip_header(data);
+			tail = 8;
+
+			if (head == 0 || data.size() < head + tail)
+			{
+				ec = beast::zlib::error::stream_error;
+				return {};
+			}
+		}
+		else if (data.size() >= 2 && (std::uint8_t(data[0]) & 0x0f) == 8 &&
+			((std::uint8_t(data[0]) << 8) | std::uint8_t(data[1])) % 31 == 0)
+		{
+			// the zlib stream with a preset dictionary isn't supported.
+			if (std::uint8_t(data[1]) & 0x20)
+			{
+				ec = beast::zlib::error::need_dict;
+				return {};
+			}
+
+			head = 2;
+			tail = 4;
+		}
+
+		beast::zlib::inflate_stream is;
+		is.reset(15);
+
+		std::string out;
+		out.resize((std::min)((std::max)(data.size() * 4, std::size_t(1024)), max_size));
+
+		beast::zlib::z_params zs{};
+		zs.next_in = data.data() + head;
+		zs.avail_in = data.size() - head;
+		zs.next_out = out.data();
+		zs.avail_out = out.size();
+
+		for (;;)
+		{
+			is.write(zs, beast::zlib::Flush::none, ec);
+
+			if (ec == beast::zlib::error::end_of_stream)
+			{
+				ec = {};
+				break;
+			}
+
+			if (ec && ec != beast::zlib::error::need_buffers)
+				return {};
+
+			if (zs.avail_out == 0)
+			{
+				if (out.size() >= max_size)
+				{
+					ec = http::error::body_limit;
+					return {};
+				}
+
+				std::size_t used = out.size();
+				out.resize((std::min)(used * 2, max_size));
+				zs.next_out = out.data() + used;
+				zs.avail_out = out.size() - used;
+			}
+			else if (ec)
+			{
+				// the input is truncated.
+				ec = http::error::partial_message;
+				return {};
+			}
+		}
+
+		out.resize(zs.total_out);
+
+		if (tail > 0)
+		{
+			if (zs.avail_in < tail)
+			{
+				ec = http::error::partial_message;
+				return {};
+			}
+
+			const char* p = static_cast<const char*>(zs.next_in);
+
+			bool ok = coding == content_coding::gzip ?
+				detail::load_le32(p) == http::crc32(0, out.data(), out.size()) &&
+				detail::load_le32(p + 4) == static_cast<std::uint32_t>(out.size()) :
+				detail::load_be32(p) == http::adler32(1, out.data(), out.size());
+
+			if (!ok)
+			{
+				ec = beast::zlib::error::stream_error;
+				return {};
+			}
+		}
+
+		return out;
+	}
+
+	/**
+	 * @brief Decompress the body of the message in place by its Content-Encoding header, the
+	 * Content-Encoding is removed and the Content-Length is updated. The message without the
+	 * Content-Encoding (or with an unsupported one) is left unchanged.
+	 */
+	template<bool isRequest, class Fields>
+	inline void decompress_body(http::message<isRequest, http::string_body, Fields>& m, error_code& ec,
+		std::size_t max_size = 64 * 1024 * 1024)
+	{
+		ec = {};
+
+		auto it = m.find(http::field::content_encoding);
+		if (it == m.end() || m.body().empty())
+			return;
+
+		auto coding = http::to_content_coding(asio::to_string_view(it->value()));
+		if (!coding.has_value() || *coding == content_coding::identity)
+			return;
+
+		std::string body = http::decompress(m.body(), *coding, ec, max_size);
+		if (ec)
+			return;
+
+		m.body() = std::move(body);
+		m.erase(http::field::content_encoding);
+
+		if (!m.chunked())
+			m.content_length(m.body().size());
+	}
+
+	/**
+	 * @brief A body adapter which compresses the body of the message on the fly while it's
+	 * being serialized, the size of the compressed body is unknown so the message must be
+	 * sent chunked. The deflate stream is taken from the pool of the current thread.
+	 * If the inner body has no data for now (eg: the buffer_body whose producer returns the
+	 * need_buffer), the compressed data is flushed first so the peer can decode all the
+	 * data it has received.
+	 */
+	template<class Body>
+	struct compressed_body
+	{
+		class value_type
+		{
+		public:
+			value_type() = default;
+
+			explicit value_type(typename Body::value_type b, content_coding c = content_coding::gzip, int l = 6)
+				: body(std::move(b)), coding(c), level(l)
+			{
+			}
+
+			typename Body::value_type body{};
+
+			content_coding            coding = content_coding::gzip;
+
+			int                       level = 6;
+		};
+
+		class writer
+		{
+		public:
+			using const_buffers_type = asio::const_buffer;
+
+			template<bool isRequest, class Fields>
+			writer(http::header<isRequest, Fields>& h, value_type& b)
+				: inner_(h, b.body), body_(b)
+			{
+			}
+
+			inline void init(error_code& ec)
+			{
+				this->inner_.init(ec);
+				if (ec)
+					return;
+
+				this->encoder_.emplace(this->body_.coding, this->body_.level);
+				this->buf_ = std::make_unique<char[]>(buffer_size);
+			}
+
+			inline std::optional<std::pair<const_buffers_type, bool>> get(error_code& ec)
+			{
+				ec = {};
+
+				if (this->done_)
+					return std::nullopt;
+
+				// the flushed data was returned, now tell the caller that the inner body has
+				// no data, the inner writer isn't called again until the body is refilled.
+				if (this->stalled_ && !this->flushing_)
+				{
+					this->stalled_ = false;
+					ec = http::error::need_buffer;
+					return std::nullopt;
+				}
+
+				auto& encoder = *this->encoder_;
+
+				char* out = this->buf_.get();
+
+				// the deflate data is written before the room of the trailer.
+				constexpr std::size_t capacity = buffer_size - detail::content_encoder::max_trailer_size;
+
+				std::size_t n = 0;
+
+				if (!this->header_done_)
+				{
+					n = encoder.header(out);
+					this->header_done_ = true;
+				}
+
+				for (;;)
+				{
+					if (this->pos_ == this->input_.size() && !this->finishing_ && !this->flushing_)
+					{
+						this->input_.clear();
+						this->pos_ = 0;
+
+						auto r = this->inner_.get(ec);
+
+						if (ec == http::error::need_buffer)
+						{
+							if (this->dirty_)
+							{
+								this->flushing_ = true;
+								this->stalled_ = true;
+								ec = {};
+							}
+							else if (n > 0)
+							{
+								this->stalled_ = true;
+								ec = {};
+								return std::pair{ const_buffers_type(out, n), true };
+							}
+							else
+							{
+								return std::nullopt;
+							}
+						}
+						else if (ec)
+						{
+							return std::nullopt;
+						}
+						else if (!r.has_value())
+						{
+							this->finishing_ = true;
+						}
+						else
+						{
+							for (auto b : beast::buffers_range_ref(r->first))
+							{
+								if (b.size() > 0)
+									this->input_.emplace_back(b);
+							}
+
+							if (!r->second)
+								this->finishing_ = true;
+						}
+					}
+
+					beast::zlib::z_params zs{};
+
+					if (this->pos_ < this->input_.size())
+					{
+						zs.next_in = this->input_[this->pos_].data();
+						zs.avail_in = this->input_[this->pos_].size();
+					}
+
+					zs.next_out = out + n;
+					zs.avail_out = capacity - n;
+
+					// the last input is compressed with the finish, so the data is finished
+					// at once instead of with another empty write.
+					bool last = this->finishing_ && this->pos_ + 1 >= this->input_.size();
+
+					beast::zlib::Flush flush = last ? beast::zlib::Flush::finish :
+						(this->flushing_ ? beast::zlib::Flush::sync : beast::zlib::Flush::none);
+
+					error_code e = encoder.write(zs, flush);
+
+					if (zs.total_in > 0)
+						this->dirty_ = true;
+
+					if (this->pos_ < this->input_.size())
+					{
+						this->input_[this->pos_] += zs.total_in;
+						if (this->input_[this->pos_].size() == 0)
+							++this->pos_;
+					}
+
+					n = capacity - zs.avail_out;
+
+					if (e == beast::zlib::error::end_of_stream)
+					{
+						n += encoder.trailer(out + n);
+						this->done_ = true;
+						return std::pair{ const_buffers_type(out, n), false };
+					}
+
+					if (e && e != beast::zlib::error::need_buffers)
+					{
+						ec = e;
+						return std::nullopt;
+					}
+
+					// the sync flush is done when it has room left in the output.
+					if (this->flushing_ && zs.avail_out > 0)
+					{
+						this->flushing_ = false;
+						this->dirty_ = false;
+						return std::pair{ const_buffers_type(out, n), true };
+					}
+
+					if (n == capacity)
+						return std::pair{ const_buffers_type(out, n), true };
+				}
+			}
+
+		protected:
+			static constexpr std::size_t buffer_size = 16 * 1024;
+
+			typename Body::writer                          inner_;
+
+			value_type&                                    body_;
+
+			std::optional<detail::content_encoder>         encoder_;
+
+			std::unique_ptr<char[]>                        buf_;
+
+			// the buffers of the inner body which are not compressed yet.
+			std::vector<asio::const_buffer>                input_;
+
+			std::size_t                                    pos_ = 0;
+
+			bool                                           header_done_ = false;
+
+			// whether the data is compressed since the last flush.
+			bool                                           dirty_ = false;
+
+			bool                                           flushing_ = false;
+
+			// whether the inner body has returned the need_buffer which isn't passed on yet.
+			bool                                           stalled_ = false;
+
+			bool                                           finishing_ = false;
+
+			bool                                           done_ = false;
+		};
+	};
+
+	/**
+	 * @brief Check whether the response is worth compressing: it has a body, the content of
+	 * it is compressible, it's not encoded yet, and it's not too small. The file body isn't
+	 * compressed, the static files are compressed by the file_cache.
+	 */
+	template<class Body, class Fields>
+	inline bool is_compressible_response(const http::response<Body, Fields>& rep, const compress_option& opt)
+	{
+		if constexpr (http::is_file_body_v<std::decay_t<Body>>)
+		{
+			return false;
+		}
+		else
+		{
+			auto status = rep.result_int();
+			if (status < 200 || status == 204 || status == 206 || status == 304)
+				return false;
+
+			if (auto it = rep.find(http::field::content_encoding); it != rep.end() &&
+				!asio::iequals(asio::trim_both(asio::to_string_view(it->value())), "identity"))
+				return false;
+
+			if (!http::is_compressible_mimetype(asio::to_string_view(rep[http::field::content_type])))
+				return false;
+
+			if (auto size = rep.payload_size(); size.has_value() && *size < opt.min_size)
+				return false;
+
+			return true;
+		}
+	}
+
+	/**
+	 * @brief Suffix the entity tag of the response with the content coding, eg: "abc" becomes
+	 * "abc-gz", the encoded representation must not have the same strong ETag as the identity
+	 * one (RFC 9110 8.8.3). The suffix of gzip is the same as the one of the file_cache.
+	 */
+	template<class Fields>
+	inline void set_encoded_etag(http::header<false, Fields>& h, content_coding coding)
+	{
+		auto it = h.find(http::field::etag);
+		if (it == h.end() || coding == content_coding::identity)
+			return;
+
+		std::string_view etag = asio::trim_both(asio::to_string_view(it->value()));
+
+		// the malformed entity tag is dropped.
+		if (etag.size() < 2 || etag.back() != '"')
+		{
+			h.erase(http::field::etag);
+			return;
+		}
+
+		std::string v{ etag.substr(0, etag.size() - 1) };
+		v += coding == content_coding::gzip ? "-gz\"" : "-deflate\"";
+
+		h.set(http::field::etag, v);
+	}
+
+	/**
+	 * @brief Make the response compressed with the content coding which is negotiated by the
+	 * Accept-Encoding of the request. The string body is compressed at once and sent with the
+	 * Content-Length, the other bodies are compressed on the fly by the compressed_body and
+	 * sent chunked (so they are not compressed for the HTTP/1.0 request). The ETag of the
+	 * compressed response is suffixed with the content coding, see set_encoded_etag.
+	 * The response which isn't worth compressing is returned as it is.
+	 */
+	template<class RequestT, class Body, class Fields>
+	inline http::web_response make_compressed_response(
+		const RequestT& req, http::response<Body, Fields> rep, const compress_option& opt = {})
+	{
+		if (!http::is_compressible_response(rep, opt))
+			return rep;
+
+		// the response varies with the Accept-Encoding whether it's compressed or not.
+		if (auto it = rep.find(http::field::vary); it == rep.end())
+			rep.set(http::field::vary, "Accept-Encoding");
+		else if (asio::ifind(asio::to_string_view(it->value()), "accept-encoding") == std::string::npos)
+			rep.set(http::field::vary, std::string(asio::to_string_view(it->value())) + ", Accept-Encoding");
+
+		content_coding coding = content_coding::identity;
+
+		if (auto it = req.find(http::field::accept_encoding); it != req.end())
+			coding = http::select_content_coding(asio::to_string_view(it->value()));
+
+		if (coding == content_coding::identity || req.method() == http::verb::head)
+			return rep;
+
+		if constexpr (std::is_same_v<Body, http::string_body>)
+		{
+			error_code ec{};
+			std::string data = http::compress(rep.body(), coding, opt.level, ec);
+
+			// the data which is compressed badly is sent as it is.
+			if (ec || data.size() >= rep.body().size())
+				return rep;
+
+			rep.body() = std::move(data);
+			rep.set(http::field::content_encoding, http::to_string(coding));
+			http::set_encoded_etag(rep, coding);
+			rep.content_length(rep.body().size());
+
+			return rep;
+		}
+		else
+		{
+			if (req.version() < 11)
+				return rep;
+
+			http::response<http::compressed_body<Body>, Fields> m{ std::move(rep.base()) };
+			m.body() = typename http::compressed_body<Body>::value_type(std::move(rep.body()), coding, opt.level);
+			m.set(http::field::content_encoding, http::to_string(coding));
+			http::set_encoded_etag(m, coding);
+			m.erase(http::field::content_length);
+			m.chunked(true);
+
+			return m;
+		}
+	}
+}
@@ -0,0 +1,1285 @@
+/*
+ * Copyright (c) 2017-2023 zhllxt
+ *
+ * author   : zhllxt
+ * email    : 37792738@qq.com
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <expected>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <asio3/core/asio.hpp>
+#include <asio3/core/beast.hpp>
+#include <asio3/core/stdutil.hpp>
+#include <asio3/core/strutil.hpp>
+#include <asio3/http/core.hpp>
+#include <asio3/http/util.hpp>
+#include <asio3/http/mime_types.hpp>
+#include <asio3/http/header_cache.hpp>
+#include <asio3/http/native_file.hpp>
+#include <asio3/http/cache.hpp>
+#include <asio3/http/compress.hpp>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#endif
+
+#ifdef ASIO3_HEADER_ONLY
+namespace bho::beast::http
+#else
+namespace boost::beast::http
+#endif
+{
+	struct file_cache_option
+	{
+		// The max count of the files which are kept opened in the cache.
+		std::size_t max_count = 1024;
+
+		// How often the size and the modification time of a cached file are checked, it's only
+		// used when the changes of the file can't be watched by inotify (eg: not linux, or the
+		// cache is constructed without an executor).
+		std::chrono::steady_clock::duration revalidate_interval = std::chrono::seconds(1);
+
+		// The max count of the ranges of a request, the Range header which has more ranges is
+		// ignored and the whole file is sent.
+		std::size_t max_ranges = 16;
+
+		// The parts of a multi-range response are read into memory, the Range header whose total
+		// size exceeds it is ignored and the whole file is sent.
+		std::uint64_t max_multirange_bytes = 4 * 1024 * 1024;
+
+		// Serve the sibling "file.gz" of the file to the client which accepts gzip.
+		bool gzip_static = true;
+
+		// Compress the compressible file (text, json, javascript, svg...) which has no sibling
+		// "file.gz" once, and keep the compressed variant with the cached file. The file is
+		// compressed by a background thread, the whole file is sent until it's compressed.
+		bool gzip = true;
+
+		// The compression level of the compressed variant, from 1 (fastest) to 9 (best).
+		int gzip_level = 6;
+
+		// The file whose size is out of the range isn't compressed: the small file gains little,
+		// the big file costs too much memory and delays the first request too long.
+		std::uint64_t gzip_min_size = 256;
+		std::uint64_t gzip_max_size = 8 * 1024 * 1024;
+	};
+
+	/**
+	 * @brief The opened file and its metadata which are kept in the file_cache.
+	 */
+	struct file_cache_entry
+	{
+		// The webroot and the path of the target, the key of the cache.
+		std::string             key;
+
+		// The resolved path of the file.
+		std::filesystem::path   path;
+
+		native_file             file;
+
+		std::uint64_t           size = 0;
+
+		std::time_t             mtime = 0;
+
+		// The pre-rendered Content-Type, ETag, Last-Modified and Accept-Ranges fields.
+		http::response_header<> header;
+
+		// The content of the in-memory variant (the compressed file), the file isn't opened.
+		std::string             data;
+
+		// The cached file whose content is sent for this variant (the sibling "file.gz").
+		std::shared_ptr<const file_cache_entry> source;
+
+		// The fields below are guarded by the mutex of the cache.
+		std::chrono::steady_clock::time_point checked{};
+
+		int                     watch = -1;
+
+		std::list<std::shared_ptr<file_cache_entry>>::iterator lru{};
+
+		// The file is changed while it's being opened, it isn't cached.
+		bool                    stale = false;
+
+		enum class variant : std::uint8_t { unknown, sibling, compressing, compressed, none };
+
+		// How the gzip variant is made, and the variant itself. The variant is dropped with
+		// the entry when the file is changed, so it's always the one of the current file.
+		mutable variant         gzip_kind = variant::unknown;
+
+		mutable std::shared_ptr<const file_cache_entry> gzip;
+	};
+
+	/**
+	 * @brief A read only view of the file of a cache entry, it meets the requirements of the
+	 * beast File. The view is the part of the file from the beginning to the "end", and the
+	 * http::basic_file_body sends the part from the position to the "end", so a byte range of
+	 * the file is sent by a view which is positioned at the first byte of the range.
+	 * The views of the same file share the descriptor, they read with pread which doesn't use
+	 * the position of the descriptor. The view of an in-memory variant reads the data of it.
+	 */
+	class cached_file
+	{
+	public:
+	#if defined(__unix__) || defined(__APPLE__)
+		using native_handle_type = native_file::native_handle_type;
+	#endif
+
+		cached_file() = default;
+
+		cached_file(std::shared_ptr<const file_cache_entry> entry, std::uint64_t first, std::uint64_t end)
+			: entry_(std::move(entry)), pos_(first), end_(end)
+		{
+		#if !(defined(__unix__) || defined(__APPLE__))
+			if (this->in_memory())
+				return;
+
+			// without pread, each view has its own file.
+			error_code ec{};
+			this->file_.open(this->content().path.string().c_str(), file_mode::read, ec);
+			if (!ec)
+				this->file_.seek(first, ec);
+			if (ec)
+				this->entry_.reset();
+		#endif
+		}
+
+	#if defined(__unix__) || defined(__APPLE__)
+		inline native_handle_type native_handle() const noexcept
+		{
+			return this->entry_ ? this->content().file.native_handle() : -1;
+		}
+	#endif
+
+		inline bool is_open() const noexcept
+		{
+			return this->entry_ != nullptr;
+		}
+
+		inline void close(error_code& ec)
+		{
+			this->entry_.reset();
+			ec = {};
+		}
+
+		inline void open(char const*, file_mode, error_code& ec)
+		{
+			ec = make_error_code(errc::operation_not_supported);
+		}
+
+		inline std::uint64_t size(error_code& ec) const
+		{
+			ec = {};
+			return this->end_;
+		}
+
+		inline std::uint64_t pos(error_code& ec) const
+		{
+			ec = {};
+			return this->pos_;
+		}
+
+		inline void seek(std::uint64_t offset, error_code& ec)
+		{
+			this->pos_ = offset;
+		#if !(defined(__unix__) || defined(__APPLE__))
+			if (this->in_memory())
+				ec = {};
+			else
+				this->file_.seek(offset, ec);
+		#else
+			ec = {};
+		#endif
+		}
+
+		inline std::size_t read(void* buffer, std::size_t n, error_code& ec)
+		{
+			if (!this->entry_)
+			{
+				ec = make_error_code(errc::bad_file_descriptor);
+				return 0;
+			}
+
+			n = static_cast<std::size_t>((std::min)(std::uint64_t(n), this->end_ - (std::min)(this->pos_, this->end_)));
+
+			if (this->in_memory())
+			{
+				const std::string& data = this->content().data;
+				if (this->pos_ >= data.size())
+					n = 0;
+				else
+					n = (std::min)(n, data.size() - static_cast<std::size_t>(this->pos_));
+				if (n > 0)
+					std::memcpy(buffer, data.data() + this->pos_, n);
+				this->pos_ += n;
+				ec = {};
+				return n;
+			}
+
+		#if defined(__unix__) || defined(__APPLE__)
+			std::size_t nread = 0;
+			while (nread < n)
+			{
+				auto r = ::pread(this->content().file.native_handle(), static_cast<char*>(buffer) + nread,
+					n - nread, static_cast<off_t>(this->pos_ + nread));
+				if (r == -1)
+				{
+					if (errno == EINTR)
+						continue;
+					ec.assign(errno, system_category());
+					break;
+				}
+				if (r == 0)
+					break;
+				nread += static_cast<std::size_t>(r);
+			}
+			if (nread == n)
+				ec = {};
+		#else
+			std::size_t nread = this->file_.read(buffer, n, ec);
+		#endif
+
+			this->pos_ += nread;
+			return nread;
+		}
+
+		inline std::size_t write(void const*, std::size_t, error_code& ec)
+		{
+			ec = make_error_code(errc::operation_not_supported);
+			return 0;
+		}
+
+	protected:
+		inline const file_cache_entry& content() const noexcept
+		{
+			return this->entry_->source ? *this->entry_->source : *this->entry_;
+		}
+
+		inline bool in_memory() const noexcept
+		{
+			return !this->content().file.is_open();
+		}
+
+	protected:
+		std::shared_ptr<const file_cache_entry> entry_;
+
+		std::uint64_t                           pos_ = 0;
+
+		std::uint64_t                           end_ = 0;
+
+	#if !(defined(__unix__) || defined(__APPLE__))
+		native_file                             file_;
+	#endif
+	};
+
+	using cached_file_body = http::basic_file_body<cached_file>;
+
+	/**
+	 * @brief A range of the "Range: bytes=..." header, both the first and the last are inclusive.
+	 */
+	struct byte_range
+	{
+		std::uint64_t first = 0;
+		std::uint64_t last = 0;
+	};
+
+	/**
+	 * @brief Parse the value of the Range header of RFC 7233 against the size of the file.
+	 * @return std::nullopt if the header is invalid and must be ignored, an empty vector if
+	 * none of the ranges is satisfiable, otherwise the satisfiable ranges.
+	 */
+	inline std::optional<std::vector<byte_range>> parse_byte_ranges(
+		std::string_view value, std::uint64_t size, std::size_t max_ranges = 16)
+	{
+		constexpr std::string_view prefix = "bytes=";
+
+		value = asio::trim_both(value);
+
+		if (value.size() <= prefix.size() || !asio::iequals(value.substr(0, prefix.size()), prefix))
+			return std::nullopt;
+
+		value.remove_prefix(prefix.size());
+
+		auto number = [](std::string_view s, std::uint64_t& n) -> bool
+		{
+			if (s.empty() || s.size() > 19)
+				return false;
+			n = 0;
+			for (char c : s)
+			{
+				if (c < '0' || c > '9')
+					return false;
+				n = n * 10 + std::uint64_t(c - '0');
+			}
+			return true;
+		};
+
+		std::vector<byte_range> ranges;
+		std::size_t count = 0;
+
+		while (!value.empty())
+		{
+			std::size_t comma = value.find(',');
+			std::string_view spec = asio::trim_both(value.substr(0, comma));
+			value = comma == std::string_view::npos ? std::string_view{} : value.substr(comma + 1);
+
+			// the empty elements of the list are allowed, eg: "bytes=0-1,,5-6"
+			if (spec.empty())
+				continue;
+
+			if (++count > max_ranges)
+				return std::nullopt;
+
+			std::size_t dash = spec.find('-');
+			if (dash == std::string_view::npos)
+				return std::nullopt;
+
+			std::string_view first = asio::trim_both(spec.substr(0, dash));
+			std::string_view last = asio::trim_both(spec.substr(dash + 1));
+
+			std::uint64_t a = 0, b = 0;
+
+			if (first.empty())
+			{
+				// suffix range: the last b bytes.
+				if (!number(last, b))
+					return std::nullopt;
+				if (b == 0 || size == 0)
+					continue;
+				ranges.push_back({ size - (std::min)(b, size), size - 1 });
+			}
+			else
+			{
+				if (!number(first, a))
+					return std::nullopt;
+				if (last.empty())
+					b = size == 0 ? 0 : size - 1;
+				else if (!number(last, b) || b < a)
+					return std::nullopt;
+				if (a >= size)
+					continue;
+				ranges.push_back({ a, (std::min)(b, size - 1) });
+			}
+		}
+
+		if (count == 0)
+			return std::nullopt;
+
+		return ranges;
+	}
+}
+
+#ifdef ASIO3_HEADER_ONLY
+namespace bho::beast::http::detail
+#else
+namespace boost::beast::http::detail
+#endif
+{
+	struct file_cache_state : std::enable_shared_from_this<file_cache_state>
+	{
+		using entry_type = file_cache_entry;
+		using entry_ptr = std::shared_ptr<file_cache_entry>;
+
+		explicit file_cache_state(file_cache_option o) : opt(std::move(o))
+		{
+		}
+
+		~file_cache_state()
+		{
+		#if defined(__linux__)
+			if (this->desc)
+			{
+				error_code ec{};
+				this->desc->close(ec);
+			}
+		#endif
+		}
+
+		/**
+		 * @brief Start to watch the changes of the cached files by inotify, it's started once
+		 * by the first file which is opened, and isn't started again after it's stopped.
+		 * must be called with the mutex locked.
+		 */
+		inline void watch()
+		{
+		#if defined(__linux__)
+			if (!this->executor || this->desc)
+				return;
+
+			int fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+			if (fd == -1)
+				return;
+
+			// the descriptor is closed by the stop on the strand, while the coroutine may be
+			// reading it on another thread.
+			this->desc.emplace(asio::make_strand(*this->executor), fd);
+			this->watching = true;
+
+			asio::co_spawn(this->desc->get_executor(), [self = this->shared_from_this()]() -> asio::awaitable<void>
+			{
+				alignas(inotify_event) char buf[4096];
+
+				for (;;)
+				{
+					auto [ec, n] = co_await self->desc->async_read_some(
+						asio::buffer(buf), asio::as_tuple(asio::use_awaitable));
+					if (ec)
+						break;
+
+					std::lock_guard guard(self->mtx);
+
+					for (std::size_t i = 0; i + sizeof(inotify_event) <= n;)
+					{
+						const inotify_event* e = reinterpret_cast<const inotify_event*>(buf + i);
+
+						self->invalidate_watch(e->wd, (e->mask & IN_IGNORED) != 0);
+
+						i += sizeof(inotify_event) + e->len;
+					}
+				}
+			}, asio::detached);
+		#endif
+		}
+
+		/**
+		 * @brief Stop watching, the watching coroutine holds this state until it's stopped.
+		 * The cached files are revalidated by stat after that.
+		 */
+		inline void stop()
+		{
+		#if defined(__linux__)
+			std::lock_guard guard(this->mtx);
+
+			// the watching isn't started later by the open.
+			this->executor.reset();
+
+			if (this->desc && this->watching)
+			{
+				this->watching = false;
+
+				for (auto& e : this->lru)
+				{
+					e->watch = -1;
+					e->checked = {};
+				}
+
+				this->watches.clear();
+
+				asio::post(this->desc->get_executor(), [self = this->shared_from_this()]() mutable
+				{
+					std::lock_guard guard(self->mtx);
+
+					error_code ec{};
+					self->desc->close(ec);
+				});
+			}
+		#endif
+		}
+
+		inline bool watched() const noexcept
+		{
+		#if defined(__linux__)
+			return this->watching;
+		#else
+			return false;
+		#endif
+		}
+
+		// must be called with the mutex locked.
+		inline void erase(const entry_ptr& e)
+		{
+			this->entries.erase(std::string_view(e->key));
+			this->lru.erase(e->lru);
+
+			this->remove_watch(*e);
+		}
+
+		// must be called with the mutex locked.
+		inline void invalidate_watch(int wd, bool removed)
+		{
+		#if defined(__linux__)
+			auto [first, last] = this->watches.equal_range(wd);
+
+			if (first == last)
+				return;
+
+			std::vector<entry_ptr> stale;
+			for (auto it = first; it != last; ++it)
+			{
+				// the entry which is being opened isn't in the entries yet, it's marked stale.
+				it->second->stale = true;
+				it->second->watch = -1;
+
+				if (auto e = this->entries.find(std::string_view(it->second->key));
+					e != this->entries.end() && e->second.get() == it->second)
+					stale.emplace_back(e->second);
+			}
+
+			this->watches.erase(wd);
+
+			for (auto& e : stale)
+				this->erase(e);
+
+			if (!removed && this->desc && this->watching)
+				::inotify_rm_watch(this->desc->native_handle(), wd);
+		#else
+			asio::ignore_unused(wd, removed);
+		#endif
+		}
+
+		// must be called with the mutex locked.
+		inline void add_watch(file_cache_entry& e)
+		{
+		#if defined(__linux__)
+			if (!this->watching)
+				return;
+
+			int wd = ::inotify_add_watch(this->desc->native_handle(), e.path.c_str(),
+				IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF);
+			if (wd == -1)
+				return;
+
+			e.watch = wd;
+
+			this->watches.emplace(wd, &e);
+		#else
+			asio::ignore_unused(e);
+		#endif
+		}
+
+		// must be called with the mutex locked.
+		inline void remove_watch(file_cache_entry& e)
+		{
+		#if defined(__linux__)
+			if (e.watch == -1)
+				return;
+
+			auto [first, last] = this->watches.equal_range(e.watch);
+
+			std::size_t users = 0;
+			for (auto it = first; it != last;)
+			{
+				if (it->second == &e)
+					it = this->watches.erase(it);
+				else
+					++it, ++users;
+			}
+
+			// the files of the different keys may be the same file, which has only one watch.
+			if (users == 0 && this->watching)
+				::inotify_rm_watch(this->desc->native_handle(), e.watch);
+
+			e.watch = -1;
+		#else
+			asio::ignore_unused(e);
+		#endif
+		}
+
+		file_cache_option                                    opt;
+
+		std::mutex                                           mtx;
+
+		std::unordered_map<std::string_view, entry_ptr>      entries;
+
+		// the most recently used entry is at the front.
+		std::list<entry_ptr>                                 lru;
+
+		// The executor of the watching, it's empty if the changes aren't watched.
+		std::optional<asio::any_io_executor>                 executor;
+
+	#if defined(__linux__)
+		std::optional<asio::posix::stream_descriptor>        desc;
+
+		bool                                                 watching = false;
+
+		std::unordered_multimap<int, file_cache_entry*>      watches;
+	#endif
+	};
+
+	/**
+	 * @brief The threads which compress the cached files, the compression of a big file would
+	 * block the io thread too long.
+	 */
+	inline asio::thread_pool& file_cache_compressor()
+	{
+		static asio::thread_pool pool((std::max)(std::thread::hardware_concurrency() / 4, 1u));
+
+		return pool;
+	}
+
+	/**
+	 * @brief Get the size and the modification time of the opened file.
+	 */
+	inline bool file_cache_stat(file_cache_entry& e, error_code& ec)
+	{
+	#if defined(__unix__) || defined(__APPLE__)
+		struct stat st {};
+		if (::fstat(e.file.native_handle(), &st) != 0)
+		{
+			ec.assign(errno, system_category());
+			return false;
+		}
+
+		if (!S_ISREG(st.st_mode))
+		{
+			ec = make_error_code(errc::no_such_file_or_directory);
+			return false;
+		}
+
+		e.size = static_cast<std::uint64_t>(st.st_size);
+		e.mtime = st.st_mtime;
+	#else
+		if (!std::filesystem::is_regular_file(e.path, ec))
+		{
+			if (!ec)
+				ec = make_error_code(errc::no_such_file_or_directory);
+			return false;
+		}
+
+		e.size = e.file.size(ec);
+		if (ec)
+			return false;
+
+		auto t = std::filesystem::last_write_time(e.path, ec);
+		if (ec)
+			return false;
+
+		e.mtime = std::chrono::system_clock::to_time_t(
+			std::chrono::clock_cast<std::chrono::system_clock>(t));
+	#endif
+
+		ec = {};
+		return true;
+	}
+
+	/**
+	 * @brief Check whether the file at the path is still the cached one.
+	 */
+	inline bool file_cache_unchanged(const file_cache_entry& e)
+	{
+		error_code ec{};
+
+	#if defined(__unix__) || defined(__APPLE__)
+		struct stat st {};
+		if (::stat(e.path.c_str(), &st) != 0)
+			return false;
+
+		return S_ISREG(st.st_mode) && static_cast<std::uint64_t>(st.st_size) == e.size && st.st_mtime == e.mtime;
+	#else
+		auto size = std::filesystem::file_size(e.path, ec);
+		if (ec)
+			return false;
+
+		auto t = std::filesystem::last_write_time(e.path, ec);
+		if (ec)
+			return false;
+
+		return size == e.size && e.mtime == std::chrono::system_clock::to_time_t(
+			std::chrono::clock_cast<std::chrono::system_clock>(t));
+	#endif
+	}
+
+	/**
+	 * @brief Get the path part of the request target, without the query and the fragment.
+	 */
+	inline std::string_view file_cache_target_path(std::string_view target) noexcept
+	{
+		return target.substr(0, target.find_first_of("?#"));
+	}
+}
+
+#ifdef ASIO3_HEADER_ONLY
+namespace bho::beast::http
+#else
+namespace boost::beast::http
+#endif
+{
+	/**
+	 * @brief The cache of the opened files of the static file server. The descriptor, the size,
+	 * the modification time, the strong ETag and the response header of the hot files are kept,
+	 * so a cached file is served without resolving the path, opening the file and so on.
+	 * On linux, the cached files are watched by inotify when the cache is constructed with an
+	 * executor, a changed file is dropped from the cache at once. The watching is started by the
+	 * first open, and it must be stopped by the stop (or the destructor) to let the io_context
+	 * run out of work. Otherwise the cached file is checked by stat once per revalidate_interval.
+	 * It can be used across the threads.
+	 */
+	class file_cache
+	{
+	public:
+		using entry_ptr = std::shared_ptr<const file_cache_entry>;
+
+		/**
+		 * @brief constructor, the cached files are revalidated by stat periodically.
+		 */
+		explicit file_cache(file_cache_option opt = {})
+			: state_(std::make_shared<detail::file_cache_state>(std::move(opt)))
+		{
+		}
+
+		/**
+		 * @brief constructor, the changes of the cached files are watched on the executor since
+		 * the first file is opened.
+		 */
+		template<typename Executor>
+		requires (!std::same_as<std::remove_cvref_t<Executor>, file_cache_option>)
+		explicit file_cache(const Executor& ex, file_cache_option opt = {})
+			: file_cache(std::move(opt))
+		{
+			this->state_->executor.emplace(ex);
+		}
+
+		file_cache(file_cache&&) noexcept = default;
+
+		file_cache& operator=(file_cache&& other) noexcept
+		{
+			if (this != &other)
+			{
+				if (this->state_)
+					this->state_->stop();
+
+				this->state_ = std::move(other.state_);
+			}
+			return *this;
+		}
+
+		~file_cache()
+		{
+			if (this->state_)
+				this->state_->stop();
+		}
+
+		/**
+		 * @brief Stop watching the changes of the cached files, eg: when the server is stopped.
+		 * The cached files are revalidated by stat once per revalidate_interval after that.
+		 */
+		inline void stop()
+		{
+			if (this->state_)
+				this->state_->stop();
+		}
+
+		/**
+		 * @brief Get the cached file of the request target under the root directory, the file
+		 * is opened and cached if it's not cached yet.
+		 * @param root - The root directory, eg: the webroot of the server.
+		 * @param target - The request target, the query string is ignored.
+		 * @return The entry, or nullptr with the error if the file can't be opened or it's out
+		 * of the root directory.
+		 */
+		inline entry_ptr open(const std::filesystem::path& root, std::string_view target, error_code& ec)
+		{
+			auto& s = *this->state_;
+
+			std::string_view path = detail::file_cache_target_path(target);
+
+			std::string key;
+			key.reserve(root.native().size() + 1 + path.size());
+			key += root.string();
+			key += '\n';
+			key += path;
+
+			auto now = std::chrono::steady_clock::now();
+
+			{
+				std::lock_guard guard(s.mtx);
+
+				if (auto it = s.entries.find(std::string_view(key)); it != s.entries.end())
+				{
+					auto e = it->second;
+
+					bool fresh = s.watched() || now - e->checked < s.opt.revalidate_interval;
+
+					if (!fresh && detail::file_cache_unchanged(*e))
+					{
+						e->checked = now;
+						fresh = true;
+					}
+
+					if (fresh)
+					{
+						s.lru.splice(s.lru.begin(), s.lru, e->lru);
+
+						ec = {};
+						return e;
+					}
+
+					s.erase(e);
+				}
+			}
+
+			auto e = std::make_shared<file_cache_entry>();
+
+			e->key = std::move(key);
+			e->path = asio::make_filepath(root, std::filesystem::path(http::url_decode(path)));
+
+			if (e->path.empty())
+			{
+				ec = make_error_code(errc::no_such_file_or_directory);
+				return nullptr;
+			}
+
+			// the file is watched before it's opened and stat, so the change after the stat is
+			// never missed, the entry is dropped or isn't cached by the change.
+			{
+				std::lock_guard guard(s.mtx);
+
+				s.watch();
+				s.add_watch(*e);
+			}
+
+			auto unwatch = [&s, &e]() mutable
+			{
+				std::lock_guard guard(s.mtx);
+
+				s.remove_watch(*e);
+			};
+
+			e->file.open(e->path.string().c_str(), file_mode::scan, ec);
+			if (ec)
+			{
+				unwatch();
+				return nullptr;
+			}
+
+			if (!detail::file_cache_stat(*e, ec))
+			{
+				unwatch();
+				return nullptr;
+			}
+
+			char etag[48]{};
+			std::snprintf(etag, sizeof(etag), "\"%llx-%llx\"",
+				static_cast<unsigned long long>(e->mtime), static_cast<unsigned long long>(e->size));
+
+			e->header.result(http::status::ok);
+			e->header.set(http::field::server, BEAST_VERSION_STRING);
+			e->header.set(http::field::content_type, http::extension_to_mimetype(e->path.extension().string()));
+			e->header.set(http::field::accept_ranges, "bytes");
+			e->header.set(http::field::etag, etag);
+			e->header.set(http::field::last_modified,
+				http::format_date(std::chrono::sys_seconds(std::chrono::seconds(e->mtime))));
+
+			std::lock_guard guard(s.mtx);
+
+			// the response of the file which may have a gzip variant depends on the Accept-Encoding.
+			if ((s.opt.gzip || s.opt.gzip_static) && http::is_compressible_mimetype(
+				asio::to_string_view(e->header[http::field::content_type])))
+				e->header.set(http::field::vary, "Accept-Encoding");
+
+			e->checked = now;
+
+			// another thread has cached the same file meanwhile.
+			if (auto it = s.entries.find(std::string_view(e->key)); it != s.entries.end())
+			{
+				s.remove_watch(*e);
+
+				ec = {};
+				return it->second;
+			}
+
+			// the file is changed since it's watched, it's served once but not cached.
+			if (e->stale)
+			{
+				s.remove_watch(*e);
+
+				ec = {};
+				return e;
+			}
+
+			s.lru.push_front(e);
+			e->lru = s.lru.begin();
+			s.entries.emplace(std::string_view(e->key), e);
+
+			while (s.entries.size() > s.opt.max_count && s.lru.size() > 1)
+			{
+				auto last = s.lru.back();
+				s.erase(last);
+			}
+
+			ec = {};
+			return e;
+		}
+
+		/**
+		 * @brief Get the gzip variant of the cached file, it's the sibling "file.gz" if it exists,
+		 * otherwise the file which is compressed once in memory. The variant is kept with the
+		 * cached file, the sibling which is created after the file is compressed is used when
+		 * the file is changed or dropped from the cache.
+		 * The file is compressed by a background thread, nullptr is returned until it's done.
+		 * @param root - The root directory, eg: the webroot of the server.
+		 * @param target - The request target of the cached file.
+		 * @param e - The cached file which is returned by the open.
+		 * @return The variant, or nullptr if the file has no gzip variant.
+		 */
+		inline entry_ptr open_gzip(const std::filesystem::path& root, std::string_view target, const entry_ptr& e)
+		{
+			using variant = file_cache_entry::variant;
+
+			auto& s = *this->state_;
+
+			variant kind;
+			entry_ptr gz;
+			file_cache_option opt;
+
+			{
+				std::lock_guard guard(s.mtx);
+
+				kind = e->gzip_kind;
+				gz = e->gzip;
+				opt = s.opt;
+			}
+
+			if (kind == variant::compressed)
+				return gz;
+
+			if (kind == variant::none || kind == variant::compressing)
+				return nullptr;
+
+			if (opt.gzip_static)
+			{
+				std::string sibling{ detail::file_cache_target_path(target) };
+				sibling += ".gz";
+
+				// the sibling is cached as a file too, so it's revalidated like the others, and
+				// the variant is remade when the sibling is changed.
+				error_code ec{};
+				if (auto src = this->open(root, sibling, ec); src)
+				{
+					if (gz && gz->source == src)
+						return gz;
+
+					auto v = this->make_gzip_variant(e, src->header[http::field::etag]);
+					v->source = src;
+					v->size = src->size;
+
+					std::lock_guard guard(s.mtx);
+
+					e->gzip_kind = variant::sibling;
+					e->gzip = v;
+
+					return v;
+				}
+			}
+
+			std::lock_guard guard(s.mtx);
+
+			if (!opt.gzip || e->size < opt.gzip_min_size || e->size > opt.gzip_max_size ||
+				!http::is_compressible_mimetype(asio::to_string_view(e->header[http::field::content_type])))
+			{
+				e->gzip_kind = variant::none;
+				e->gzip.reset();
+
+				return nullptr;
+			}
+
+			// the file is compressed once, the requests meanwhile are answered with the whole file.
+			if (e->gzip_kind == variant::compressing || e->gzip_kind == variant::compressed)
+				return e->gzip;
+
+			e->gzip_kind = variant::compressing;
+
+			asio::post(detail::file_cache_compressor(),
+			[state = std::weak_ptr<detail::file_cache_state>(this->state_), e, level = opt.gzip_level]() mutable
+			{
+				auto v = file_cache::make_compressed_variant(e, level);
+
+				auto sp = state.lock();
+				if (!sp)
+					return;
+
+				std::lock_guard guard(sp->mtx);
+
+				e->gzip_kind = v ? variant::compressed : variant::none;
+				e->gzip = std::move(v);
+			});
+
+			return nullptr;
+		}
+
+		/**
+		 * @brief Make the response of the cached file for the request.
+		 * The conditional request (If-None-Match, If-Modified-Since) is answered with 304, the
+		 * Range request (with If-Range) is answered with 206 or 416, otherwise the whole file.
+		 */
+		template<class RequestT>
+		inline http::web_response make_response(const entry_ptr& e, const RequestT& req)
+		{
+			const auto& opt = this->state_->opt;
+
+			if (http::is_not_modified(req, e->header))
+			{
+				auto rep = http::make_not_modified_response(e->header);
+				rep.version(req.version() < 10 ? 11 : req.version());
+				return rep;
+			}
+
+			std::optional<std::vector<http::byte_range>> ranges;
+
+			if (req.method() == http::verb::get)
+			{
+				if (auto it = req.find(http::field::range); it != req.end() && this->if_range_matches(e, req))
+					ranges = http::parse_byte_ranges(asio::to_string_view(it->value()), e->size, opt.max_ranges);
+			}
+
+			if (ranges.has_value() && ranges->empty())
+			{
+				http::response<http::string_body> rep{ http::status::range_not_satisfiable, req.version() };
+				http::set_server_and_date(rep);
+				rep.set(http::field::content_range, "bytes */" + std::to_string(e->size));
+				rep.prepare_payload();
+				return rep;
+			}
+
+			if (ranges.has_value() && ranges->size() > 1)
+			{
+				std::uint64_t total = 0;
+				for (auto& r : *ranges)
+					total += r.last - r.first + 1;
+
+				if (total <= opt.max_multirange_bytes)
+					return this->make_multirange_response(e, req, *ranges);
+			}
+
+			http::response<cached_file_body> rep{};
+			static_cast<http::response_header<>&>(rep) = e->header;
+			rep.version(req.version() < 10 ? 11 : req.version());
+			rep.set(http::field::date, http::current_date());
+
+			std::uint64_t first = 0, end = e->size;
+
+			if (ranges.has_value() && ranges->size() == 1)
+			{
+				first = ranges->front().first;
+				end = ranges->front().last + 1;
+
+				rep.result(http::status::partial_content);
+				rep.set(http::field::content_range, "bytes " + std::to_string(first) + "-" +
+					std::to_string(end - 1) + "/" + std::to_string(e->size));
+			}
+
+			error_code ec{};
+			rep.body().reset(cached_file(e, first, end), ec);
+			rep.content_length(end - first);
+
+			return rep;
+		}
+
+		/**
+		 * @brief Remove all the cached files.
+		 */
+		inline void clear()
+		{
+			auto& s = *this->state_;
+
+			std::lock_guard guard(s.mtx);
+
+			while (!s.lru.empty())
+			{
+				auto last = s.lru.back();
+				s.erase(last);
+			}
+		}
+
+		/**
+		 * @brief Get the count of the cached files.
+		 */
+		inline std::size_t size()
+		{
+			std::lock_guard guard(this->state_->mtx);
+
+			return this->state_->entries.size();
+		}
+
+		/**
+		 * @brief Set the max count of the files which are kept opened in the cache.
+		 */
+		inline file_cache& set_max_count(std::size_t count)
+		{
+			std::lock_guard guard(this->state_->mtx);
+
+			this->state_->opt.max_count = (std::max)(count, std::size_t(1));
+
+			return *this;
+		}
+
+	protected:
+		/**
+		 * @brief Make the variant entry of the file, its fields are the ones of the file except
+		 * the ETag and the Content-Encoding.
+		 */
+		template<class String>
+		static inline std::shared_ptr<file_cache_entry> make_gzip_variant(const entry_ptr& e, const String& etag)
+		{
+			auto v = std::make_shared<file_cache_entry>();
+
+			v->key = e->key;
+			v->path = e->path;
+			v->mtime = e->mtime;
+			v->header = e->header;
+			v->header.set(http::field::etag, etag);
+			v->header.set(http::field::content_encoding, "gzip");
+			v->header.set(http::field::vary, "Accept-Encoding");
+
+			return v;
+		}
+
+		/**
+		 * @brief Compress the whole file into the in-memory gzip variant, it's called by the
+		 * compressor threads.
+		 * @return The variant, or nullptr if the file can't be read or it's compressed badly.
+		 */
+		static inline entry_ptr make_compressed_variant(const entry_ptr& e, int level)
+		{
+			std::string data;
+			data.resize(static_cast<std::size_t>(e->size));
+
+			error_code ec{};
+			cached_file f(e, 0, e->size);
+			if (f.read(data.data(), data.size(), ec) != data.size() || ec)
+				return nullptr;
+
+			std::string compressed = http::compress(data, content_coding::gzip, level, ec);
+
+			// the file which is compressed badly isn't worth a variant.
+			if (ec || compressed.size() >= data.size())
+				return nullptr;
+
+			// the strong ETag of the variant must differ from the one of the file: "mtime-size-gz"
+			auto v = file_cache::make_gzip_variant(e, e->header[http::field::etag]);
+			http::set_encoded_etag(v->header, content_coding::gzip);
+			v->data = std::move(compressed);
+			v->size = v->data.size();
+
+			return v;
+		}
+
+		/**
+		 * @brief The Range is ignored if the If-Range doesn't match the current file.
+		 */
+		template<class RequestT>
+		inline bool if_range_matches(const entry_ptr& e, const RequestT& req)
+		{
+			auto it = req.find(http::field::if_range);
+			if (it == req.end())
+				return true;
+
+			std::string_view value = asio::trim_both(asio::to_string_view(it->value()));
+
+			// the If-Range with an entity tag requires the strong comparison.
+			if (value.starts_with('"'))
+				return value == asio::to_string_view(e->header[http::field::etag]);
+
+			auto since = http::parse_date(value);
+
+			return since && since->time_since_epoch().count() == e->mtime;
+		}
+
+		template<class RequestT>
+		inline http::web_response make_multirange_response(
+			const entry_ptr& e, const RequestT& req, const std::vector<http::byte_range>& ranges)
+		{
+			thread_local std::mt19937_64 gen{ std::random_device{}() };
+
+			char boundary[24]{};
+			std::snprintf(boundary, sizeof(boundary), "%016llx", static_cast<unsigned long long>(gen()));
+
+			std::string_view mimetype = asio::to_string_view(e->header[http::field::content_type]);
+
+			http::response<http::string_body> rep{ http::status::partial_content, req.version() < 10 ? 11 : req.version() };
+			http::set_server_and_date(rep);
+			rep.set(http::field::accept_ranges, "bytes");
+			rep.set(http::field::etag, e->header[http::field::etag]);
+			rep.set(http::field::last_modified, e->header[http::field::last_modified]);
+			rep.set(http::field::content_type, std::string("multipart/byteranges; boundary=") + boundary);
+
+			std::string& body = rep.body();
+
+			for (auto& r : ranges)
+			{
+				body += "\r\n--";
+				body += boundary;
+				body += "\r\nContent-Type: ";
+				body += mimetype;
+				body += "\r\nContent-Range: bytes ";
+				body += std::to_string(r.first);
+				body += '-';
+				body += std::to_string(r.last);
+				body += '/';
+				body += std::to_string(e->size);
+				body += "\r\n\r\n";
+
+				std::size_t offset = body.size();
+				std::size_t n = static_cast<std::size_t>(r.last - r.first + 1);
+
+				body.resize(offset + n);
+
+				error_code ec{};
+				cached_file f(e, r.first, r.last + 1);
+				std::size_t nread = f.read(body.data() + offset, n, ec);
+				body.resize(offset + nread);
+			}
+
+			body += "\r\n--";
+			body += boundary;
+			body += "--\r\n";
+
+			rep.prepare_payload();
+
+			return rep;
+		}
+
+	protected:
+		std::shared_ptr<detail::file_cache_state> state_;
+	};
+
+	/**
+	 * @brief Respond to http request with the file under the root directory by the file cache.
+	 * The conditional and the Range requests are answered too, see file_cache::make_response.
+	 * The gzip variant of the file is sent if the request accepts gzip, see file_cache::open_gzip.
+	 * @return The response, or the error if the file can't be opened (eg: it doesn't exist).
+	 */
+	template<class RequestT>
+	inline std::expected<http::web_response, error_code> make_file_response(
+		http::file_cache& cache, const std::filesystem::path& root, const RequestT& req)
+	{
+		error_code ec{};
+
+		auto e = cache.open(root, asio::to_string_view(req.target()), ec);
+		if (!e)
+			return std::unexpected(ec);
+
+		if (auto it = req.find(http::field::accept_encoding); it != req.end() &&
+			http::is_encoding_accepted(asio::to_string_view(it->value()), "gzip"))
+		{
+			if (auto v = cache.open_gzip(root, asio::to_string_view(req.target()), e))
+				return cache.make_response(v, req);
+		}
+
+		return cache.make_response(e, req);
+	}
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2017-2023 zhllxt
+ *
+ * author   : zhllxt
+ * email    : 37792738@qq.com
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <asio3/core/beast.hpp>
+
+#ifdef ASIO3_HEADER_ONLY
+namespace bho::beast::http::detail
+#else
+namespace boost::beast::http::detail
+#endif
+{
+	struct http_date_cache
+	{
+		std::chrono::sys_seconds time{};
+
+		// "Sun, 06 Nov 1994 08:49:37 GMT" and the null terminator
+		char buf[30]{};
+
+		std::size_t size = 0;
+	};
+}
+
+#ifdef ASIO3_HEADER_ONLY
+namespace bho::beast::http
+#else
+namespace boost::beast::http
+#endif
+{
+	/**
+	 * @brief Format the time as the IMF-fixdate of RFC 7231, eg: "Sun, 06 Nov 1994 08:49:37 GMT".
+	 * @return The size of the formatted string, the buffer must be 30 bytes at least.
+	 */
+	inline std::size_t format_date(std::chrono::sys_seconds tp, char* buf, std::size_t size) noexcept
+	{
+		static constexpr const char* weekdays[] = {
+			"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+		static constexpr const char* months[] = {
+			"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+		auto days = std::chrono::floor<std::chrono::days>(tp);
+		std::chrono::year_month_day ymd{ days };
+		std::chrono::weekday wd{ days };
+		std::chrono::hh_mm_ss hms{ tp - days };
+
+		int n = std::snprintf(buf, size, "%s, %02u %s %04d %02d:%02d:%02d GMT",
+			weekdays[wd.c_encoding()],
+			static_cast<unsigned>(ymd.day()),
+			months[static_cast<unsigned>(ymd.month()) - 1],
+			static_cast<int>(ymd.year()),
+			static_cast<int>(hms.hours().count()),
+			static_cast<int>(hms.minutes().count()),
+			static_cast<int>(hms.seconds().count()));
+
+		return n > 0 ? (std::min)(static_cast<std::size_t>(n), size - 1) : 0;
+	}
+
+	/**
+	 * @brief Format the time as the IMF-fixdate of RFC 7231, eg: "Sun, 06 Nov 1994 08:49:37 GMT".
+	 */
+	inline std::string format_date(std::chrono::sys_seconds tp)
+	{
+		char buf[32]{};
+		return std::string(buf, http::format_date(tp, buf, sizeof(buf)));
+	}
+
+	/**
+	 * @brief Get the current time formatted as the value of the Date header (the IMF-fixdate
+	 * of RFC 7231), the value is rendered at most once per second in each thread.
+	 */
+	inline std::string_view current_date()
+	{
+		thread_local detail::http_date_cache cache{};
+
+		auto now = std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now());
+
+		if (now != cache.time)
+		{
+			cache.size = http::format_date(now, cache.buf, sizeof(cache.buf));
+			cache.time = now;
+		}
+
+		return std::string_view{ cache.buf, cache.size };
+	}
+
+	/**
+	 * @brief Parse the IMF-fixdate of RFC 7231, eg: "Sun, 06 Nov 1994 08:49:37 GMT".
+	 * The obsolete formats (rfc850 and asctime) are not supported.
+	 */
+	inline std::optional<std::chrono::sys_seconds> parse_date(std::string_view str) noexcept
+	{
+		static constexpr std::string_view months = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+		// "Sun, 06 Nov 1994 08:49:37 GMT"
+		if (str.size() != 29 || str[3] != ',' || str.substr(25) != " GMT")
+			return std::nullopt;
+
+		auto number = [str](std::size_t pos, std::size_t len) -> int
+		{
+			int v = 0;
+			for (std::size_t i = pos; i < pos + len; ++i)
+			{
+				if (str[i] < '0' || str[i] > '9')
+					return -1;
+				v = v * 10 + (str[i] - '0');
+			}
+			return v;
+		};
+
+		int day = number(5, 2), year = number(12, 4);
+		int hour = number(17, 2), minute = number(20, 2), second = number(23, 2);
+
+		std::size_t month = months.find(str.substr(8, 3));
+
+		if (day < 0 || year < 0 || hour < 0 || hour > 23 || minute < 0 || minute > 59 ||
+			second < 0 || second > 60 || month == std::string_view::npos || month % 3 != 0)
+			return std::nullopt;
+
+		std::chrono::year_month_day ymd{ std::chrono::year(year),
+			std::chrono::month(static_cast<unsigned>(month / 3 + 1)), std::chrono::day(static_cast<unsigned>(day)) };
+
+		if (!ymd.ok())
+			return std::nullopt;
+
+		return std::chrono::sys_days(ymd) + std::chrono::hours(hour) +
+			std::chrono::minutes(minute) + std::chrono::seconds(second);
+	}
+
+	/**
+	 * @brief Set the Server and the Date fields of the response, the Date is taken from the
+	 * per-thread Date cache, see current_date.
+	 */
+	template<class Fields>
+	inline void set_server_and_date(http::header<false, Fields>& h)
+	{
+		h.set(http::field::server, BEAST_VERSION_STRING);
+		h.set(http::field::date, http::current_date());
+	}
+}
@@ -0,0 +1,743 @@
+/*
+ * Copyright (c) 2017-2023 zhllxt
+ *
+ * author   : zhllxt
+ * email    : 37792738@qq.com
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <asio3/core/asio.hpp>
+#include <asio3/core/beast.hpp>
+
+#ifdef ASIO3_HEADER_ONLY
+namespace bho::beast::http::detail
+#else
+namespace boost::beast::http::detail
+#endif
+{
+	// The static table of RFC 7541 Appendix A, the index of the first entry is 1.
+	inline constexpr std::pair<std::string_view, std::string_view> hpack_static_table[61] = {
+		{ ":authority", "" },
+		{ ":method", "GET" },
+		{ ":method", "POST" },
+		{ ":path", "/" },
+		{ ":path", "/index.html" },
+		{ ":scheme", "http" },
+		{ ":scheme", "https" },
+		{ ":status", "200" },
+		{ ":status", "204" },
+		{ ":status", "206" },
+		{ ":status", "304" },
+		{ ":status", "400" },
+		{ ":status", "404" },
+		{ ":status", "500" },
+		{ "accept-charset", "" },
+		{ "accept-encoding", "gzip, deflate" },
+		{ "accept-language", "" },
+		{ "accept-ranges", "" },
+		{ "accept", "" },
+		{ "access-control-allow-origin", "" },
+		{ "age", "" },
+		{ "allow", "" },
+		{ "authorization", "" },
+		{ "cache-control", "" },
+		{ "content-disposition", "" },
+		{ "content-encoding", "" },
+		{ "content-language", "" },
+		{ "content-length", "" },
+		{ "content-location", "" },
+		{ "content-range", "" },
+		{ "content-type", "" },
+		{ "cookie", "" },
+		{ "date", "" },
+		{ "etag", "" },
+		{ "expect", "" },
+		{ "expires", "" },
+		{ "from", "" },
+		{ "host", "" },
+		{ "if-match", "" },
+		{ "if-modified-since", "" },
+		{ "if-none-match", "" },
+		{ "if-range", "" },
+		{ "if-unmodified-since", "" },
+		{ "last-modified", "" },
+		{ "link", "" },
+		{ "location", "" },
+		{ "max-forwards", "" },
+		{ "proxy-authenticate", "" },
+		{ "proxy-authorization", "" },
+		{ "range", "" },
+		{ "referer", "" },
+		{ "refresh", "" },
+		{ "retry-after", "" },
+		{ "server", "" },
+		{ "set-cookie", "" },
+		{ "strict-transport-security", "" },
+		{ "transfer-encoding", "" },
+		{ "user-agent", "" },
+		{ "vary", "" },
+		{ "via", "" },
+		{ "www-authenticate", "" },
+	};
+
+	// The code and the bit length of each symbol, the last one is the EOS, RFC 7541 Appendix B.
+	inline constexpr std::pair<std::uint32_t, std::uint8_t> hpack_huffman_codes[257] = {
+		{ 0x00001ff8, 13 }, { 0x007fffd8, 23 }, { 0x0fffffe2, 28 }, { 0x0fffffe3, 28 },
+		{ 0x0fffffe4, 28 }, { 0x0fffffe5, 28 }, { 0x0fffffe6, 28 }, { 0x0fffffe7, 28 },
+		{ 0x0fffffe8, 28 }, { 0x00ffffea, 24 }, { 0x3ffffffc, 30 }, { 0x0fffffe9, 28 },
+		{ 0x0fffffea, 28 }, { 0x3ffffffd, 30 }, { 0x0fffffeb, 28 }, { 0x0fffffec, 28 },
+		{ 0x0fffffed, 28 }, { 0x0fffffee, 28 }, { 0x0fffffef, 28 }, { 0x0ffffff0, 28 },
+		{ 0x0ffffff1, 28 }, { 0x0ffffff2, 28 }, { 0x3ffffffe, 30 }, { 0x0ffffff3, 28 },
+		{ 0x0ffffff4, 28 }, { 0x0ffffff5, 28 }, { 0x0ffffff6, 28 }, { 0x0ffffff7, 28 },
+		{ 0x0ffffff8, 28 }, { 0x0ffffff9, 28 }, { 0x0ffffffa, 28 }, { 0x0ffffffb, 28 },
+		{ 0x00000014,  6 }, { 0x000003f8, 10 }, { 0x000003f9, 10 }, { 0x00000ffa, 12 },
+		{ 0x00001ff9, 13 }, { 0x00000015,  6 }, { 0x000000f8,  8 }, { 0x000007fa, 11 },
+		{ 0x000003fa, 10 }, { 0x000003fb, 10 }, { 0x000000f9,  8 }, { 0x000007fb, 11 },
+		{ 0x000000fa,  8 }, { 0x00000016,  6 }, { 0x00000017,  6 }, { 0x00000018,  6 },
+		{ 0x00000000,  5 }, { 0x00000001,  5 }, { 0x00000002,  5 }, { 0x00000019,  6 },
+		{ 0x0000001a,  6 }, { 0x0000001b,  6 }, { 0x0000001c,  6 }, { 0x0000001d,  6 },
+		{ 0x0000001e,  6 }, { 0x0000001f,  6 }, { 0x0000005c,  7 }, { 0x000000fb,  8 },
+		{ 0x00007ffc, 15 }, { 0x00000020,  6 }, { 0x00000ffb, 12 }, { 0x000003fc, 10 },
+		{ 0x00001ffa, 13 }, { 0x00000021,  6 }, { 0x0000005d,  7 }, { 0x0000005e,  7 },
+		{ 0x0000005f,  7 }, { 0x00000060,  7 }, { 0x00000061,  7 }, { 0x00000062,  7 },
+		{ 0x00000063,  7 }, { 0x00000064,  7 }, { 0x00000065,  7 }, { 0x00000066,  7 },
+		{ 0x00000067,  7 }, { 0x00000068,  7 }, { 0x00000069,  7 }, { 0x0000006a,  7 },
+		{ 0x0000006b,  7 }, { 0x0000006c,  7 }, { 0x0000006d,  7 }, { 0x0000006e,  7 },
+		{ 0x0000006f,  7 }, { 0x00000070,  7 }, { 0x00000071,  7 }, { 0x00000072,  7 },
+		{ 0x000000fc,  8 }, { 0x00000073,  7 }, { 0x000000fd,  8 }, { 0x00001ffb, 13 },
+		{ 0x0007fff0, 19 }, { 0x00001ffc, 13 }, { 0x00003ffc, 14 }, { 0x00000022,  6 },
+		{ 0x00007ffd, 15 }, { 0x00000003,  5 }, { 0x00000023,  6 }, { 0x00000004,  5 },
+		{ 0x00000024,  6 }, { 0x00000005,  5 }, { 0x00000025,  6 }, { 0x00000026,  6 },
+		{ 0x00000027,  6 }, { 0x00000006,  5 }, { 0x00000074,  7 }, { 0x00000075,  7 },
+		{ 0x00000028,  6 }, { 0x00000029,  6 }, { 0x0000002a,  6 }, { 0x00000007,  5 },
+		{ 0x0000002b,  6 }, { 0x00000076,  7 }, { 0x0000002c,  6 }, { 0x00000008,  5 },
+		{ 0x00000009,  5 }, { 0x0000002d,  6 }, { 0x00000077,  7 }, { 0x00000078,  7 },
+		{ 0x00000079,  7 }, { 0x0000007a,  7 }, { 0x0000007b,  7 }, { 0x00007ffe, 15 },
+		{ 0x000007fc, 11 }, { 0x00003ffd, 14 }, { 0x00001ffd, 13 }, { 0x0ffffffc, 28 },
+		{ 0x000fffe6, 20 }, { 0x003fffd2, 22 }, { 0x000fffe7, 20 }, { 0x000fffe8, 20 },
+		{ 0x003fffd3, 22 }, { 0x003fffd4, 22 }, { 0x003fffd5, 22 }, { 0x007fffd9, 23 },
+		{ 0x003fffd6, 22 }, { 0x007fffda, 23 }, { 0x007fffdb, 23 }, { 0x007fffdc, 23 },
+		{ 0x007fffdd, 23 }, { 0x007fffde, 23 }, { 0x00ffffeb, 24 }, { 0x007fffdf, 23 },
+		{ 0x00ffffec, 24 }, { 0x00ffffed, 24 }, { 0x003fffd7, 22 }, { 0x007fffe0, 23 },
+		{ 0x00ffffee, 24 }, { 0x007fffe1, 23 }, { 0x007fffe2, 23 }, { 0x007fffe3, 23 },
+		{ 0x007fffe4, 23 }, { 0x001fffdc, 21 }, { 0x003fffd8, 22 }, { 0x007fffe5, 23 },
+		{ 0x003fffd9, 22 }, { 0x007fffe6, 23 }, { 0x007fffe7, 23 }, { 0x00ffffef, 24 },
+		{ 0x003fffda, 22 }, { 0x001fffdd, 21 }, { 0x000fffe9, 20 }, { 0x003fffdb, 22 },
+		{ 0x003fffdc, 22 }, { 0x007fffe8, 23 }, { 0x007fffe9, 23 }, { 0x001fffde, 21 },
+		{ 0x007fffea, 23 }, { 0x003fffdd, 22 }, { 0x003fffde, 22 }, { 0x00fffff0, 24 },
+		{ 0x001fffdf, 21 }, { 0x003fffdf, 22 }, { 0x007fffeb, 23 }, { 0x007fffec, 23 },
+		{ 0x001fffe0, 21 }, { 0x001fffe1, 21 }, { 0x003fffe0, 22 }, { 0x001fffe2, 21 },
+		{ 0x007fffed, 23 }, { 0x003fffe1, 22 }, { 0x007fffee, 23 }, { 0x007fffef, 23 },
+		{ 0x000fffea, 20 }, { 0x003fffe2, 22 }, { 0x003fffe3, 22 }, { 0x003fffe4, 22 },
+		{ 0x007ffff0, 23 }, { 0x003fffe5, 22 }, { 0x003fffe6, 22 }, { 0x007ffff1, 23 },
+		{ 0x03ffffe0, 26 }, { 0x03ffffe1, 26 }, { 0x000fffeb, 20 }, { 0x0007fff1, 19 },
+		{ 0x003fffe7, 22 }, { 0x007ffff2, 23 }, { 0x003fffe8, 22 }, { 0x01ffffec, 25 },
+		{ 0x03ffffe2, 26 }, { 0x03ffffe3, 26 }, { 0x03ffffe4, 26 }, { 0x07ffffde, 27 },
+		{ 0x07ffffdf, 27 }, { 0x03ffffe5, 26 }, { 0x00fffff1, 24 }, { 0x01ffffed, 25 },
+		{ 0x0007fff2, 19 }, { 0x001fffe3, 21 }, { 0x03ffffe6, 26 }, { 0x07ffffe0, 27 },
+		{ 0x07ffffe1, 27 }, { 0x03ffffe7, 26 }, { 0x07ffffe2, 27 }, { 0x00fffff2, 24 },
+		{ 0x001fffe4, 21 }, { 0x001fffe5, 21 }, { 0x03ffffe8, 26 }, { 0x03ffffe9, 26 },
+		{ 0x0ffffffd, 28 }, { 0x07ffffe3, 27 }, { 0x07ffffe4, 27 }, { 0x07ffffe5, 27 },
+		{ 0x000fffec, 20 }, { 0x00fffff3, 24 }, { 0x000fffed, 20 }, { 0x001fffe6, 21 },
+		{ 0x003fffe9, 22 }, { 0x001fffe7, 21 }, { 0x001fffe8, 21 }, { 0x007ffff3, 23 },
+		{ 0x003fffea, 22 }, { 0x003fffeb, 22 }, { 0x01ffffee, 25 }, { 0x01ffffef, 25 },
+		{ 0x00fffff4, 24 }, { 0x00fffff5, 24 }, { 0x03ffffea, 26 }, { 0x007ffff4, 23 },
+		{ 0x03ffffeb, 26 }, { 0x07ffffe6, 27 }, { 0x03ffffec, 26 }, { 0x03ffffed, 26 },
+		{ 0x07ffffe7, 27 }, { 0x07ffffe8, 27 }, { 0x07ffffe9, 27 }, { 0x07ffffea, 27 },
+		{ 0x07ffffeb, 27 }, { 0x0ffffffe, 28 }, { 0x07ffffec, 27 }, { 0x07ffffed, 27 },
+		{ 0x07ffffee, 27 }, { 0x07ffffef, 27 }, { 0x07fffff0, 27 }, { 0x03ffffee, 26 },
+		{ 0x3fffffff, 30 },
+	};
+
+	/**
+	 * @brief The binary tree of the huffman codes, it's built once at the first use.
+	 * Each node has two children which are the indexes of the nodes, or the symbol
+	 * if the node is a leaf.
+	 */
+	struct hpack_huffman_tree
+	{
+		struct node
+		{
+			std::int16_t child[2] = { -1, -1 };
+			std::int16_t symbol = -1;
+		};
+
+		std::vector<node> nodes;
+
+		hpack_huffman_tree()
+		{
+			nodes.reserve(513);
+			nodes.emplace_back();
+
+			for (std::size_t sym = 0; sym < std::size(hpack_huffman_codes); ++sym)
+			{
+				auto [code, len] = hpack_huffman_codes[sym];
+
+				std::size_t cur = 0;
+
+				for (int i = len - 1; i >= 0; --i)
+				{
+					int bit = (code >> i) & 1;
+
+					if (nodes[cur].child[bit] == -1)
+					{
+						nodes[cur].child[bit] = static_cast<std::int16_t>(nodes.size());
+						nodes.emplace_back();
+					}
+
+					cur = static_cast<std::size_t>(nodes[cur].child[bit]);
+				}
+
+				nodes[cur].symbol = static_cast<std::int16_t>(sym);
+			}
+		}
+
+		static const hpack_huffman_tree& get()
+		{
+			static const hpack_huffman_tree tree;
+			return tree;
+		}
+	};
+
+	/**
+	 * @brief Decode the huffman encoded string, returns false if the string is invalid.
+	 */
+	inline bool hpack_huffman_decode(std::string_view in, std::string& out)
+	{
+		const auto& nodes = hpack_huffman_tree::get().nodes;
+
+		std::size_t cur = 0;
+
+		// the bits since the last symbol, the padding must be the most significant bits
+		// of the EOS (all ones) and shorter than 8 bits.
+		std::size_t depth = 0;
+		bool all_ones = true;
+
+		for (unsigned char c : in)
+		{
+			for (int i = 7; i >= 0; --i)
+			{
+				int bit = (c >> i) & 1;
+
+				std::int16_t next = nodes[cur].child[bit];
+				if (next == -1)
+					return false;
+
+				cur = static_cast<std::size_t>(next);
+				++depth;
+				all_ones = all_ones && bit;
+
+				if (std::int16_t sym = nodes[cur].symbol; sym != -1)
+				{
+					// a string must not contain the EOS.
+					if (sym == 256)
+						return false;
+
+					out.push_back(static_cast<char>(sym));
+
+					cur = 0;
+					depth = 0;
+					all_ones = true;
+				}
+			}
+		}
+
+		return depth < 8 && all_ones;
+	}
+
+	inline std::size_t hpack_huffman_size(std::string_view in) noexcept
+	{
+		std::size_t bits = 0;
+		for (unsigned char c : in)
+			bits += hpack_huffman_codes[c].second;
+		return (bits + 7) / 8;
+	}
+
+	inline void hpack_huffman_encode(std::string_view in, std::string& out)
+	{
+		std::uint64_t acc = 0;
+		int bits = 0;
+
+		for (unsigned char c : in)
+		{
+			auto [code, len] = hpack_huffman_codes[c];
+
+			acc = (acc << len) | code;
+			bits += len;
+
+			while (bits >= 8)
+			{
+				bits -= 8;
+				out.push_back(static_cast<char>(acc >> bits));
+			}
+		}
+
+		// pad with the most significant bits of the EOS.
+		if (bits > 0)
+			out.push_back(static_cast<char>((acc << (8 - bits)) | (0xff >> bits)));
+	}
+
+	/**
+	 * @brief Encode the integer with a N-bit prefix, the first byte holds the flags of
+	 * the representation in the bits above the prefix.
+	 */
+	inline void hpack_encode_integer(std::string& out, std::uint8_t flags, int prefix, std::uint64_t value)
+	{
+		std::uint64_t max_prefix = (std::uint64_t(1) << prefix) - 1;
+
+		if (value < max_prefix)
+		{
+			out.push_back(static_cast<char>(flags | value));
+			return;
+		}
+
+		out.push_back(static_cast<char>(flags | max_prefix));
+
+		value -= max_prefix;
+
+		while (value >= 128)
+		{
+			out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+			value >>= 7;
+		}
+
+		out.push_back(static_cast<char>(value));
+	}
+
+	/**
+	 * @brief Decode the integer with a N-bit prefix, returns false if the input is truncated
+	 * or the value is too large.
+	 */
+	inline bool hpack_decode_integer(std::string_view& in, int prefix, std::uint64_t& value)
+	{
+		if (in.empty())
+			return false;
+
+		std::uint64_t max_prefix = (std::uint64_t(1) << prefix) - 1;
+
+		value = static_cast<std::uint8_t>(in.front()) & max_prefix;
+		in.remove_prefix(1);
+
+		if (value < max_prefix)
+			return true;
+
+		for (int shift = 0; ; shift += 7)
+		{
+			// the values of the header fields and the indexes are less than 2^32.
+			if (in.empty() || shift > 28)
+				return false;
+
+			std::uint8_t b = static_cast<std::uint8_t>(in.front());
+			in.remove_prefix(1);
+
+			value += std::uint64_t(b & 0x7f) << shift;
+
+			if (!(b & 0x80))
+				return value <= 0xffffffff;
+		}
+	}
+
+	inline bool hpack_decode_string(std::string_view& in, std::string& out)
+	{
+		if (in.empty())
+			return false;
+
+		bool huffman = (static_cast<std::uint8_t>(in.front()) & 0x80) != 0;
+
+		std::uint64_t len = 0;
+		if (!detail::hpack_decode_integer(in, 7, len) || len > in.size())
+			return false;
+
+		std::string_view s = in.substr(0, static_cast<std::size_t>(len));
+		in.remove_prefix(static_cast<std::size_t>(len));
+
+		out.clear();
+
+		if (!huffman)
+		{
+			out.assign(s);
+			return true;
+		}
+
+		return detail::hpack_huffman_decode(s, out);
+	}
+
+	inline void hpack_encode_string(std::string& out, std::string_view s)
+	{
+		if (std::size_t n = detail::hpack_huffman_size(s); n < s.size())
+		{
+			detail::hpack_encode_integer(out, 0x80, 7, n);
+			detail::hpack_huffman_encode(s, out);
+		}
+		else
+		{
+			detail::hpack_encode_integer(out, 0x00, 7, s.size());
+			out.append(s);
+		}
+	}
+}
+
+#ifdef ASIO3_HEADER_ONLY
+namespace bho::beast::http
+#else
+namespace boost::beast::http
+#endif
+{
+	/**
+	 * @brief The indexing table of HPACK, the static table followed by the dynamic table,
+	 * see RFC 7541 section 2.3.
+	 */
+	class hpack_table
+	{
+	public:
+		// The size of an entry is the sum of the name, the value and 32.
+		static constexpr std::size_t entry_overhead = 32;
+
+		explicit hpack_table(std::size_t max_size = 4096) : max_size_(max_size)
+		{
+		}
+
+		/**
+		 * @brief Get the entry of the index, the index of the first entry is 1.
+		 * Returns nullptr if the index is out of range.
+		 */
+		inline const std::pair<std::string_view, std::string_view>* get(std::uint64_t index) noexcept
+		{
+			if (index == 0)
+				return nullptr;
+
+			if (index <= std::size(detail::hpack_static_table))
+				return &detail::hpack_static_table[index - 1];
+
+			index -= std::size(detail::hpack_static_table) + 1;
+
+			if (index >= this->entries_.size())
+				return nullptr;
+
+			return &this->views_[static_cast<std::size_t>(index)];
+		}
+
+		/**
+		 * @brief Find the entry of the field.
+		 * @return The index of the entry and whether the value matches too, or zero.
+		 */
+		inline std::pair<std::size_t, bool> find(std::string_view name, std::string_view value) const noexcept
+		{
+			std::size_t name_index = 0;
+
+			for (std::size_t i = 0; i < std::size(detail::hpack_static_table); ++i)
+			{
+				const auto& [n, v] = detail::hpack_static_table[i];
+
+				if (n == name)
+				{
+					if (v == value)
+						return { i + 1, true };
+
+					if (name_index == 0)
+						name_index = i + 1;
+				}
+			}
+
+			for (std::size_t i = 0; i < this->views_.size(); ++i)
+			{
+				const auto& [n, v] = this->views_[i];
+
+				if (n == name)
+				{
+					if (v == value)
+						return { std::size(detail::hpack_static_table) + 1 + i, true };
+
+					if (name_index == 0)
+						name_index = std::size(detail::hpack_static_table) + 1 + i;
+				}
+			}
+
+			return { name_index, false };
+		}
+
+		/**
+		 * @brief Insert the entry at the front of the dynamic table, the oldest entries are
+		 * evicted to make room for it.
+		 */
+		inline void insert(std::string name, std::string value)
+		{
+			std::size_t n = name.size() + value.size() + entry_overhead;
+
+			// an entry larger than the table empties the table, it's not an error.
+			if (n > this->max_size_)
+			{
+				this->clear();
+				return;
+			}
+
+			this->evict(this->max_size_ - n);
+
+			this->entries_.emplace_front(std::move(name), std::move(value));
+			this->views_.emplace_front(this->entries_.front().first, this->entries_.front().second);
+
+			this->size_ += n;
+		}
+
+		/**
+		 * @brief Change the max size of the dynamic table, the oldest entries are evicted
+		 * if the table is larger than it.
+		 */
+		inline void resize(std::size_t max_size)
+		{
+			this->max_size_ = max_size;
+			this->evict(max_size);
+		}
+
+		inline void clear() noexcept
+		{
+			this->entries_.clear();
+			this->views_.clear();
+			this->size_ = 0;
+		}
+
+		inline std::size_t size() const noexcept
+		{
+			return this->size_;
+		}
+
+		inline std::size_t max_size() const noexcept
+		{
+			return this->max_size_;
+		}
+
+	protected:
+		inline void evict(std::size_t limit)
+		{
+			while (this->size_ > limit && !this->entries_.empty())
+			{
+				const auto& [name, value] = this->entries_.back();
+
+				this->size_ -= name.size() + value.size() + entry_overhead;
+
+				this->views_.pop_back();
+				this->entries_.pop_back();
+			}
+		}
+
+	protected:
+		// The newest entry is at the front, the strings of a deque are never moved when the
+		// entries are inserted or removed at the ends, so the views keep valid.
+		std::deque<std::pair<std::string, std::string>>           entries_;
+
+		std::deque<std::pair<std::string_view, std::string_view>> views_;
+
+		std::size_t                                               size_ = 0;
+
+		std::size_t                                               max_size_ = 4096;
+	};
+
+	/**
+	 * @brief The decoder of the header blocks, it holds the dynamic table of the blocks
+	 * which are received on one connection.
+	 */
+	class hpack_decoder
+	{
+	public:
+		/**
+		 * @brief constructor
+		 * @param max_table_size - The SETTINGS_HEADER_TABLE_SIZE which was sent to the peer,
+		 * the peer can't enlarge the dynamic table beyond it.
+		 */
+		explicit hpack_decoder(std::size_t max_table_size = 4096)
+			: table_(max_table_size), max_table_size_(max_table_size)
+		{
+		}
+
+		/**
+		 * @brief Decode the complete header block, the function is called with each field.
+		 * @param f - The function: void(std::string_view name, std::string_view value)
+		 * @return False if the block is invalid, it's a connection error of the type
+		 *         COMPRESSION_ERROR since the dynamic table can't be kept in sync anymore.
+		 */
+		template<class Function>
+		bool decode(std::string_view block, Function&& f)
+		{
+			bool field_seen = false;
+
+			while (!block.empty())
+			{
+				std::uint8_t b = static_cast<std::uint8_t>(block.front());
+
+				// indexed header field
+				if (b & 0x80)
+				{
+					std::uint64_t index = 0;
+					if (!detail::hpack_decode_integer(block, 7, index))
+						return false;
+
+					auto* e = this->table_.get(index);
+					if (!e)
+						return false;
+
+					f(e->first, e->second);
+
+					field_seen = true;
+				}
+				// dynamic table size update, it must be at the beginning of the block.
+				else if ((b & 0xe0) == 0x20)
+				{
+					std::uint64_t size = 0;
+					if (field_seen || !detail::hpack_decode_integer(block, 5, size) || size > this->max_table_size_)
+						return false;
+
+					this->table_.resize(static_cast<std::size_t>(size));
+				}
+				// literal header field with incremental indexing, without indexing, never indexed.
+				else
+				{
+					bool indexing = (b & 0xc0) == 0x40;
+
+					std::uint64_t index = 0;
+					if (!detail::hpack_decode_integer(block, indexing ? 6 : 4, index))
+						return false;
+
+					if (index == 0)
+					{
+						if (!detail::hpack_decode_string(block, this->name_))
+							return false;
+					}
+					else
+					{
+						auto* e = this->table_.get(index);
+						if (!e)
+							return false;
+
+						this->name_.assign(e->first);
+					}
+
+					if (!detail::hpack_decode_string(block, this->value_))
+						return false;
+
+					f(std::string_view(this->name_), std::string_view(this->value_));
+
+					if (indexing)
+						this->table_.insert(this->name_, this->value_);
+
+					field_seen = true;
+				}
+			}
+
+			return true;
+		}
+
+		inline hpack_table& table() noexcept
+		{
+			return this->table_;
+		}
+
+	protected:
+		hpack_table  table_;
+
+		std::size_t  max_table_size_ = 4096;
+
+		// The buffers of the literal name and value, they're reused by the fields.
+		std::string  name_;
+
+		std::string  value_;
+	};
+
+	/**
+	 * @brief The encoder of the header blocks, it holds the dynamic table of the blocks
+	 * which are sent on one connection.
+	 */
+	class hpack_encoder
+	{
+	public:
+		explicit hpack_encoder(std::size_t max_table_size = 4096) : table_(max_table_size)
+		{
+		}
+
+		/**
+		 * @brief Apply the SETTINGS_HEADER_TABLE_SIZE of the peer, the size update is sent
+		 * at the beginning of the next block.
+		 * The table is limited to 4096 bytes even if the peer allows more.
+		 */
+		inline void max_table_size(std::size_t size)
+		{
+			size = (std::min)(size, std::size_t(4096));
+
+			if (size != this->table_.max_size())
+			{
+				this->table_.resize(size);
+				this->size_update_ = true;
+			}
+		}
+
+		/**
+		 * @brief Append the field to the header block.
+		 * The name must be lower case. The fields which change with every message (eg: the
+		 * content-length and the date) and the sensitive ones are not inserted into the
+		 * dynamic table, so they don't evict the entries which are reused.
+		 */
+		inline void encode(std::string& out, std::string_view name, std::string_view value)
+		{
+			if (this->size_update_)
+			{
+				this->size_update_ = false;
+				detail::hpack_encode_integer(out, 0x20, 5, this->table_.max_size());
+			}
+
+			auto [index, exact] = this->table_.find(name, value);
+
+			if (exact)
+			{
+				detail::hpack_encode_integer(out, 0x80, 7, index);
+				return;
+			}
+
+			bool sensitive =
+				name == "authorization" || name == "proxy-authorization" ||
+				name == "cookie" || name == "set-cookie";
+
+			bool volatile_field =
+				name == "content-length" || name == "date" || name == "etag" ||
+				name == "last-modified" || name == "content-range" || name == "expires" ||
+				name == ":path" || name == "location";
+
+			bool indexing = !sensitive && !volatile_field &&
+				name.size() + value.size() + hpack_table::entry_overhead <= this->table_.max_size() / 2;
+
+			// with incremental indexing: 01xxxxxx, without indexing: 0000xxxx, never indexed: 0001xxxx
+			if (indexing)
+				detail::hpack_encode_integer(out, 0x40, 6, index);
+			else
+				detail::hpack_encode_integer(out, sensitive ? 0x10 : 0x00, 4, index);
+
+			if (index == 0)
+				detail::hpack_encode_string(out, name);
+
+			detail::hpack_encode_string(out, value);
+
+			if (indexing)
+				this->table_.insert(std::string(name), std::string(value));
+		}
+
+		inline hpack_table& table() noexcept
+		{
+			return this->table_;
+		}
+
+	protected:
+		hpack_table  table_;
+
+		bool         size_update_ = false;
+	};
+}
@@ -0,0 +1,1692 @@
+/*
+ * Copyright (c) 2017-2023 zhllxt
+ *
+ * author   : zhllxt
+ * email    : 37792738@qq.com
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include <asio3/core/asio.hpp>
+#include <asio3/core/beast.hpp>
+#include <asio3/core/deadline.hpp>
+#include <asio3/http/core.hpp>
+#include <asio3/http/arena.hpp>
+#include <asio3/http/hpack.hpp>
+#include <asio3/http/make.hpp>
+#include <asio3/http/serve.hpp>
+
+#ifdef ASIO3_HEADER_ONLY
+namespace bho::beast::http
+#else
+namespace boost::beast::http
+#endif
+{
+	/**
+	 * @brief The error codes of HTTP/2 which are carried by the RST_STREAM and GOAWAY frames,
+	 * see RFC 9113 section 7.
+	 */
+	enum class http2_error : std::uint32_t
+	{
+		no_error            = 0x0,
+		protocol_error      = 0x1,
+		internal_error      = 0x2,
+		flow_control_error  = 0x3,
+		settings_timeout    = 0x4,
+		stream_closed       = 0x5,
+		frame_size_error    = 0x6,
+		refused_stream      = 0x7,
+		cancel              = 0x8,
+		compression_error   = 0x9,
+		connect_error       = 0xa,
+		enhance_your_calm   = 0xb,
+		inadequate_security = 0xc,
+		http_1_1_required   = 0xd,
+	};
+
+	class http2_error_category : public asio::error_category
+	{
+	public:
+		const char* name() const noexcept override
+		{
+			return "asio.http2";
+		}
+
+		inline std::string message(int ev) const override
+		{
+			switch (static_cast<http2_error>(ev))
+			{
+			case http2_error::no_error            : return "Graceful shutdown.";
+			case http2_error::protocol_error      : return "Protocol error detected.";
+			case http2_error::internal_error      : return "Implementation fault.";
+			case http2_error::flow_control_error  : return "Flow-control limits exceeded.";
+			case http2_error::settings_timeout    : return "Settings not acknowledged.";
+			case http2_error::stream_closed       : return "Frame received for closed stream.";
+			case http2_error::frame_size_error    : return "Frame size incorrect.";
+			case http2_error::refused_stream      : return "Stream not processed.";
+			case http2_error::cancel              : return "Stream cancelled.";
+			case http2_error::compression_error   : return "Compression state not updated.";
+			case http2_error::connect_error       : return "TCP connection error for CONNECT method.";
+			case http2_error::enhance_your_calm   : return "Processing capacity exceeded.";
+			case http2_error::inadequate_security : return "Negotiated TLS parameters not acceptable.";
+			case http2_error::http_1_1_required   : return "Use HTTP/1.1 for the request.";
+			default                               : return "Unknown error";
+			}
+		}
+	};
+
+	inline const http2_error_category& http2_category() noexcept
+	{
+		static http2_error_category const cat{};
+		return cat;
+	}
+
+	inline asio::error_code make_error_code(http2_error e)
+	{
+		return asio::error_code{ static_cast<int>(e), http2_category() };
+	}
+
+	enum class http2_frame_type : std::uint8_t
+	{
+		data          = 0x0,
+		headers       = 0x1,
+		priority      = 0x2,
+		rst_stream    = 0x3,
+		settings      = 0x4,
+		push_promise  = 0x5,
+		ping          = 0x6,
+		goaway        = 0x7,
+		window_update = 0x8,
+		continuation  = 0x9,
+	};
+
+	namespace http2_flags
+	{
+		inline constexpr std::uint8_t end_stream  = 0x01;
+		inline constexpr std::uint8_t ack         = 0x01;
+		inline constexpr std::uint8_t end_headers = 0x04;
+		inline constexpr std::uint8_t padded      = 0x08;
+		inline constexpr std::uint8_t priority    = 0x20;
+	}
+
+	enum class http2_settings_id : std::uint16_t
+	{
+		header_table_size      = 0x1,
+		enable_push            = 0x2,
+		max_concurrent_streams = 0x3,
+		initial_window_size    = 0x4,
+		max_frame_size         = 0x5,
+		max_header_list_size   = 0x6,
+	};
+
+	// The client connection preface, which is followed by a SETTINGS frame.
+	inline constexpr std::string_view http2_preface = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+
+	// The window size and the max frame size which are used before the SETTINGS are exchanged.
+	inline constexpr std::uint32_t http2_default_window_size = 65535;
+	inline constexpr std::uint32_t http2_default_frame_size = 16384;
+	inline constexpr std::uint32_t http2_max_window_size = 0x7fffffff;
+
+	struct http2_frame_header
+	{
+		std::uint32_t    length    = 0;
+		http2_frame_type type      = http2_frame_type::data;
+		std::uint8_t     flags     = 0;
+		std::uint32_t    stream_id = 0;
+
+		static constexpr std::size_t size = 9;
+
+		/**
+		 * @brief Parse the frame header from the first 9 bytes of the data.
+		 */
+		static inline http2_frame_header parse(std::string_view data) noexcept
+		{
+			auto u8 = [data](std::size_t i) { return static_cast<std::uint32_t>(static_cast<std::uint8_t>(data[i])); };
+
+			http2_frame_header h;
+			h.length    = (u8(0) << 16) | (u8(1) << 8) | u8(2);
+			h.type      = static_cast<http2_frame_type>(u8(3));
+			h.flags     = static_cast<std::uint8_t>(u8(4));
+			h.stream_id = ((u8(5) << 24) | (u8(6) << 16) | (u8(7) << 8) | u8(8)) & 0x7fffffff;
+			return h;
+		}
+
+		/**
+		 * @brief Append the frame header to the string.
+		 */
+		inline void serialize(std::string& out) const
+		{
+			char buf[size] = {
+				static_cast<char>(length >> 16), static_cast<char>(length >> 8), static_cast<char>(length),
+				static_cast<char>(type), static_cast<char>(flags),
+				static_cast<char>((stream_id >> 24) & 0x7f), static_cast<char>(stream_id >> 16),
+				static_cast<char>(stream_id >> 8), static_cast<char>(stream_id) };
+			out.append(buf, size);
+		}
+	};
+}
+
+#ifdef ASIO3_HEADER_ONLY
+namespace bho::beast::http::detail
+#else
+namespace boost::beast::http::detail
+#endif
+{
+	inline std::uint32_t http2_load_u32(std::string_view data) noexcept
+	{
+		return
+			(static_cast<std::uint32_t>(static_cast<std::uint8_t>(data[0])) << 24) |
+			(static_cast<std::uint32_t>(static_cast<std::uint8_t>(data[1])) << 16) |
+			(static_cast<std::uint32_t>(static_cast<std::uint8_t>(data[2])) <<  8) |
+			(static_cast<std::uint32_t>(static_cast<std::uint8_t>(data[3])));
+	}
+
+	inline void http2_store_u32(std::string& out, std::uint32_t v)
+	{
+		char buf[4] = {
+			static_cast<char>(v >> 24), static_cast<char>(v >> 16),
+			static_cast<char>(v >> 8), static_cast<char>(v) };
+		out.append(buf, 4);
+	}
+
+	/**
+	 * @brief Remove the pad length and the padding of the PADDED frame.
+	 * @return False if the padding is longer than the payload.
+	 */
+	inline bool http2_strip_padding(std::uint8_t flags, std::string_view& payload) noexcept
+	{
+		if (!(flags & http2_flags::padded))
+			return true;
+
+		if (payload.empty())
+			return false;
+
+		std::size_t pad = static_cast<std::uint8_t>(payload.front());
+		payload.remove_prefix(1);
+
+		if (pad > payload.size())
+			return false;
+
+		payload.remove_suffix(pad);
+		return true;
+	}
+
+	/**
+	 * @brief The connection-specific fields which must not be used in HTTP/2, RFC 9113 section 8.2.2.
+	 */
+	inline bool is_http2_connection_field(std::string_view name) noexcept
+	{
+		return
+			beast::iequals(name, "connection") ||
+			beast::iequals(name, "keep-alive") ||
+			beast::iequals(name, "proxy-connection") ||
+			beast::iequals(name, "transfer-encoding") ||
+			beast::iequals(name, "upgrade");
+	}
+}
+
+#ifdef ASIO_STANDALONE
+namespace asio::detail
+#else
+namespace boost::asio::detail
+#endif
+{
+	/**
+	 * @brief Check whether the cleartext connection starts with the preface of HTTP/2. The first
+	 * bytes are read into the buffer, which must be passed to the http_async_serve or the
+	 * http2_async_serve then. The first bytes must arrive within the idle_timeout, and the rest
+	 * of the preface within the header_timeout, the reading stops at once when the data isn't
+	 * a prefix of the preface.
+	 * @return The error and whether the preface is received.
+	 */
+	template<class SocketT>
+	asio::awaitable<std::tuple<asio::error_code, bool>> http2_async_detect(
+		SocketT& sock, beast::flat_buffer& buffer, const http_serve_option& opt)
+	{
+		constexpr std::string_view preface = http::http2_preface;
+
+		asio::connection_deadline deadline(co_await asio::this_coro::executor);
+
+		// the rest of the preface must arrive within the header_timeout since the first bytes,
+		// the time isn't restarted by each of the reads.
+		auto timeout = opt.idle_timeout;
+		auto expiry = std::chrono::steady_clock::time_point::max();
+
+		for (;;)
+		{
+			if (expiry != std::chrono::steady_clock::time_point::max())
+			{
+				timeout = expiry - std::chrono::steady_clock::now();
+				if (timeout <= std::chrono::steady_clock::duration::zero())
+					co_return std::tuple{ asio::error::timed_out, false };
+			}
+
+			deadline.expires_after(timeout);
+
+			auto [ec, n] = co_await sock.async_read_some(buffer.prepare(preface.size() - buffer.size()),
+				deadline.bind(asio::use_nothrow_awaitable));
+
+			deadline.expires_never();
+
+			if (deadline.expired())
+				co_return std::tuple{ asio::error::timed_out, false };
+
+			if (ec)
+				co_return std::tuple{ ec, false };
+
+			buffer.commit(n);
+
+			std::string_view data(static_cast<const char*>(buffer.data().data()), buffer.size());
+
+			if (data != preface.substr(0, data.size()))
+				co_return std::tuple{ asio::error_code{}, false };
+
+			if (data.size() == preface.size())
+				co_return std::tuple{ asio::error_code{}, true };
+
+			if (expiry == std::chrono::steady_clock::time_point::max())
+				expiry = std::chrono::steady_clock::now() + opt.header_timeout;
+		}
+	}
+
+	/**
+	 * @brief The server side of a HTTP/2 connection.
+	 * The frames are read by one coroutine and written by another one, each request is
+	 * routed in its own coroutine once its stream is half closed by the client, and the
+	 * responses are multiplexed on the connection within the flow control windows.
+	 * All of the coroutines run on the executor of the connection.
+	 */
+	template<class SessionT, class StreamT, class RouterT>
+	class http2_connection
+	{
+	public:
+		using request_type = typename SessionT::request_type;
+		using response_type = typename SessionT::response_type;
+		using time_point = std::chrono::steady_clock::time_point;
+
+		explicit http2_connection(SessionT& session, StreamT& stream, RouterT& router,
+			const http_serve_option& opt, const asio::any_io_executor& ex, beast::flat_buffer buffer = {})
+			: session_(session)
+			, stream_(stream)
+			, router_(router)
+			, opt_(opt)
+			, signal_(ex)
+			, read_deadline_(ex)
+			, write_deadline_(ex)
+			, buffer_(std::move(buffer))
+		{
+			this->signal_.expires_at(asio::steady_timer::time_point::max());
+
+			this->local_window_ = (std::clamp)(opt.http2_initial_window_size,
+				http::http2_default_window_size, http::http2_max_window_size);
+			this->conn_recv_window_ = this->local_window_;
+		}
+
+		asio::awaitable<asio::error_code> run()
+		{
+			this->write_preface();
+
+			co_await(this->read_loop() && this->write_loop());
+
+			co_return this->ec_;
+		}
+
+	protected:
+		struct stream_state
+		{
+			std::uint32_t                id = 0;
+
+			std::optional<request_type>  req;
+
+			http::request_arena*         arena = nullptr;
+
+			std::uint64_t                body_size = 0;
+
+			std::optional<std::uint64_t> content_length;
+
+			// the window of the response and the window of the request body.
+			std::int64_t                 send_window = 0;
+			std::int64_t                 recv_window = 0;
+
+			// the status of the error response which is sent without routing the request.
+			http::status                 status = http::status::unknown;
+
+			// the event stream which is being sent as the response.
+			std::shared_ptr<http::sse_stream> events;
+
+			// cancel the handler of the stream when the stream is reset.
+			asio::cancellation_signal    cancel;
+
+			bool                         remote_closed = false;
+			bool                         local_closed = false;
+			bool                         dispatched = false;
+			bool                         reset = false;
+		};
+
+		using stream_ptr = std::shared_ptr<stream_state>;
+
+		// The output is not enlarged beyond this size until it's written, so the responses
+		// don't buffer more than that when the window of the client is large.
+		static constexpr std::size_t max_pending_output = 256 * 1024;
+
+		inline void notify()
+		{
+			this->signal_.cancel();
+		}
+
+		inline auto wait()
+		{
+			return this->signal_.async_wait(asio::use_nothrow_awaitable);
+		}
+
+		inline void write_frame_header(std::size_t length, http::http2_frame_type type,
+			std::uint8_t flags, std::uint32_t stream_id)
+		{
+			http::http2_frame_header{ static_cast<std::uint32_t>(length), type, flags, stream_id }.serialize(this->out_);
+		}
+
+		inline void write_preface()
+		{
+			auto setting = [this](http::http2_settings_id id, std::uint32_t value)
+			{
+				this->out_.push_back(static_cast<char>(static_cast<std::uint16_t>(id) >> 8));
+				this->out_.push_back(static_cast<char>(static_cast<std::uint16_t>(id)));
+				http::detail::http2_store_u32(this->out_, value);
+			};
+
+			this->write_frame_header(6 * 4, http::http2_frame_type::settings, 0, 0);
+			setting(http::http2_settings_id::enable_push, 0);
+			setting(http::http2_settings_id::max_concurrent_streams, this->opt_.http2_max_concurrent_streams);
+			setting(http::http2_settings_id::initial_window_size, this->local_window_);
+			setting(http::http2_settings_id::max_header_list_size, this->opt_.header_limit);
+
+			// the window of the connection can only be enlarged by WINDOW_UPDATE.
+			if (this->local_window_ > http::http2_default_window_size)
+				this->write_window_update(0, this->local_window_ - http::http2_default_window_size);
+
+			this->notify();
+		}
+
+		inline void write_window_update(std::uint32_t stream_id, std::uint32_t increment)
+		{
+			this->write_frame_header(4, http::http2_frame_type::window_update, 0, stream_id);
+			http::detail::http2_store_u32(this->out_, increment);
+			this->notify();
+		}
+
+		inline void write_rst_stream(std::uint32_t stream_id, http::http2_error e)
+		{
+			this->write_frame_header(4, http::http2_frame_type::rst_stream, 0, stream_id);
+			http::detail::http2_store_u32(this->out_, static_cast<std::uint32_t>(e));
+			this->notify();
+		}
+
+		inline void write_goaway(http::http2_error e)
+		{
+			if (this->goaway_sent_)
+				return;
+
+			this->goaway_sent_ = true;
+
+			this->write_frame_header(8, http::http2_frame_type::goaway, 0, 0);
+			http::detail::http2_store_u32(this->out_, this->last_stream_id_);
+			http::detail::http2_store_u32(this->out_, static_cast<std::uint32_t>(e));
+			this->notify();
+		}
+
+		/**
+		 * @brief Append the header block in a HEADERS frame and the CONTINUATION frames, they
+		 * are appended at once so no other frame is interleaved.
+		 */
+		inline void write_headers(std::uint32_t stream_id, std::string_view block, bool end_stream)
+		{
+			std::uint8_t flags = end_stream ? http::http2_flags::end_stream : 0;
+
+			http::http2_frame_type type = http::http2_frame_type::headers;
+
+			do
+			{
+				std::size_t n = (std::min)(block.size(), static_cast<std::size_t>(this->peer_max_frame_size_));
+
+				if (n == block.size())
+					flags |= http::http2_flags::end_headers;
+
+				this->write_frame_header(n, type, flags, stream_id);
+				this->out_.append(block.substr(0, n));
+
+				block.remove_prefix(n);
+
+				type = http::http2_frame_type::continuation;
+				flags = 0;
+			} while (!block.empty());
+
+			this->notify();
+		}
+
+		/**
+		 * @brief Stop the connection with the error, the GOAWAY frame is sent and the responses
+		 * which are not sent yet are dropped.
+		 */
+		inline void connection_error(http::http2_error e)
+		{
+			this->write_goaway(e);
+
+			if (!this->ec_)
+				this->ec_ = http::make_error_code(e);
+
+			this->aborted_ = true;
+		}
+
+		inline void reset_stream(stream_state& s, http::http2_error e)
+		{
+			this->write_rst_stream(s.id, e);
+			this->close_stream(s);
+		}
+
+		inline void close_stream(stream_state& s)
+		{
+			s.reset = !s.local_closed;
+			s.remote_closed = true;
+			s.local_closed = true;
+
+			this->streams_.erase(s.id);
+
+			// the handler of the stream may be waiting for the window or the events.
+			if (s.events)
+				s.events->close();
+
+			// the handler which is still running is counted until it finishes, so the peer
+			// can't run more handlers than the limit by resetting the streams.
+			if (s.reset && s.cancel.slot().has_handler())
+			{
+				++this->reset_handlers_;
+
+				s.cancel.emit(asio::cancellation_type::terminal);
+			}
+
+			this->notify();
+		}
+
+		/**
+		 * @brief Arm the read deadline by what the connection is waiting for:
+		 * - the request bodies of the open streams: the body_timeout for each read, and the
+		 *   min_body_rate of the received bytes since the first stream was opened;
+		 * - the rest of a frame or a header block: the header_timeout since it was started;
+		 * - the responses of the requests which are being handled: no deadline;
+		 * - nothing: the idle_timeout.
+		 */
+		inline void arm_read_deadline()
+		{
+			auto now = std::chrono::steady_clock::now();
+
+			bool receiving = std::ranges::any_of(this->streams_, [](const auto& pair)
+			{
+				return !pair.second->remote_closed && !pair.second->reset;
+			});
+
+			if (receiving != this->receiving_)
+			{
+				this->receiving_ = receiving;
+
+				if (receiving)
+					this->read_deadline_.min_rate(this->opt_.min_body_rate, this->opt_.min_body_rate_grace);
+				else
+					this->read_deadline_.min_rate(0);
+			}
+
+			bool partial = this->buffer_.size() > 0 || this->continuation_id_ != 0;
+
+			if (!partial)
+				this->partial_since_ = {};
+			else if (this->partial_since_ == time_point{})
+				this->partial_since_ = now;
+
+			if (receiving)
+			{
+				this->read_deadline_.expires_after(this->opt_.body_timeout);
+			}
+			else if (partial)
+			{
+				auto remain = this->partial_since_ + this->opt_.header_timeout - now;
+
+				this->read_deadline_.expires_after((std::max)(remain, decltype(remain)(1)));
+			}
+			else if (this->handlers_ == 0 && this->streams_.empty())
+			{
+				this->read_deadline_.expires_after(this->opt_.idle_timeout);
+			}
+		}
+
+		/**
+		 * @brief Read until the buffer has n bytes at least.
+		 * The connection is closed if the client doesn't send what it owes in time, see the
+		 * arm_read_deadline, but not while only the requests are being handled.
+		 */
+		asio::awaitable<bool> read_at_least(std::size_t n)
+		{
+			while (this->buffer_.size() < n)
+			{
+				this->arm_read_deadline();
+
+				auto [e1, n1] = co_await this->stream_.async_read_some(
+					this->buffer_.prepare((std::max)(n - this->buffer_.size(), std::size_t(16 * 1024))),
+					this->read_deadline_.bind(asio::use_nothrow_awaitable));
+
+				this->read_deadline_.expires_never();
+
+				if (this->read_deadline_.expired())
+				{
+					if (!this->ec_)
+						this->ec_ = asio::error::timed_out;
+
+					co_return false;
+				}
+
+				if (e1)
+				{
+					if (!this->ec_ && e1 != asio::error::eof && e1 != asio::error::operation_aborted)
+						this->ec_ = e1;
+
+					this->aborted_ = true;
+					co_return false;
+				}
+
+				this->buffer_.commit(n1);
+
+				// the bytes of the frames are counted by the min rate while the request bodies
+				// are being received.
+				this->read_deadline_.consume(n1);
+
+				this->session_.update_alive_time();
+			}
+
+			co_return true;
+		}
+
+		asio::awaitable<void> read_loop()
+		{
+			constexpr std::size_t hsize = http::http2_frame_header::size;
+
+			if (co_await this->read_at_least(http::http2_preface.size()))
+			{
+				std::string_view data(static_cast<const char*>(this->buffer_.data().data()), this->buffer_.size());
+
+				if (data.substr(0, http::http2_preface.size()) != http::http2_preface)
+					this->connection_error(http::http2_error::protocol_error);
+
+				this->buffer_.consume(http::http2_preface.size());
+
+				while (!this->aborted_ && co_await this->read_at_least(hsize))
+				{
+					data = std::string_view(static_cast<const char*>(this->buffer_.data().data()), this->buffer_.size());
+
+					auto h = http::http2_frame_header::parse(data);
+
+					if (h.length > http::http2_default_frame_size)
+					{
+						this->connection_error(http::http2_error::frame_size_error);
+						break;
+					}
+
+					if (!co_await this->read_at_least(hsize + h.length))
+						break;
+
+					data = std::string_view(static_cast<const char*>(this->buffer_.data().data()), this->buffer_.size());
+
+					http::http2_error e = this->on_frame(h, data.substr(hsize, h.length));
+
+					this->buffer_.consume(hsize + h.length);
+
+					if (e != http::http2_error::no_error)
+					{
+						this->connection_error(e);
+						break;
+					}
+				}
+			}
+
+			// the reader stops when the connection is idle, or the client has closed it, or
+			// an error of the connection has been sent.
+			if (!this->aborted_)
+				this->write_goaway(http::http2_error::no_error);
+
+			// the event streams never end by themselves.
+			for (auto& [id, s] : this->streams_)
+			{
+				if (s->events)
+					s->events->close();
+			}
+
+			this->notify();
+
+			while (this->handlers_ > 0)
+				co_await this->wait();
+
+			this->finished_ = true;
+			this->notify();
+		}
+
+		asio::awaitable<void> write_loop()
+		{
+			for (;;)
+			{
+				if (this->out_.empty())
+				{
+					if (this->finished_)
+						break;
+
+					co_await this->wait();
+					continue;
+				}
+
+				std::swap(this->out_, this->writing_);
+
+				this->write_deadline_.expires_after(this->opt_.write_timeout);
+
+				auto [ec, n] = co_await asio::async_write(this->stream_, asio::buffer(this->writing_),
+					this->write_deadline_.bind(asio::use_nothrow_awaitable));
+
+				this->write_deadline_.expires_never();
+
+				this->writing_.clear();
+
+				if (this->write_deadline_.expired())
+					ec = asio::error::timed_out;
+
+				if (ec)
+				{
+					if (!this->ec_ && !this->aborted_)
+						this->ec_ = ec;
+
+					this->aborted_ = true;
+					this->out_.clear();
+
+					// stop the reader, it may be waiting for the socket.
+					asio::error_code e2{};
+					beast::get_lowest_layer(this->stream_).cancel(e2);
+
+					this->notify();
+					break;
+				}
+
+				this->session_.update_alive_time();
+
+				// the handlers may be waiting for the output to be drained.
+				this->notify();
+			}
+		}
+
+		http::http2_error on_frame(const http::http2_frame_header& h, std::string_view payload)
+		{
+			using type = http::http2_frame_type;
+
+			// the header block must be contiguous, and the first frame must be the SETTINGS.
+			if (this->continuation_id_ != 0 && h.type != type::continuation)
+				return http::http2_error::protocol_error;
+
+			if (!this->settings_received_ && h.type != type::settings)
+				return http::http2_error::protocol_error;
+
+			switch (h.type)
+			{
+			case type::data          : return this->on_data(h, payload);
+			case type::headers       : return this->on_headers(h, payload);
+			case type::priority      : return this->on_priority(h, payload);
+			case type::rst_stream    : return this->on_rst_stream(h, payload);
+			case type::settings      : return this->on_settings(h, payload);
+			case type::push_promise  : return http::http2_error::protocol_error;
+			case type::ping          : return this->on_ping(h, payload);
+			case type::goaway        : return this->on_goaway(h, payload);
+			case type::window_update : return this->on_window_update(h, payload);
+			case type::continuation  : return this->on_continuation(h, payload);
+			// the frames of unknown types are ignored.
+			default                  : return http::http2_error::no_error;
+			}
+		}
+
+		http::http2_error on_settings(const http::http2_frame_header& h, std::string_view payload)
+		{
+			if (h.stream_id != 0)
+				return http::http2_error::protocol_error;
+
+			if (h.flags & http::http2_flags::ack)
+				return payload.empty() ? http::http2_error::no_error : http::http2_error::frame_size_error;
+
+			if (payload.size() % 6 != 0)
+				return http::http2_error::frame_size_error;
+
+			for (; !payload.empty(); payload.remove_prefix(6))
+			{
+				auto id = static_cast<http::http2_settings_id>(
+					(static_cast<std::uint8_t>(payload[0]) << 8) | static_cast<std::uint8_t>(payload[1]));
+
+				std::uint32_t value = http::detail::http2_load_u32(payload.substr(2));
+
+				switch (id)
+				{
+				case http::http2_settings_id::header_table_size:
+					this->encoder_.max_table_size(value);
+					break;
+				case http::http2_settings_id::enable_push:
+					if (value > 1)
+						return http::http2_error::protocol_error;
+					break;
+				case http::http2_settings_id::initial_window_size:
+				{
+					if (value > http::http2_max_window_size)
+						return http::http2_error::flow_control_error;
+
+					// the windows of the open streams are adjusted by the difference, they may
+					// become negative.
+					std::int64_t delta = std::int64_t(value) - std::int64_t(this->peer_initial_window_);
+
+					for (auto& [sid, sp] : this->streams_)
+					{
+						sp->send_window += delta;
+
+						if (sp->send_window > http::http2_max_window_size)
+							return http::http2_error::flow_control_error;
+					}
+
+					this->peer_initial_window_ = value;
+					break;
+				}
+				case http::http2_settings_id::max_frame_size:
+					if (value < http::http2_default_frame_size || value > 0xffffff)
+						return http::http2_error::protocol_error;
+					this->peer_max_frame_size_ = value;
+					break;
+				default:
+					break;
+				}
+			}
+
+			this->settings_received_ = true;
+
+			this->write_frame_header(0, http::http2_frame_type::settings, http::http2_flags::ack, 0);
+			this->notify();
+
+			return http::http2_error::no_error;
+		}
+
+		http::http2_error on_ping(const http::http2_frame_header& h, std::string_view payload)
+		{
+			if (h.stream_id != 0)
+				return http::http2_error::protocol_error;
+
+			if (payload.size() != 8)
+				return http::http2_error::frame_size_error;
+
+			if (!(h.flags & http::http2_flags::ack))
+			{
+				this->write_frame_header(8, http::http2_frame_type::ping, http::http2_flags::ack, 0);
+				this->out_.append(payload);
+				this->notify();
+			}
+
+			return http::http2_error::no_error;
+		}
+
+		http::http2_error on_goaway(const http::http2_frame_header& h, std::string_view payload)
+		{
+			if (h.stream_id != 0)
+				return http::http2_error::protocol_error;
+
+			if (payload.size() < 8)
+				return http::http2_error::frame_size_error;
+
+			// the client won't open new streams, the open ones are still served and the client
+			// closes the connection after their responses.
+			this->goaway_received_ = true;
+
+			return http::http2_error::no_error;
+		}
+
+		http::http2_error on_priority(const http::http2_frame_header& h, std::string_view payload)
+		{
+			if (h.stream_id == 0)
+				return http::http2_error::protocol_error;
+
+			// the priority is deprecated by RFC 9113, the frame is ignored.
+			if (payload.size() != 5)
+			{
+				if (auto it = this->streams_.find(h.stream_id); it != this->streams_.end())
+					this->reset_stream(*it->second, http::http2_error::frame_size_error);
+				else
+					this->write_rst_stream(h.stream_id, http::http2_error::frame_size_error);
+			}
+
+			return http::http2_error::no_error;
+		}
+
+		http::http2_error on_rst_stream(const http::http2_frame_header& h, std::string_view payload)
+		{
+			if (h.stream_id == 0 || h.stream_id > this->last_stream_id_)
+				return http::http2_error::protocol_error;
+
+			if (payload.size() != 4)
+				return http::http2_error::frame_size_error;
+
+			if (auto it = this->streams_.find(h.stream_id); it != this->streams_.end())
+				this->close_stream(*it->second);
+
+			return http::http2_error::no_error;
+		}
+
+		http::http2_error on_window_update(const http::http2_frame_header& h, std::string_view payload)
+		{
+			if (payload.size() != 4)
+				return http::http2_error::frame_size_error;
+
+			std::uint32_t increment = http::detail::http2_load_u32(payload) & 0x7fffffff;
+
+			if (h.stream_id == 0)
+			{
+				if (increment == 0)
+					return http::http2_error::protocol_error;
+
+				this->conn_send_window_ += increment;
+
+				if (this->conn_send_window_ > http::http2_max_window_size)
+					return http::http2_error::flow_control_error;
+			}
+			else if (auto it = this->streams_.find(h.stream_id); it != this->streams_.end())
+			{
+				stream_state& s = *it->second;
+
+				if (increment == 0)
+				{
+					this->reset_stream(s, http::http2_error::protocol_error);
+				}
+				else if ((s.send_window += increment) > http::http2_max_window_size)
+				{
+					this->reset_stream(s, http::http2_error::flow_control_error);
+				}
+			}
+			else if (h.stream_id > this->last_stream_id_)
+			{
+				return http::http2_error::protocol_error;
+			}
+
+			this->notify();
+
+			return http::http2_error::no_error;
+		}
+
+		http::http2_error on_headers(const http::http2_frame_header& h, std::string_view payload)
+		{
+			if (h.stream_id == 0)
+				return http::http2_error::protocol_error;
+
+			if (!http::detail::http2_strip_padding(h.flags, payload))
+				return http::http2_error::protocol_error;
+
+			if (h.flags & http::http2_flags::priority)
+			{
+				if (payload.size() < 5)
+					return http::http2_error::frame_size_error;
+
+				payload.remove_prefix(5);
+			}
+
+			this->block_.assign(payload);
+			this->block_flags_ = h.flags;
+			this->block_stream_id_ = h.stream_id;
+
+			if (!(h.flags & http::http2_flags::end_headers))
+			{
+				this->continuation_id_ = h.stream_id;
+				return http::http2_error::no_error;
+			}
+
+			return this->on_header_block();
+		}
+
+		http::http2_error on_continuation(const http::http2_frame_header& h, std::string_view payload)
+		{
+			if (this->continuation_id_ == 0 || h.stream_id != this->continuation_id_)
+				return http::http2_error::protocol_error;
+
+			// the encoded block is not larger than the decoded fields usually.
+			if (this->block_.size() + payload.size() > std::size_t(this->opt_.header_limit) + 1024)
+				return http::http2_error::enhance_your_calm;
+
+			this->block_.append(payload);
+
+			if (!(h.flags & http::http2_flags::end_headers))
+				return http::http2_error::no_error;
+
+			this->continuation_id_ = 0;
+
+			return this->on_header_block();
+		}
+
+		http::http2_error on_header_block()
+		{
+			std::uint32_t id = this->block_stream_id_;
+
+			bool end_stream = (this->block_flags_ & http::http2_flags::end_stream) != 0;
+
+			// the trailer fields of an open stream are decoded and ignored.
+			if (auto it = this->streams_.find(id); it != this->streams_.end())
+			{
+				if (!this->decoder_.decode(this->block_, [](std::string_view, std::string_view) {}))
+					return http::http2_error::compression_error;
+
+				stream_state& s = *it->second;
+
+				if (s.remote_closed)
+					this->reset_stream(s, http::http2_error::stream_closed);
+				else if (!end_stream)
+					this->reset_stream(s, http::http2_error::protocol_error);
+				else
+					this->on_remote_end(it->second);
+
+				return http::http2_error::no_error;
+			}
+
+			// the streams are opened by the client with increasing odd identifiers.
+			if ((id & 1) == 0)
+				return http::http2_error::protocol_error;
+
+			if (id <= this->last_stream_id_)
+				return http::http2_error::stream_closed;
+
+			this->last_stream_id_ = id;
+
+			auto s = std::make_shared<stream_state>();
+
+			s->id = id;
+
+			if constexpr (http::is_arena_request_v<request_type>)
+			{
+				s->arena = this->session_.arena_pool.acquire();
+				s->req.emplace(http::make_arena_request(*s->arena));
+			}
+			else
+			{
+				s->req.emplace();
+			}
+
+			request_type& req = *s->req;
+
+			req.version(20);
+
+			std::size_t list_size = 0;
+			bool too_large = false, malformed = false, regular_seen = false;
+			bool has_method = false, has_scheme = false, has_path = false;
+			std::string authority, cookie;
+
+			bool ok = this->decoder_.decode(this->block_, [&](std::string_view name, std::string_view value)
+			{
+				list_size += name.size() + value.size() + http::hpack_table::entry_overhead;
+
+				if (list_size > this->opt_.header_limit)
+					too_large = true;
+
+				if (too_large || malformed)
+					return;
+
+				if (name.empty())
+				{
+					malformed = true;
+					return;
+				}
+
+				if (name.front() == ':')
+				{
+					if (regular_seen)
+					{
+						malformed = true;
+					}
+					else if (name == ":method" && !has_method)
+					{
+						has_method = true;
+						req.method_string(value);
+					}
+					else if (name == ":path" && !has_path && !value.empty())
+					{
+						has_path = true;
+						req.target(value);
+					}
+					else if (name == ":scheme" && !has_scheme)
+					{
+						has_scheme = true;
+					}
+					else if (name == ":authority" && authority.empty())
+					{
+						authority.assign(value);
+					}
+					else
+					{
+						malformed = true;
+					}
+
+					return;
+				}
+
+				regular_seen = true;
+
+				if (std::any_of(name.begin(), name.end(), [](char c) { return c >= 'A' && c <= 'Z'; }) ||
+					http::detail::is_http2_connection_field(name) || (name == "te" && value != "trailers"))
+				{
+					malformed = true;
+					return;
+				}
+
+				// the cookie may be split into multiple fields, they're concatenated for HTTP/1.1.
+				if (name == "cookie")
+				{
+					if (!cookie.empty())
+						cookie += "; ";
+					cookie += value;
+					return;
+				}
+
+				if (name == "content-length")
+				{
+					std::uint64_t n = 0;
+					auto [p, e] = std::from_chars(value.data(), value.data() + value.size(), n);
+					if (e != std::errc{} || p != value.data() + value.size() ||
+						(s->content_length && *s->content_length != n))
+					{
+						malformed = true;
+						return;
+					}
+					s->content_length = n;
+				}
+
+				req.insert(name, value);
+			});
+
+			if (!ok)
+				return http::http2_error::compression_error;
+
+			if (!malformed && !too_large && !(has_method && has_scheme && has_path))
+				malformed = true;
+
+			// the handlers of the reset streams fill the limit, the peer is resetting the
+			// streams to run more handlers, eg: the rapid reset attack.
+			if (!malformed && this->reset_handlers_ >= this->opt_.http2_max_concurrent_streams)
+			{
+				this->release_request(*s);
+				return http::http2_error::enhance_your_calm;
+			}
+
+			if (malformed || this->goaway_received_ ||
+				this->streams_.size() >= this->opt_.http2_max_concurrent_streams ||
+				this->handlers_ >= this->opt_.http2_max_concurrent_streams)
+			{
+				this->write_rst_stream(id, malformed ? http::http2_error::protocol_error : http::http2_error::refused_stream);
+				this->release_request(*s);
+				return http::http2_error::no_error;
+			}
+
+			if (!cookie.empty())
+				req.set(http::field::cookie, cookie);
+
+			if (!authority.empty() && req.find(http::field::host) == req.end())
+				req.set(http::field::host, authority);
+
+			s->send_window = this->peer_initial_window_;
+			s->recv_window = this->local_window_;
+
+			this->streams_.emplace(id, s);
+
+			if (too_large)
+			{
+				s->status = http::status::request_header_fields_too_large;
+				this->dispatch(s);
+			}
+			else if (s->content_length && *s->content_length > this->opt_.body_limit)
+			{
+				s->status = http::status::payload_too_large;
+				this->dispatch(s);
+			}
+
+			if (end_stream)
+				this->on_remote_end(s);
+
+			return http::http2_error::no_error;
+		}
+
+		http::http2_error on_data(const http::http2_frame_header& h, std::string_view payload)
+		{
+			if (h.stream_id == 0)
+				return http::http2_error::protocol_error;
+
+			// the whole payload is counted by the flow control, including the padding.
+			std::size_t flow = payload.size();
+
+			if (!http::detail::http2_strip_padding(h.flags, payload))
+				return http::http2_error::protocol_error;
+
+			if (static_cast<std::int64_t>(flow) > this->conn_recv_window_)
+				return http::http2_error::flow_control_error;
+
+			this->conn_recv_window_ -= flow;
+
+			if (this->conn_recv_window_ <= this->local_window_ / 2)
+			{
+				this->write_window_update(0, static_cast<std::uint32_t>(this->local_window_ - this->conn_recv_window_));
+				this->conn_recv_window_ = this->local_window_;
+			}
+
+			auto it = this->streams_.find(h.stream_id);
+			if (it == this->streams_.end() || it->second->remote_closed)
+			{
+				if (h.stream_id > this->last_stream_id_)
+					return http::http2_error::protocol_error;
+
+				this->write_rst_stream(h.stream_id, http::http2_error::stream_closed);
+				return http::http2_error::no_error;
+			}
+
+			stream_ptr s = it->second;
+
+			if (static_cast<std::int64_t>(flow) > s->recv_window)
+			{
+				this->reset_stream(*s, http::http2_error::flow_control_error);
+				return http::http2_error::no_error;
+			}
+
+			s->recv_window -= flow;
+
+			// the body of the rejected request is discarded.
+			if (s->status == http::status::unknown)
+			{
+				s->body_size += payload.size();
+
+				if (s->body_size > this->opt_.body_limit)
+				{
+					s->status = http::status::payload_too_large;
+					this->dispatch(s);
+				}
+				else
+				{
+					s->req->body().append(payload);
+				}
+			}
+
+			if (h.flags & http::http2_flags::end_stream)
+			{
+				this->on_remote_end(s);
+			}
+			else if (s->recv_window <= this->local_window_ / 2)
+			{
+				this->write_window_update(s->id, static_cast<std::uint32_t>(this->local_window_ - s->recv_window));
+				s->recv_window = this->local_window_;
+			}
+
+			return http::http2_error::no_error;
+		}
+
+		void on_remote_end(const stream_ptr& s)
+		{
+			s->remote_closed = true;
+
+			if (s->status == http::status::unknown && s->content_length && *s->content_length != s->body_size)
+			{
+				this->reset_stream(*s, http::http2_error::protocol_error);
+				return;
+			}
+
+			if (!s->dispatched)
+				this->dispatch(s);
+			else if (s->local_closed)
+				this->streams_.erase(s->id);
+		}
+
+		void release_request(stream_state& s)
+		{
+			if constexpr (http::is_arena_request_v<request_type>)
+			{
+				// the request must be destroyed before its memory is given back.
+				s.req.reset();
+
+				if (s.arena)
+					this->session_.arena_pool.release(std::exchange(s.arena, nullptr));
+			}
+			else
+			{
+				s.req.reset();
+			}
+		}
+
+		void dispatch(const stream_ptr& s)
+		{
+			s->dispatched = true;
+
+			++this->handlers_;
+
+			asio::co_spawn(this->signal_.get_executor(), this->handle(s, std::chrono::steady_clock::now()),
+			asio::bind_cancellation_slot(s->cancel.slot(), [this, s](std::exception_ptr)
+			{
+				s->cancel.slot().clear();
+
+				--this->handlers_;
+
+				if (s->reset)
+					--this->reset_handlers_;
+
+				// the handler which is cancelled doesn't release the request.
+				this->release_request(*s);
+
+				// the reader which is waiting without a deadline is idle now.
+				if (this->handlers_ == 0 && this->streams_.empty())
+					this->arm_read_deadline();
+
+				this->notify();
+			}));
+		}
+
+		asio::awaitable<void> handle(stream_ptr s, time_point parsed_time)
+		{
+			response_type rep;
+
+			if (s->status != http::status::unknown)
+			{
+				rep = http::make_error_page_response(s->status);
+			}
+			else
+			{
+				bool handled = co_await this->router_.route(parsed_time, *s->req, rep);
+
+				if (!handled && rep.get_response_header().result() == http::status::unknown)
+				{
+					rep = http::make_error_page_response(http::status::internal_server_error);
+				}
+			}
+
+			bool head = s->req->method() == http::verb::head;
+
+			if (auto events = head ? nullptr : rep.split_event_stream())
+				co_await this->send_event_stream(*s, rep, std::move(events));
+			else
+				co_await this->send_response(*s, rep, head);
+
+			if (!s->reset && !this->aborted_)
+			{
+				s->local_closed = true;
+
+				// the response was sent before the whole request was received, the client is
+				// told to stop sending the rest of the request.
+				if (!s->remote_closed)
+					this->reset_stream(*s, http::http2_error::no_error);
+				else
+					this->streams_.erase(s->id);
+			}
+
+			this->release_request(*s);
+		}
+
+		/**
+		 * @brief Encode the response header and append it in the HEADERS frames.
+		 */
+		inline void write_response_header(std::uint32_t stream_id, const http::response_header<>& header, bool end_stream)
+		{
+			std::string block;
+
+			char code[4]{};
+			std::to_chars(code, code + 3, header.result_int());
+
+			this->encoder_.encode(block, ":status", std::string_view(code, 3));
+
+			std::string name;
+
+			for (const auto& field : header)
+			{
+				std::string_view n = field.name_string();
+
+				if (http::detail::is_http2_connection_field(n))
+					continue;
+
+				name.assign(n);
+				std::transform(name.begin(), name.end(), name.begin(),
+					[](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+
+				this->encoder_.encode(block, name, field.value());
+			}
+
+			this->write_headers(stream_id, block, end_stream);
+		}
+
+		/**
+		 * @brief Send the header of the event stream response, then send the events of the
+		 * stream in the DATA frames until the stream is closed or reset.
+		 */
+		asio::awaitable<void> send_event_stream(stream_state& s, response_type& rep, std::shared_ptr<http::sse_stream> events)
+		{
+			static constexpr std::string_view heartbeat = ": keep-alive\n\n";
+
+			if (s.reset || this->aborted_)
+			{
+				events->close();
+				co_return;
+			}
+
+			s.events = events;
+
+			this->write_response_header(s.id, rep.get_response_header(), false);
+
+			std::vector<http::sse_stream::event_ptr> list;
+
+			for (;;)
+			{
+				list.clear();
+
+				bool open = co_await events->async_fetch(list, this->opt_.sse_heartbeat_interval);
+
+				if (s.reset || this->aborted_)
+					break;
+
+				std::string payload;
+
+				for (const auto& e : list)
+					payload.append(*e);
+
+				if (payload.empty() && open)
+					payload.assign(heartbeat);
+
+				for (std::string_view data = payload; !data.empty();)
+				{
+					while (!s.reset && !this->aborted_ && (this->conn_send_window_ <= 0 || s.send_window <= 0 ||
+						this->out_.size() >= max_pending_output))
+					{
+						co_await this->wait();
+					}
+
+					if (s.reset || this->aborted_)
+						break;
+
+					std::size_t n = (std::min)({ data.size(), static_cast<std::size_t>(this->peer_max_frame_size_),
+						static_cast<std::size_t>(this->conn_send_window_), static_cast<std::size_t>(s.send_window) });
+
+					this->write_frame_header(n, http::http2_frame_type::data, 0, s.id);
+					this->out_.append(data.substr(0, n));
+
+					this->conn_send_window_ -= n;
+					s.send_window -= n;
+
+					data.remove_prefix(n);
+
+					this->notify();
+				}
+
+				if (s.reset || this->aborted_)
+					break;
+
+				if (!open)
+				{
+					this->write_frame_header(0, http::http2_frame_type::data, http::http2_flags::end_stream, s.id);
+					this->notify();
+					break;
+				}
+			}
+
+			events->close();
+		}
+
+		asio::awaitable<void> send_response(stream_state& s, response_type& rep, bool head)
+		{
+			if (s.reset || this->aborted_)
+				co_return;
+
+			auto& header = rep.get_response_header();
+
+			unsigned status = header.result_int();
+
+			bool has_body = !head && status >= 200 && status != 204 && status != 304;
+
+			asio::error_code ec{};
+
+			// the first piece of the body tells whether the body is empty.
+			beast::span<asio::const_buffer> bufs;
+
+			if (has_body)
+			{
+				rep.split_body(ec);
+
+				if (!ec)
+					bufs = rep.prepare(ec);
+
+				if (ec)
+				{
+					this->reset_stream(s, http::http2_error::internal_error);
+					co_return;
+				}
+
+				has_body = beast::buffer_bytes(bufs) > 0 || !rep.is_done();
+			}
+
+			this->write_response_header(s.id, header, !has_body);
+
+			while (has_body)
+			{
+				std::size_t bytes = beast::buffer_bytes(bufs);
+
+				if (bytes == 0)
+				{
+					if (rep.is_done())
+					{
+						this->write_frame_header(0, http::http2_frame_type::data, http::http2_flags::end_stream, s.id);
+						this->notify();
+						break;
+					}
+				}
+				else
+				{
+					while (!s.reset && !this->aborted_ && (this->conn_send_window_ <= 0 || s.send_window <= 0 ||
+						this->out_.size() >= max_pending_output))
+					{
+						co_await this->wait();
+					}
+
+					if (s.reset || this->aborted_)
+						co_return;
+
+					std::size_t n = (std::min)({ bytes, static_cast<std::size_t>(this->peer_max_frame_size_),
+						static_cast<std::size_t>(this->conn_send_window_), static_cast<std::size_t>(s.send_window) });
+
+					this->write_frame_header(n, http::http2_frame_type::data, 0, s.id);
+
+					std::size_t flags_pos = this->out_.size() - 5;
+
+					for (std::size_t left = n; const auto& b : bufs)
+					{
+						std::size_t k = (std::min)(left, b.size());
+						this->out_.append(static_cast<const char*>(b.data()), k);
+						if ((left -= k) == 0)
+							break;
+					}
+
+					this->conn_send_window_ -= n;
+					s.send_window -= n;
+
+					// the memory of the consumed buffers is valid until the next prepare, so the
+					// last frame is marked after it's known that there is nothing more.
+					rep.consume(n);
+
+					if (rep.is_done())
+					{
+						this->out_[flags_pos] = static_cast<char>(http::http2_flags::end_stream);
+						this->notify();
+						break;
+					}
+
+					this->notify();
+				}
+
+				bufs = rep.prepare(ec);
+
+				if (ec)
+				{
+					this->reset_stream(s, http::http2_error::internal_error);
+					co_return;
+				}
+			}
+		}
+
+	protected:
+		SessionT&                                       session_;
+
+		StreamT&                                        stream_;
+
+		RouterT&                                        router_;
+
+		const http_serve_option&                        opt_;
+
+		// It's cancelled to wake up the coroutines which are waiting for the output, the
+		// windows or the handlers, each of them checks its condition again.
+		asio::steady_timer                              signal_;
+
+		// The reader and the writer wait for the client at the same time, each of them has its
+		// own deadline, see the arm_read_deadline.
+		asio::connection_deadline                       read_deadline_;
+
+		asio::connection_deadline                       write_deadline_;
+
+		// When the partial frame or header block was started, the rest of it is read within the
+		// header_timeout since then.
+		time_point                                      partial_since_{};
+
+		// Whether the request bodies of the open streams are being received.
+		bool                                            receiving_ = false;
+
+		beast::flat_buffer                              buffer_;
+
+		// The frames which are waiting to be written and the frames which are being written.
+		std::string                                     out_;
+
+		std::string                                     writing_;
+
+		http::hpack_decoder                             decoder_;
+
+		http::hpack_encoder                             encoder_;
+
+		std::unordered_map<std::uint32_t, stream_ptr>   streams_;
+
+		// The header block which is continued by the CONTINUATION frames.
+		std::string                                     block_;
+
+		std::uint8_t                                    block_flags_ = 0;
+
+		std::uint32_t                                   block_stream_id_ = 0;
+
+		std::uint32_t                                   continuation_id_ = 0;
+
+		std::uint32_t                                   last_stream_id_ = 0;
+
+		std::uint32_t                                   local_window_ = http::http2_default_window_size;
+
+		std::uint32_t                                   peer_initial_window_ = http::http2_default_window_size;
+
+		std::uint32_t                                   peer_max_frame_size_ = http::http2_default_frame_size;
+
+		std::int64_t                                    conn_send_window_ = http::http2_default_window_size;
+
+		std::int64_t                                    conn_recv_window_ = http::http2_default_window_size;
+
+		std::size_t                                     handlers_ = 0;
+
+		// The handlers which are still running for the streams that were reset.
+		std::size_t                                     reset_handlers_ = 0;
+
+		asio::error_code                                ec_{};
+
+		bool                                            settings_received_ = false;
+
+		bool                                            goaway_sent_ = false;
+
+		bool                                            goaway_received_ = false;
+
+		// The responses are not sent anymore.
+		bool                                            aborted_ = false;
+
+		// The reader and the handlers have finished, the writer exits after the output is written.
+		bool                                            finished_ = false;
+	};
+
+	/**
+	 * @brief Serve the HTTP/2 connection with the router until it's closed.
+	 * @param stream - The tcp socket whose preface hasn't been read, or the tls stream which
+	 *                 negotiated "h2".
+	 * @param buffer - The data which has been read from the stream, eg: the preface which is
+	 *                 read by the http2_async_detect.
+	 */
+	template<class SessionT, class StreamT, class RouterT>
+	asio::awaitable<asio::error_code> http2_async_serve(
+		SessionT& session, StreamT& stream, RouterT& router, http_serve_option opt,
+		beast::flat_buffer buffer = {})
+	{
+		http2_connection<SessionT, StreamT, RouterT> conn(
+			session, stream, router, opt, co_await asio::this_coro::executor, std::move(buffer));
+
+		asio::error_code ec = co_await conn.run();
+
+		if constexpr (http::is_arena_request_v<typename SessionT::request_type>)
+			session.arena_pool.release_all();
+
+		co_return ec;
+	}
+}
+
+#if defined(ASIO3_ENABLE_SSL)
+#ifdef ASIO_STANDALONE
+namespace asio
+#else
+namespace boost::asio
+#endif
+{
+	/**
+	 * @brief Let the tls server select "h2" by ALPN if the client offers it, otherwise
+	 * "http/1.1", the connection is served without ALPN if the client offers neither.
+	 */
+	inline void set_alpn_http2(asio::ssl::context& ssl_context)
+	{
+		::SSL_CTX_set_alpn_select_cb(ssl_context.native_handle(),
+		[](SSL*, const unsigned char** out, unsigned char* outlen,
+			const unsigned char* in, unsigned int inlen, void*) -> int
+		{
+			// the protocols of the server in the order of preference.
+			static constexpr unsigned char protocols[] = "\x02h2\x08http/1.1";
+
+			if (::SSL_select_next_proto(const_cast<unsigned char**>(out), outlen,
+				protocols, sizeof(protocols) - 1, in, inlen) != OPENSSL_NPN_NEGOTIATED)
+				return SSL_TLSEXT_ERR_NOACK;
+
+			return SSL_TLSEXT_ERR_OK;
+		}, nullptr);
+	}
+
+	/**
+	 * @brief Check whether "h2" was selected by ALPN in the handshake of the tls stream.
+	 */
+	template<class SslStream>
+	inline bool is_http2_negotiated(SslStream& ssl_stream) noexcept
+	{
+		const unsigned char* protocol = nullptr;
+		unsigned int size = 0;
+
+		::SSL_get0_alpn_selected(ssl_stream.native_handle(), &protocol, &size);
+
+		return std::string_view(reinterpret_cast<const char*>(protocol), size) == "h2";
+	}
+}
+#endif
@@ -13,6 +13,7 @@
 #include <asio3/tcp/tcp_server.hpp>
 #include <asio3/http/http_session.hpp>
 #include <asio3/http/router.hpp>
+#include <asio3/http/file_cache.hpp>
 
 #ifdef ASIO_STANDALONE
 namespace asio
@@ -31,7 +32,7 @@ namespace boost::asio
 		using request_type = typename SessionT::request_type;
 		using response_type = typename SessionT::response_type;
 
-		explicit basic_http_server(const auto& ex) : super(ex)
+		explicit basic_http_server(const auto& ex) : super(ex), file_cache(ex)
 		{
 		}
 
@@ -50,9 +51,55 @@ namespace boost::asio
 			return static_cast<super&>(*this);
 		}
 
+		/**
+		 * @brief Accept the connections and serve the requests of each connection with the
+		 * router, until the server is stopped.
+		 * The connections are added into the session_map, and closed when they are idle
+		 * longer than the idle_timeout of the option.
+		 * @param opt - The limits and timeouts of each connection, see http_serve_option.
+		 * @param token - The completion handler to invoke when the operation completes.
+		 *	  The equivalent function signature of the handler must be:
+		 *    @code
+		 *    void handler(const asio::error_code& ec);
+		 */
+		template<typename ServeToken = asio::default_token_type<asio::tcp_acceptor>>
+		inline auto async_serve(
+			http_serve_option opt = {},
+			ServeToken&& token = asio::default_token_type<asio::tcp_acceptor>())
+		{
+			return super::async_serve(
+			[this, opt](typename super::socket_type sock) mutable -> asio::awaitable<void>
+			{
+				auto session = std::make_shared<SessionT>(std::move(sock));
+
+				co_await this->session_map.async_add(session);
+
+				co_await session->async_serve(this->router, opt);
+
+				co_await this->session_map.async_remove(session);
+
+				session->close();
+			}, std::forward<ServeToken>(token));
+		}
+
+		/**
+		 * @brief Asynchronously stop the server, the watching of the file cache is stopped too.
+		 */
+		template<typename StopToken = asio::default_token_type<asio::tcp_acceptor>>
+		inline auto async_stop(
+			StopToken&& token = asio::default_token_type<asio::tcp_acceptor>())
+		{
+			this->file_cache.stop();
+
+			return super::async_stop(std::forward<StopToken>(token));
+		}
+
 	public:
 		std::filesystem::path webroot{ std::filesystem::current_path() };
 
+		// The opened files under the webroot, eg: http::make_file_response(server.file_cache, server.webroot, req)
+		http::file_cache file_cache;
+
 		RouterT router{};
 	};
 
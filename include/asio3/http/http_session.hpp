@@ -14,6 +14,8 @@
 #include <asio3/http/core.hpp>
 #include <asio3/http/read.hpp>
 #include <asio3/http/write.hpp>
+#include <asio3/http/serve.hpp>
+#include <asio3/http/http2.hpp>
 
 #ifdef ASIO_STANDALONE
 namespace asio
@@ -21,13 +23,13 @@ namespace asio
 namespace boost::asio
 #endif
 {
-	template<typename SocketT = tcp_socket>
+	template<typename SocketT = tcp_socket, typename RequestT = http::web_request>
 	class basic_http_session : public basic_tcp_session<SocketT>
 	{
 	public:
 		using super = basic_tcp_session<SocketT>;
 		using socket_type = SocketT;
-		using request_type = http::web_request;
+		using request_type = RequestT;
 		using response_type = http::web_response;
 
 		/**
@@ -53,6 +55,41 @@ namespace boost::asio
 		{
 			return static_cast<super&>(*this);
 		}
+
+		/**
+		 * @brief Serve the requests of the connection with the router until the connection is closed.
+		 * The next requests are read ahead while the earlier ones are being handled, and the
+		 * responses are written in the order of the requests. If the connection starts with the
+		 * preface of HTTP/2 (h2c with prior knowledge), it's served as a HTTP/2 connection.
+		 * @param router - The router which has a member function:
+		 *                 route(std::chrono::steady_clock::time_point, request_type&, response_type&)
+		 *                 The body of the request routed to a streaming route is pulled by the
+		 *                 route, see http::basic_router::find_stream_route.
+		 * @param opt - The limits and timeouts, see http_serve_option.
+		 * @return The error which caused the connection closed, or empty if it was closed gracefully.
+		 */
+		template<typename RouterT>
+		inline asio::awaitable<asio::error_code> async_serve(RouterT& router, http_serve_option opt = {})
+		{
+			// the first bytes which are read by the detecting are served by either protocol.
+			beast::flat_buffer buffer;
+
+			if (opt.enable_http2)
+			{
+				auto [ec, is_http2] = co_await detail::http2_async_detect(this->socket, buffer, opt);
+				if (ec)
+					co_return ec == asio::error::eof ? asio::error_code{} : ec;
+
+				if (is_http2)
+					co_return co_await detail::http2_async_serve(
+						*this, this->socket, router, std::move(opt), std::move(buffer));
+			}
+
+			co_return co_await detail::http_async_serve(*this, router, std::move(opt), std::move(buffer));
+		}
+
+	public:
+		http::request_arena_pool arena_pool;
 	};
 
 	using http_session = basic_http_session<asio::tcp_socket>;
@@ -46,6 +46,44 @@ namespace boost::asio
 			return static_cast<super&>(*this);
 		}
 
+		/**
+		 * @brief Accept the connections and serve the requests of each connection with the
+		 * router after the handshake, until the server is stopped.
+		 * If the enable_http2 of the option is true, "h2" is offered by ALPN and the connections
+		 * which negotiated it are served as HTTP/2 connections.
+		 * @param opt - The limits and timeouts of each connection, see http_serve_option.
+		 * @param token - The completion handler to invoke when the operation completes.
+		 *	  The equivalent function signature of the handler must be:
+		 *    @code
+		 *    void handler(const asio::error_code& ec);
+		 */
+		template<typename ServeToken = asio::default_token_type<asio::tcp_acceptor>>
+		inline auto async_serve(
+			http_serve_option opt = {},
+			ServeToken&& token = asio::default_token_type<asio::tcp_acceptor>())
+		{
+			if (opt.enable_http2)
+				asio::set_alpn_http2(this->ssl_context);
+
+			return super::super::async_serve(
+			[this, opt](typename super::socket_type sock) mutable -> asio::awaitable<void>
+			{
+				auto session = std::make_shared<SessionT>(std::move(sock), this->ssl_context);
+
+				auto [e1] = co_await asio::async_handshake(session->ssl_stream, ssl::stream_base::server);
+				if (!e1)
+				{
+					co_await this->session_map.async_add(session);
+
+					co_await session->async_serve(this->router, opt);
+
+					co_await this->session_map.async_remove(session);
+				}
+
+				session->close();
+			}, std::forward<ServeToken>(token));
+		}
+
 	public:
 		asio::ssl::context                   ssl_context;
 	};
@@ -13,6 +13,8 @@
 #include <asio3/core/asio.hpp>
 #include <asio3/core/beast.hpp>
 #include <asio3/http/core.hpp>
+#include <asio3/http/serve.hpp>
+#include <asio3/http/http2.hpp>
 #include <asio3/tcp/tcps_session.hpp>
 
 #ifdef ASIO_STANDALONE
@@ -49,6 +51,26 @@ namespace boost::asio
 		{
 			return static_cast<super&>(*this);
 		}
+
+		/**
+		 * @brief Serve the requests of the connection with the router until the connection is closed,
+		 * the handshake must have been completed. If "h2" was negotiated by ALPN, the connection
+		 * is served as a HTTP/2 connection.
+		 * @param router - The router which has a member function:
+		 *                 route(std::chrono::steady_clock::time_point, request_type&, response_type&)
+		 *                 The body of the request routed to a streaming route is pulled by the
+		 *                 route, see http::basic_router::find_stream_route.
+		 * @param opt - The limits and timeouts, see http_serve_option.
+		 * @return The error which caused the connection closed, or empty if it was closed gracefully.
+		 */
+		template<typename RouterT>
+		inline asio::awaitable<asio::error_code> async_serve(RouterT& router, http_serve_option opt = {})
+		{
+			if (opt.enable_http2 && asio::is_http2_negotiated(this->ssl_stream))
+				co_return co_await detail::http2_async_serve(*this, this->ssl_stream, router, std::move(opt));
+
+			co_return co_await detail::http_async_serve(*this, router, std::move(opt));
+		}
 	};
 
 	using https_session = basic_https_session<asio::tcp_socket>;
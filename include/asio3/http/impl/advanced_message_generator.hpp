@@ -10,6 +10,7 @@
 #pragma once
 
 #include <asio3/http/advanced_message_generator.hpp>
+#include <asio3/http/native_file.hpp>
 
 #ifdef ASIO3_HEADER_ONLY
 #include <asio3/bho/beast/core/buffers_generator.hpp>
@@ -78,7 +79,7 @@ struct write_to_string_body_helper
 template <class BodyT, class FieldsT>
 void reinit_response(http::response<BodyT, FieldsT>& m)
 {
-    if constexpr (std::same_as<std::decay_t<BodyT>, http::file_body>)
+    if constexpr (http::is_file_body_v<std::decay_t<BodyT>>)
     {
         error_code ec{};
         m.body().seek(0, ec);
@@ -141,37 +142,186 @@ http::response_header<>& get_response_header_impl(http::request<BodyT, FieldsT>&
     return s;
 }
 
-} // detail
-
+// Produces the payload of the body with the writer of the body, it's used by the
+// generators instead of the serializer after `split_body` was called.
 template <bool isRequest, class Body, class Fields>
-advanced_message_generator::advanced_message_generator(
-    http::message<isRequest, Body, Fields>&& m)
-    : impl_(std::make_unique<
-            generator_impl<isRequest, Body, Fields>>(
-          std::move(m)))
+struct body_payload
 {
-}
+    using const_buffers_type = span<net::const_buffer>;
 
-template <bool isRequest, class Body, class Fields>
+    std::unique_ptr<typename Body::writer> wr_;
+    bool more_ = true;
+
+    explicit operator bool() const noexcept
+    {
+        return wr_ != nullptr;
+    }
+
+    void
+    init(http::message<isRequest, Body, Fields>& m, error_code& ec)
+    {
+        wr_ = std::make_unique<typename Body::writer>(m.base(), m.body());
+        wr_->init(ec);
+        more_ = !ec;
+    }
+
+    bool
+    is_done(const_buffers_type const& cur) const
+    {
+        return !more_ && beast::buffer_bytes(cur) == 0;
+    }
+
+    template<std::size_t N>
+    void
+    prepare(error_code& ec, std::array<net::const_buffer, N>& bs, const_buffers_type& cur)
+    {
+        if (beast::buffer_bytes(cur) > 0 || !more_)
+            return;
+
+        cur = { bs.data(), 0 };
+
+        auto r = wr_->get(ec);
+        if (ec || !r)
+        {
+            more_ = false;
+            return;
+        }
+
+        more_ = r->second;
+
+        auto it = net::buffer_sequence_begin(r->first);
+
+        std::size_t n = (std::min)(bs.size(), static_cast<std::size_t>(
+            std::distance(it, net::buffer_sequence_end(r->first))));
+
+        cur = { bs.data(), n };
+        std::copy_n(it, n, cur.begin());
+    }
+
+    static void
+    consume(const_buffers_type& cur, std::size_t n)
+    {
+        std::size_t i = 0;
+        while (i < cur.size() && n >= cur[i].size())
+        {
+            n -= cur[i].size();
+            ++i;
+        }
+
+        cur = cur.subspan(i);
+
+        if (!cur.empty())
+            cur[0] += n;
+    }
+};
+
+// The ways a message is held by the generator implementation, the message is owned,
+// referenced, or shared with others. Only the owned message can hand its body out to
+// the caller, e.g. the file of the file_body.
+template <class Message>
+struct owned_message
+{
+    using message_type = Message;
+
+    static constexpr bool owns_body = true;
+
+    explicit owned_message(Message&& m)
+        : m_(std::move(m))
+    {
+    }
+
+    Message&
+    get() noexcept
+    {
+        return m_;
+    }
+
+    const Message&
+    get() const noexcept
+    {
+        return m_;
+    }
+
+    Message m_;
+};
+
+template <class Message>
+struct referenced_message
+{
+    using message_type = Message;
+
+    static constexpr bool owns_body = false;
+
+    explicit referenced_message(Message& m) noexcept
+        : m_(m)
+    {
+    }
+
+    Message&
+    get() const noexcept
+    {
+        return m_;
+    }
+
+    Message& m_;
+};
+
+template <class Message>
+struct shared_message
+{
+    using message_type = Message;
+
+    static constexpr bool owns_body = false;
+
+    explicit shared_message(std::shared_ptr<Message> m) noexcept
+        : m_(std::move(m))
+    {
+    }
+
+    Message&
+    get() const noexcept
+    {
+        return *m_;
+    }
+
+    std::shared_ptr<Message> m_;
+};
+
+} // detail
+
+template <class Holder>
 struct advanced_message_generator::generator_impl final
     : advanced_message_generator::impl_base
 {
-    explicit generator_impl(
-        http::message<isRequest, Body, Fields>&& m)
-        : m_(std::move(m))
-        , sr_(m_)
+    using message_type = typename Holder::message_type;
+    using body_type    = typename message_type::body_type;
+    using fields_type  = typename message_type::fields_type;
+
+    static constexpr bool is_request = message_type::is_request::value;
+
+    template<class Arg>
+    explicit generator_impl(Arg&& arg)
+        : holder_(std::forward<Arg>(arg))
+        , sr_(holder_.get())
     {
     }
 
     bool
     is_done() override
     {
+        if (payload_)
+            return payload_.is_done(current_);
         return sr_.is_done();
     }
 
     const_buffers_type
     prepare(error_code& ec) override
     {
+        if (payload_)
+        {
+            payload_.prepare(ec, bs_, current_);
+            return current_;
+        }
         sr_.next(ec, visit{*this});
         return current_;
     }
@@ -179,35 +329,105 @@ struct advanced_message_generator::generator_impl final
     void
     consume(std::size_t n) override
     {
+        if (payload_)
+            return payload_.consume(current_, n);
         sr_.consume((std::min)(n, beast::buffer_bytes(current_)));
     }
 
+    void
+    split_body(error_code& ec) override
+    {
+        current_ = { bs_.data(), 0 };
+        payload_.init(holder_.get(), ec);
+    }
+
+    std::optional<file_body_range>
+    split_file_body() override
+    {
+        if constexpr (Holder::owns_body && !is_request &&
+            http::is_descriptor_file_body_v<std::decay_t<body_type>>)
+        {
+            message_type& m = holder_.get();
+
+            if (m.chunked() || sr_.is_header_done() || !m.body().is_open())
+                return std::nullopt;
+
+            // the file may have no descriptor, eg: the in-memory variant of the file cache.
+            if (m.body().file().native_handle() == -1)
+                return std::nullopt;
+
+            error_code ec{};
+            std::uint64_t pos = m.body().file().pos(ec);
+            if (ec)
+                return std::nullopt;
+
+            sr_.split(true);
+
+            return file_body_range{ m.body().file().native_handle(), pos, m.body().size() };
+        }
+        else
+        {
+            return std::nullopt;
+        }
+    }
+
+    std::shared_ptr<sse_stream>
+    split_event_stream() override
+    {
+        if constexpr (Holder::owns_body && !is_request &&
+            std::is_same_v<typename body_type::value_type, std::shared_ptr<sse_stream>>)
+        {
+            message_type& m = holder_.get();
+
+            if (!m.body() || sr_.is_header_done())
+                return nullptr;
+
+            sr_.split(true);
+
+            return m.body();
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+
+    bool
+    is_header_done() override
+    {
+        return sr_.is_header_done();
+    }
+
     bool
     keep_alive() const noexcept override
     {
-        return m_.keep_alive();
+        return holder_.get().keep_alive();
     }
 
     http::response_header<>&
     get_response_header() noexcept override
     {
-        return detail::get_response_header_impl(m_);
+        return detail::get_response_header_impl(holder_.get());
     }
 
     std::expected<http::response<http::string_body>, error_code> to_string_body_response() override
     {
-        return detail::to_string_body_response_impl(m_);
+        return detail::to_string_body_response_impl(holder_.get());
     }
 
 private:
-    static constexpr unsigned max_fixed_bufs = 12;
+    // The start line, the header fields and the body are gathered into one write, so it
+    // must hold the buffers of a header with a dozen or more fields.
+    static constexpr unsigned max_fixed_bufs = 24;
 
-    http::message<isRequest, Body, Fields> m_;
-    http::serializer<isRequest, Body, Fields> sr_;
+    Holder holder_;
+    http::serializer<is_request, body_type, fields_type> sr_;
 
     std::array<net::const_buffer, max_fixed_bufs> bs_;
     const_buffers_type current_ = bs_; // subspan
 
+    detail::body_payload<is_request, body_type, fields_type> payload_;
+
     struct visit
     {
         generator_impl& self_;
@@ -233,104 +453,107 @@ private:
 
 };
 
-template <bool isRequest, class Body, class Fields>
-struct advanced_message_generator::ref_generator_impl final
+struct advanced_message_generator::serialized_generator_impl final
     : advanced_message_generator::impl_base
 {
-    explicit ref_generator_impl(
-        http::message<isRequest, Body, Fields>& m)
-        : m_(m)
-        , sr_(m_)
+    explicit serialized_generator_impl(
+        std::shared_ptr<serialized_response> m)
+        : m_(std::move(m))
     {
     }
 
     bool
     is_done() override
     {
-        return sr_.is_done();
+        return pos_ >= m_->data.size();
     }
 
     const_buffers_type
-    prepare(error_code& ec) override
+    prepare(error_code&) override
     {
-        sr_.next(ec, visit{*this});
-        return current_;
+        buf_ = net::const_buffer(m_->data.data() + pos_, m_->data.size() - pos_);
+        return { &buf_, 1 };
     }
 
     void
     consume(std::size_t n) override
     {
-        sr_.consume((std::min)(n, beast::buffer_bytes(current_)));
+        pos_ += (std::min)(n, m_->data.size() - pos_);
+    }
+
+    void
+    split_body(error_code&) override
+    {
+        pos_ = (std::max)(pos_, (std::min)(m_->header_size, m_->data.size()));
     }
 
     bool
     keep_alive() const noexcept override
     {
-        return m_.keep_alive();
+        return m_->keep_alive;
     }
 
     http::response_header<>&
     get_response_header() noexcept override
     {
-        return detail::get_response_header_impl(m_);
+        return m_->header;
     }
 
     std::expected<http::response<http::string_body>, error_code> to_string_body_response() override
     {
-        return detail::to_string_body_response_impl(m_);
+        http::response<http::string_body> res{ m_->header };
+        res.body().assign(m_->data, (std::min)(m_->header_size, m_->data.size()));
+        return res;
     }
 
 private:
-    static constexpr unsigned max_fixed_bufs = 12;
-
-    http::message<isRequest, Body, Fields>& m_;
-    http::serializer<isRequest, Body, Fields> sr_;
-
-    std::array<net::const_buffer, max_fixed_bufs> bs_;
-    const_buffers_type current_ = bs_; // subspan
-
-    struct visit
-    {
-        ref_generator_impl& self_;
-
-        template<class ConstBufferSequence>
-        void
-        operator()(error_code&, ConstBufferSequence const& buffers)
-        {
-            auto& s = self_.bs_;
-            auto& cur = self_.current_;
-
-            auto it = net::buffer_sequence_begin(buffers);
-
-            std::size_t n =
-                std::distance(it, net::buffer_sequence_end(buffers));
-
-            n = (std::min)(s.size(), n);
-
-            cur = { s.data(), n };
-            std::copy_n(it, n, cur.begin());
-        }
-    };
-
+    std::shared_ptr<serialized_response> m_;
+    std::size_t pos_ = 0;
+    net::const_buffer buf_;
 };
 
 template<typename>
 advanced_message_generator::advanced_message_generator()
     : impl_(std::make_unique<
-            generator_impl<false, http::string_body, http::fields>>(
+            generator_impl<detail::owned_message<http::message<false, http::string_body, http::fields>>>>(
           http::message<false, http::string_body, http::fields>(http::status::unknown, 11)))
 {
 }
 
+template <bool isRequest, class Body, class Fields>
+advanced_message_generator::advanced_message_generator(
+    http::message<isRequest, Body, Fields>&& m)
+    : impl_(std::make_unique<
+            generator_impl<detail::owned_message<http::message<isRequest, Body, Fields>>>>(
+          std::move(m)))
+{
+}
+
 template <bool isRequest, class Body, class Fields>
 advanced_message_generator::advanced_message_generator(
     std::reference_wrapper<http::message<isRequest, Body, Fields>> m)
     : impl_(std::make_unique<
-            ref_generator_impl<isRequest, Body, Fields>>(
+            generator_impl<detail::referenced_message<http::message<isRequest, Body, Fields>>>>(
           m.get()))
 {
 }
 
+template <bool isRequest, class Body, class Fields>
+advanced_message_generator::advanced_message_generator(
+    std::shared_ptr<http::message<isRequest, Body, Fields>> m)
+    : impl_(std::make_unique<
+            generator_impl<detail::shared_message<http::message<isRequest, Body, Fields>>>>(
+          std::move(m)))
+{
+}
+
+template<typename>
+advanced_message_generator::advanced_message_generator(
+    std::shared_ptr<serialized_response> m)
+    : impl_(std::make_unique<serialized_generator_impl>(std::move(m)))
+{
+}
+
 } // namespace http
 } // namespace beast
 } // namespace bho
@@ -14,6 +14,8 @@
 
 #include <asio3/http/core.hpp>
 #include <asio3/http/mime_types.hpp>
+#include <asio3/http/header_cache.hpp>
+#include <asio3/http/native_file.hpp>
 
 #ifdef ASIO3_HEADER_ONLY
 namespace bho::beast::http
@@ -216,7 +218,7 @@ namespace boost::beast::http
 	{
 		http::response<http::string_body> rep{};
 
-		rep.set(http::field::server, BEAST_VERSION_STRING);
+		http::set_server_and_date(rep);
 		rep.set(http::field::content_type, mimetype.empty() ? "text/plain" : mimetype);
 
 		rep.result(result);
@@ -278,6 +280,62 @@ namespace boost::beast::http
 			mimetype.empty() ? "text/html" : mimetype, version);
 	}
 
+	namespace detail
+	{
+		template<class Body>
+		inline std::expected<http::response<Body>, error_code> make_file_response_impl(
+			std::filesystem::path filepath, http::status result, unsigned version)
+		{
+			// Attempt to open the file
+			beast::error_code ec;
+			typename Body::value_type body;
+			body.open(filepath.string().c_str(), beast::file_mode::scan, ec);
+
+			// Handle the case where the file doesn't exist
+			if (ec == beast::errc::no_such_file_or_directory)
+				return std::unexpected(ec);
+
+			// Handle an unknown error
+			if (ec)
+				return std::unexpected(ec);
+
+			// Cache the size since we need it after the move
+			auto const size = body.size();
+
+			// Respond to GET request
+			http::response<Body> res{
+				std::piecewise_construct,
+				std::make_tuple(std::move(body)),
+				std::make_tuple(http::status::ok, version) };
+			http::set_server_and_date(res);
+			res.set(http::field::content_type, http::extension_to_mimetype(filepath.extension().string()));
+			res.content_length(size);
+			res.result(result);
+			res.version(version < 10 ? 11 : version);
+
+			return res;
+		}
+
+		inline std::filesystem::path make_file_response_path(
+			std::filesystem::path root_path, std::filesystem::path file_path)
+		{
+			std::filesystem::path filepath;
+
+			if (root_path.empty())
+			{
+				filepath = std::move(file_path);
+			}
+			else
+			{
+				filepath = asio::make_filepath(root_path, file_path);
+			}
+
+			filepath.make_preferred();
+
+			return filepath;
+		}
+	}
+
 	/**
 	 * @brief Respond to http request with local file
 	 */
@@ -286,34 +344,7 @@ namespace boost::beast::http
 		std::filesystem::path filepath,
 		http::status result = http::status::ok, unsigned version = 11)
 	{
-		// Attempt to open the file
-		beast::error_code ec;
-		http::file_body::value_type body;
-		body.open(filepath.string().c_str(), beast::file_mode::scan, ec);
-
-		// Handle the case where the file doesn't exist
-		if (ec == beast::errc::no_such_file_or_directory)
-			return std::unexpected(ec);
-
-		// Handle an unknown error
-		if (ec)
-			return std::unexpected(ec);
-
-		// Cache the size since we need it after the move
-		auto const size = body.size();
-
-		// Respond to GET request
-		http::response<http::file_body> res{
-			std::piecewise_construct,
-			std::make_tuple(std::move(body)),
-			std::make_tuple(http::status::ok, version) };
-		res.set(http::field::server, BEAST_VERSION_STRING);
-		res.set(http::field::content_type, http::extension_to_mimetype(filepath.extension().string()));
-		res.content_length(size);
-		res.result(result);
-		res.version(version < 10 ? 11 : version);
-
-		return res;
+		return detail::make_file_response_impl<http::file_body>(std::move(filepath), result, version);
 	}
 
 	/**
@@ -325,20 +356,8 @@ namespace boost::beast::http
 		std::filesystem::path file_path,
 		http::status result, unsigned version = 11)
 	{
-		std::filesystem::path filepath;
-
-		if (root_path.empty())
-		{
-			filepath = std::move(file_path);
-		}
-		else
-		{
-			filepath = asio::make_filepath(root_path, file_path);
-		}
-
-		filepath.make_preferred();
-
-		return make_file_response(std::move(filepath), result, version);
+		return detail::make_file_response_impl<http::file_body>(
+			detail::make_file_response_path(std::move(root_path), std::move(file_path)), result, version);
 	}
 
 	/**
@@ -352,4 +371,43 @@ namespace boost::beast::http
 	{
 		return make_file_response(std::move(root_path), std::filesystem::path(std::string_view(file_path)), result, version);
 	}
+
+	/**
+	 * @brief Respond to http request with local file, the file body holds the file descriptor.
+	 * When the response is written to a plain tcp socket by http::async_write_response (the
+	 * http_serve does), the body is sent with sendfile without copying it to the user space.
+	 */
+	template<typename = void>
+	inline std::expected<http::response<http::native_file_body>, error_code> make_native_file_response(
+		std::filesystem::path filepath,
+		http::status result = http::status::ok, unsigned version = 11)
+	{
+		return detail::make_file_response_impl<http::native_file_body>(std::move(filepath), result, version);
+	}
+
+	/**
+	 * @brief Respond to http request with local file, the file body holds the file descriptor.
+	 */
+	template<typename = void>
+	inline std::expected<http::response<http::native_file_body>, error_code> make_native_file_response(
+		std::filesystem::path root_path,
+		std::filesystem::path file_path,
+		http::status result, unsigned version = 11)
+	{
+		return detail::make_file_response_impl<http::native_file_body>(
+			detail::make_file_response_path(std::move(root_path), std::move(file_path)), result, version);
+	}
+
+	/**
+	 * @brief Respond to http request with local file, the file body holds the file descriptor.
+	 */
+	template<typename = void>
+	inline std::expected<http::response<http::native_file_body>, error_code> make_native_file_response(
+		std::filesystem::path root_path,
+		beast::string_view file_path,
+		http::status result = http::status::ok, unsigned version = 11)
+	{
+		return make_native_file_response(std::move(root_path),
+			std::filesystem::path(std::string_view(file_path)), result, version);
+	}
 }
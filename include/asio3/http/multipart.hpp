@@ -21,8 +21,12 @@
 #include <stdarg.h>
 #include <string.h>
 
+#include <array>
 #include <list>
 #include <map>
+#include <memory>
+#include <limits>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <algorithm>
@@ -32,6 +36,10 @@
 #include <asio3/core/beast.hpp>
 
 #include <asio3/core/strutil.hpp>
+#include <asio3/core/with_lock.hpp>
+#include <asio3/core/file.hpp>
+
+#include <asio3/http/body_reader.hpp>
 
 #ifdef ASIO3_HEADER_ONLY
 namespace bho::beast::http
@@ -426,8 +434,125 @@ inline std::ostream& operator<<(std::ostream& os, const basic_multipart_fields<S
 	return os << to_string(fields);
 }
 
+/**
+ * @brief The headers of a part, the values are the views of the buffer which is passed to the
+ * multipart_reader, so they are only valid until the parsed bytes are consumed.
+ */
+struct multipart_part_header
+{
+	std::string_view content_disposition;
+	std::string_view name;
+	std::string_view filename;
+	std::string_view content_type;
+	std::string_view content_transfer_encoding;
+};
+
 namespace multipart_parser
 {
+	/*
+	 * Parse the header lines of a part, which are between the boundary line and the empty line.
+	 */
+	inline bool parse_header(multipart_part_header& part, std::string_view header)
+	{
+		part = {};
+
+		while (!header.empty())
+		{
+			auto pos_row = header.find(CRLF);
+
+			std::string_view header_row = header.substr(0, pos_row);
+
+			header.remove_prefix(pos_row == std::string_view::npos ? header.size() : pos_row + 2);
+
+			if (header_row.empty())
+				continue;
+
+			// find the header type name.
+			auto pos1 = header_row.find(':');
+			if (pos1 == std::string_view::npos)
+				return false;
+
+			std::string_view type  = header_row.substr(0, pos1);
+			std::string_view value = header_row.substr(pos1 + 1);
+
+			asio::trim_both(type);
+			asio::trim_both(value);
+
+			if /**/(beast::iequals(type, "Content-Disposition"))
+			{
+				auto pos2 = value.find(';');
+
+				std::string_view disposition = value.substr(0, pos2);
+				asio::trim_both(disposition);
+				part.content_disposition = disposition;
+
+				std::string_view kvs = (pos2 == std::string_view::npos ? std::string_view{} : value.substr(pos2 + 1));
+
+				while (!asio::trim_left(kvs).empty())
+				{
+					auto pos3 = kvs.find('=');
+					if (pos3 == std::string_view::npos)
+						return false;
+
+					std::string_view k = kvs.substr(0, pos3);
+					std::string_view v;
+
+					asio::trim_both(k);
+
+					kvs.remove_prefix(pos3 + 1);
+					asio::trim_left(kvs);
+
+					// the quoted value, eg: filename="a;b.txt", may contains the ';'
+					if (!kvs.empty() && kvs.front() == '\"')
+					{
+						auto pos4 = kvs.find('\"', 1);
+						if (pos4 == std::string_view::npos)
+							return false;
+
+						v = kvs.substr(1, pos4 - 1);
+
+						kvs.remove_prefix(pos4 + 1);
+					}
+
+					auto pos5 = kvs.find(';');
+
+					if (v.data() == nullptr)
+					{
+						v = kvs.substr(0, pos5);
+						asio::trim_both(v);
+					}
+
+					kvs.remove_prefix(pos5 == std::string_view::npos ? kvs.size() : pos5 + 1);
+
+					if /**/ (beast::iequals(k, "name"))
+						part.name = v;
+					else if (beast::iequals(k, "filename"))
+						part.filename = v;
+				}
+			}
+			else if (beast::iequals(type, "Content-Type"))
+			{
+				part.content_type = value;
+			}
+			else if (beast::iequals(type, "Content-Transfer-Encoding"))
+			{
+				part.content_transfer_encoding = value;
+			}
+		}
+
+		return true;
+	}
+
+	template<class String>
+	inline void assign_field(basic_multipart_field<String>& field, const multipart_part_header& part)
+	{
+		field.content_disposition      (part.content_disposition      );
+		field.name                     (part.name                     );
+		field.filename                 (part.filename                 );
+		field.content_type             (part.content_type             );
+		field.content_transfer_encoding(part.content_transfer_encoding);
+	}
+
 	template<class String>
 	inline bool parse_field(basic_multipart_field<String>& field, std::string_view content)
 	{
@@ -435,12 +560,8 @@ namespace multipart_parser
 		if (content.size() < 8)
 			return false;
 
-		// first 2 bytes must be "\r\n"
-		if (content.substr(0, 2) != CRLF)
-			return false;
-
-		// last 2 bytes must be "\r\n"
-		if (content.substr(content.size() - 2) != CRLF)
+		// first 2 bytes must be "\r\n" and last 2 bytes must be "\r\n"
+		if (!content.starts_with(CRLF) || !content.ends_with(CRLF))
 			return false;
 
 		// remove the first "\r\n" and the last "\r\n"
@@ -451,165 +572,444 @@ namespace multipart_parser
 		if (split == std::string_view::npos)
 			return false;
 
-		std::string_view header = content.substr(0, split);
-		std::string_view value  = content.substr(split + 4);
+		multipart_part_header part{};
+
+		if (!parse_header(part, content.substr(0, split)))
+			return false;
+
+		assign_field(field, part);
+
+		field.value(content.substr(split + 4));
+
+		return true;
+	}
+}
+
+/**
+ * @brief The incremental parser of the "multipart/form-data" body, the body can be fed in any
+ * size of pieces, the part headers are returned as views of the input, and the part body is
+ * returned as the views of the input too, nothing is copied.
+ * The boundary is searched with the Boyer-Moore-Horspool algorithm.
+ * eg:
+ *   http::multipart_reader reader(boundary);
+ *   for (;;)
+ *   {
+ *       std::size_t consumed = 0;
+ *       http::error_code ec{};
+ *       auto ev = reader.parse(input, consumed, ec);
+ *       if (ec)
+ *           break;
+ *       // handle the event with reader.part() or reader.data(), then remove the consumed
+ *       // bytes from the front of the input, and append more data when the event is need_more.
+ *   }
+ */
+class multipart_reader
+{
+public:
+	enum class event : std::uint8_t
+	{
+		need_more,  // more data is required, the consumed bytes must be removed first
+		part_begin, // the headers of a part are parsed, see part()
+		part_data,  // some data of the part body, see data()
+		part_end,   // the part body is finished
+		done,       // the close delimiter is reached, the remaining data is the epilogue
+	};
+
+	/**
+	 * @brief Constructor
+	 * @param boundary - The boundary of the Content-Type, without the leading "--".
+	 * @param header_limit - The max size of the headers of a part.
+	 */
+	explicit multipart_reader(std::string_view boundary, std::size_t header_limit = 16 * 1024)
+		: header_limit_(header_limit)
+	{
+		this->delimiter_.reserve(boundary.size() + 4);
+		this->delimiter_ += CRLF;
+		this->delimiter_ += "--";
+		this->delimiter_ += boundary;
+
+		std::size_t m = this->delimiter_.size();
 
-		std::string_view::size_type pos_row_1 = static_cast<std::string_view::size_type>( 0);
-		std::string_view::size_type pos_row_2 = static_cast<std::string_view::size_type>(-2);
+		this->skip_.fill(m);
 
-		for(;;)
+		for (std::size_t i = 0; i + 1 < m; ++i)
 		{
-			pos_row_1 = pos_row_2 + 2;
-			pos_row_2 = header.find("\r\n", pos_row_1);
+			this->skip_[static_cast<unsigned char>(this->delimiter_[i])] = m - 1 - i;
+		}
+	}
 
-			std::string_view header_row = header.substr(pos_row_1,
-				pos_row_2 == std::string_view::npos ? pos_row_2 : pos_row_2 - pos_row_1);
+	/**
+	 * @brief Parse the input until an event occurs.
+	 * @param input - The unconsumed data, the first byte must be the byte after the bytes which
+	 *                are consumed by the previous call.
+	 * @param consumed - The number of bytes which should be removed from the front of the input
+	 *                   after the event is handled.
+	 * @param ec - The error, the event should be ignored if the error is set.
+	 */
+	event parse(std::string_view input, std::size_t& consumed, error_code& ec)
+	{
+		consumed = 0;
 
-			// find the header type name.
-			auto pos1 = header_row.find(':');
-			if (pos1 == std::string_view::npos)
-				return false;
+		ec = {};
 
-			// get the header type value.
-			std::string_view type = header_row.substr(0, pos1);
-			asio::trim_both(type);
+		this->data_ = {};
 
-			++pos1;
+		for (;;)
+		{
+			std::string_view s = input.substr(consumed);
 
-			if /**/(beast::iequals(type, "Content-Disposition"))
+			switch (this->state_)
+			{
+			case state::start:
 			{
-				auto pos2 = header_row.find(';', pos1);
+				// the first boundary may be at the very beginning without the leading CRLF
+				std::string_view dash_boundary = std::string_view(this->delimiter_).substr(2);
 
-				std::string_view disposition = header_row.substr(pos1, pos2 == std::string_view::npos ? pos2 : pos2 - pos1);
-				asio::trim_both(disposition);
-				field.content_disposition(disposition);
+				if (s.size() < dash_boundary.size() && dash_boundary.starts_with(s))
+					return event::need_more;
 
-				if (pos2 != std::string_view::npos)
+				if (s.starts_with(dash_boundary))
 				{
-					std::string_view kvs = header_row.substr(pos2 + 1);
+					consumed += dash_boundary.size();
+					this->state_ = state::boundary_line;
+				}
+				else
+				{
+					this->state_ = state::preamble;
+				}
+			}
+			break;
+			case state::preamble:
+			{
+				std::size_t pos = this->find_delimiter(s);
 
-					for (pos2 = 0;;)
-					{
-						auto pos3 = kvs.find(';', pos2);
+				if (pos == std::string_view::npos)
+				{
+					consumed += this->safe_length(s);
+					return event::need_more;
+				}
 
-						std::string_view kv = kvs.substr(pos2, pos3 == std::string_view::npos ? pos3 : pos3 - pos2);
+				consumed += pos + this->delimiter_.size();
+				this->state_ = state::boundary_line;
+			}
+			break;
+			case state::boundary_line:
+			{
+				if (s.size() < 2)
+					return event::need_more;
 
-						auto pos4 = kv.find('=');
-						if (pos4 == std::string_view::npos)
-							return false;
+				if (s.starts_with("--"))
+				{
+					consumed = input.size();
+					this->state_ = state::done;
+					return event::done;
+				}
 
-						std::string_view k = kv.substr(0, pos4);
-						std::string_view v = kv.substr(pos4 + 1);
+				// the transport padding is allowed before the CRLF
+				std::size_t pos = s.find_first_not_of(" \t");
 
-						asio::trim_both(k);
-						asio::trim_both(v);
+				if (pos == std::string_view::npos || pos + 1 >= s.size())
+				{
+					if (s.size() > this->header_limit_)
+						ec = http::error::header_limit;
+					return event::need_more;
+				}
 
-						if (!v.empty() && v.front() == '\"') v.remove_prefix(1);
-						if (!v.empty() && v.back()  == '\"') v.remove_suffix(1);
+				if (s[pos] != CR || s[pos + 1] != LF)
+				{
+					ec = http::error::bad_line_ending;
+					return event::need_more;
+				}
 
-						if /**/ (beast::iequals(k, "name"))
-							field.name(v);
-						else if (beast::iequals(k, "filename"))
-							field.filename(v);
+				consumed += pos + 2;
+				this->state_ = state::header;
+			}
+			break;
+			case state::header:
+			{
+				std::string_view header;
 
-						if (pos3 == std::string_view::npos)
-							break;
+				if (s.starts_with(CRLF))
+				{
+					consumed += 2;
+				}
+				else
+				{
+					std::size_t pos = s.find("\r\n\r\n");
 
-						pos2 = pos3 + 1;
+					if (pos == std::string_view::npos || pos > this->header_limit_)
+					{
+						if (s.size() > this->header_limit_)
+							ec = http::error::header_limit;
+						return event::need_more;
 					}
+
+					header = s.substr(0, pos);
+					consumed += pos + 4;
 				}
+
+				if (!multipart_parser::parse_header(this->part_, header))
+				{
+					ec = http::error::bad_field;
+					return event::need_more;
+				}
+
+				this->state_ = state::body;
+				return event::part_begin;
 			}
-			else if (beast::iequals(type, "Content-Type"))
+			case state::body:
 			{
-				field.content_type(header_row.substr(pos1 + 1));
+				std::size_t pos = this->find_delimiter(s);
+
+				if (pos == 0)
+				{
+					consumed += this->delimiter_.size();
+					this->state_ = state::boundary_line;
+					return event::part_end;
+				}
+
+				std::size_t n = (pos == std::string_view::npos ? this->safe_length(s) : pos);
+
+				if (n == 0)
+					return event::need_more;
+
+				this->data_ = s.substr(0, n);
+				consumed += n;
+				return event::part_data;
 			}
-			else if (beast::iequals(type, "Content-Transfer-Encoding"))
+			case state::done:
 			{
-				field.content_transfer_encoding(header_row.substr(pos1 + 1));
+				consumed = input.size();
+				return event::done;
 			}
-			else
-			{
-				assert(false);
 			}
+		}
+	}
 
-			if (pos_row_2 == std::string_view::npos)
-				break;
+	/**
+	 * @brief Returns the headers of the current part, valid after the part_begin event.
+	 */
+	inline const multipart_part_header& part() const noexcept { return this->part_; }
+
+	/**
+	 * @brief Returns the body data of the current part, valid after the part_data event.
+	 */
+	inline std::string_view data() const noexcept { return this->data_; }
+
+	/**
+	 * @brief Returns true if the close delimiter is reached.
+	 */
+	inline bool is_done() const noexcept { return this->state_ == state::done; }
+
+protected:
+	/*
+	 * Boyer-Moore-Horspool search of the delimiter "\r\n--boundary".
+	 */
+	std::size_t find_delimiter(std::string_view s) const noexcept
+	{
+		const std::size_t m = this->delimiter_.size();
+
+		if (s.size() < m)
+			return std::string_view::npos;
+
+		const char* p = s.data();
+		const char* d = this->delimiter_.data();
+
+		for (std::size_t i = 0, last = s.size() - m; i <= last;)
+		{
+			unsigned char c = static_cast<unsigned char>(p[i + m - 1]);
+
+			if (c == static_cast<unsigned char>(d[m - 1]) && std::memcmp(p + i, d, m - 1) == 0)
+				return i;
+
+			i += this->skip_[c];
 		}
 
-		field.value(value);
+		return std::string_view::npos;
+	}
 
-		return true;
+	/*
+	 * Returns the length of the leading bytes which can't be a part of the delimiter, the
+	 * s must not contain the whole delimiter, only the tail may be a partial delimiter.
+	 */
+	std::size_t safe_length(std::string_view s) const noexcept
+	{
+		const std::size_t m = this->delimiter_.size();
+
+		std::size_t i = (s.size() > m - 1 ? s.size() - (m - 1) : 0);
+
+		for (; i < s.size(); ++i)
+		{
+			if (s[i] == CR && std::string_view(this->delimiter_).starts_with(s.substr(i)))
+				break;
+		}
+
+		return i;
 	}
-}
 
-template<class String = std::string>
-basic_multipart_fields<String> multipart_parser_execute(std::string_view body, std::string_view boundary)
+protected:
+	enum class state : std::uint8_t
+	{
+		start, preamble, boundary_line, header, body, done,
+	};
+
+	std::string                  delimiter_;
+
+	std::array<std::size_t, 256> skip_{};
+
+	std::size_t                  header_limit_ = 16 * 1024;
+
+	state                        state_ = state::start;
+
+	multipart_part_header        part_{};
+
+	std::string_view             data_{};
+};
+
+/**
+ * @brief The destination of the part body which is read by async_read_multipart.
+ */
+class multipart_sink
 {
-	using namespace multipart_parser;
+public:
+	virtual ~multipart_sink() = default;
 
-	basic_multipart_fields<String> fields{};
+	/**
+	 * @brief Write some data of the part body.
+	 */
+	virtual asio::awaitable<error_code> async_write(std::string_view data) = 0;
 
-	fields.boundary(boundary);
+	/**
+	 * @brief Called when the part body is finished.
+	 */
+	virtual asio::awaitable<error_code> async_close()
+	{
+		co_return error_code{};
+	}
+};
 
-	std::string full_boundary{ "--" }; full_boundary += boundary;
+/**
+ * @brief The sink which drops the part body.
+ */
+class multipart_discard_sink final : public multipart_sink
+{
+public:
+	asio::awaitable<error_code> async_write(std::string_view) override
+	{
+		co_return error_code{};
+	}
+};
 
-	std::string_view bound = full_boundary;
+/**
+ * @brief The sink which appends the part body to the string, eg: the value of a text field.
+ */
+class multipart_memory_sink final : public multipart_sink
+{
+public:
+	explicit multipart_memory_sink(std::string& value,
+		std::size_t limit = (std::numeric_limits<std::size_t>::max)()) noexcept
+		: value_(value), limit_(limit)
+	{
+	}
 
-	for (std::size_t i = 0; i < body.size();)
+	asio::awaitable<error_code> async_write(std::string_view data) override
 	{
-		basic_multipart_field<String> field{};
+		if (data.size() > this->limit_ - this->value_.size())
+			co_return http::error::body_limit;
 
-		// find first boundary
-		if (body.substr(i, bound.size()) != bound)
-			break;
+		this->value_ += data;
+
+		co_return error_code{};
+	}
+
+protected:
+	std::string& value_;
+
+	std::size_t  limit_;
+};
+
+/**
+ * @brief The sink which writes the part body to the file, eg: the uploaded file, the file is
+ * created by the first write and truncated if it exists already.
+ */
+class multipart_file_sink final : public multipart_sink
+{
+public:
+	explicit multipart_file_sink(std::string filepath,
+		std::uint64_t limit = (std::numeric_limits<std::uint64_t>::max)())
+		: filepath_(std::move(filepath)), limit_(limit)
+	{
+	}
 
-		i += bound.size();
+	asio::awaitable<error_code> async_write(std::string_view data) override
+	{
+		if (data.size() > this->limit_ - this->size_)
+			co_return http::error::body_limit;
 
-		// check whether is the end.
-		std::string_view tail = body.substr(i + 0, 2);
-		if (tail == "--")
+		if (!this->file_)
 		{
-			i += 2;
+			auto [ec, file, n] = co_await asio::async_write_file(this->filepath_, asio::buffer(data));
 
-			if (i < body.size())
-			{
-				if (body[i] != CR)
-					break;
-				++i;
-			}
-			if (i < body.size())
-			{
-				if (body[i] != LF)
-					break;
-				++i;
-			}
+			this->size_ += n;
 
-			break;
+			if (!ec)
+				this->file_.emplace(std::move(file));
+
+			co_return ec;
 		}
 
-		// find next boundary
-		auto next = body.find(bound, i);
-		if (next == std::string_view::npos)
-			break;
+		auto [ec, n] = co_await asio::async_write(*this->file_, asio::buffer(data), asio::use_nothrow_awaitable);
 
-		// field.
-		std::string_view field_content = body.substr(i, next - i);
-		if (!parse_field(field, field_content))
-			break;
+		this->size_ += n;
+
+		co_return ec;
+	}
+
+	asio::awaitable<error_code> async_close() override
+	{
+		error_code ec{};
+
+		// the empty part, create the empty file.
+		if (!this->file_)
+		{
+			auto [e1, file, n] = co_await asio::async_write_file(this->filepath_, asio::const_buffer());
+
+			file.close(ec);
+
+			co_return e1;
+		}
 
-		fields.insert(std::move(field));
+		this->file_->close(ec);
 
-		i = next;
+		co_return ec;
 	}
 
-	return fields;
-}
+	/**
+	 * @brief Returns the number of bytes which have been written.
+	 */
+	inline std::uint64_t size() const noexcept { return this->size_; }
 
-template<bool isRequest, class Body, class Fields, class String = std::string>
-basic_multipart_fields<String> multipart_parser_execute(const http::message<isRequest, Body, Fields>& msg)
-{
-	std::string_view type = msg[http::field::content_type];
+	/**
+	 * @brief Returns the file path.
+	 */
+	inline const std::string& filepath() const noexcept { return this->filepath_; }
 
+protected:
+	std::string                      filepath_;
+
+	std::optional<asio::stream_file> file_;
+
+	std::uint64_t                    size_ = 0;
+
+	std::uint64_t                    limit_;
+};
+
+/**
+ * @brief Get the boundary of the Content-Type "multipart/form-data; boundary=...", or empty if
+ * the Content-Type is not multipart/form-data.
+ */
+inline std::string_view multipart_boundary(std::string_view type)
+{
 	std::size_t pos1 = asio::ifind(type, "multipart/form-data");
 	if (pos1 == std::string_view::npos)
 		return {};
@@ -629,7 +1029,177 @@ basic_multipart_fields<String> multipart_parser_execute(const http::message<isRe
 
 	std::string_view boundary = type.substr(pos1, pos2 == std::string_view::npos ? pos2 : pos2 - pos1);
 
-	return multipart_parser_execute<String>(msg.body(), boundary);
+	asio::trim_both(boundary);
+
+	if (boundary.size() >= 2 && boundary.front() == '\"' && boundary.back() == '\"')
+	{
+		boundary.remove_prefix(1);
+		boundary.remove_suffix(1);
+	}
+
+	return boundary;
+}
+
+/**
+ * @brief Read the "multipart/form-data" body from the body reader, the body of each part is
+ * streamed to the sink which is returned by the handler, the whole body is never buffered.
+ * @param body - The body reader of the streaming route.
+ * @param boundary - The boundary, see multipart_boundary.
+ * @param on_part - `std::unique_ptr<http::multipart_sink>(const http::multipart_part_header& part)`,
+ *                  the views of the part are only valid during the call, returns nullptr to
+ *                  discard the part.
+ * eg:
+ *   auto ec = co_await http::async_read_multipart(body, http::multipart_boundary(
+ *       req[http::field::content_type]), [&](const http::multipart_part_header& part)
+ *       -> std::unique_ptr<http::multipart_sink>
+ *   {
+ *       if (part.filename.empty())
+ *           return std::make_unique<http::multipart_memory_sink>(fields[std::string(part.name)], 4096);
+ *       return std::make_unique<http::multipart_file_sink>(make_upload_path(part.filename));
+ *   });
+ */
+template<class PartHandler>
+asio::awaitable<error_code> async_read_multipart(
+	http::body_reader& body, std::string_view boundary, PartHandler on_part,
+	std::size_t buffer_size = 64 * 1024, std::size_t header_limit = 16 * 1024)
+{
+	if (boundary.empty())
+		co_return http::error::bad_field;
+
+	multipart_reader reader(boundary, header_limit);
+
+	std::unique_ptr<multipart_sink> sink;
+
+	std::string buffer;
+
+	buffer.resize((std::max)(buffer_size, header_limit + boundary.size() + 8));
+
+	std::size_t pos = 0, len = 0;
+
+	for (;;)
+	{
+		std::size_t consumed = 0;
+
+		error_code ec{};
+
+		auto ev = reader.parse(std::string_view(buffer.data() + pos, len - pos), consumed, ec);
+
+		if (ec)
+			co_return ec;
+
+		switch (ev)
+		{
+		case multipart_reader::event::part_begin:
+			sink = on_part(reader.part());
+			if (!sink)
+				sink = std::make_unique<multipart_discard_sink>();
+			break;
+		case multipart_reader::event::part_data:
+			ec = co_await sink->async_write(reader.data());
+			break;
+		case multipart_reader::event::part_end:
+			ec = co_await sink->async_close();
+			sink.reset();
+			break;
+		case multipart_reader::event::done:
+			// drain the epilogue, so the connection can be reused.
+			while (!body.is_done())
+			{
+				auto [e1, n1] = co_await body.async_read_some(asio::buffer(buffer));
+				if (e1 || n1 == 0)
+					break;
+			}
+			co_return error_code{};
+		case multipart_reader::event::need_more:
+		{
+			pos += consumed;
+			consumed = 0;
+
+			if (pos > 0)
+			{
+				std::memmove(buffer.data(), buffer.data() + pos, len - pos);
+				len -= pos;
+				pos = 0;
+			}
+
+			if (len == buffer.size())
+				buffer.resize(buffer.size() * 2);
+
+			auto [e1, n1] = co_await body.async_read_some(asio::buffer(buffer.data() + len, buffer.size() - len));
+			if (e1)
+				co_return e1;
+			if (n1 == 0)
+				co_return http::error::partial_message;
+
+			len += n1;
+		}
+		break;
+		}
+
+		if (ec)
+			co_return ec;
+
+		pos += consumed;
+	}
+}
+
+/*
+ * Parse the whole "multipart/form-data" body, if the String is std::string_view, the fields
+ * are the views of the body, nothing is copied.
+ */
+template<class String = std::string>
+basic_multipart_fields<String> multipart_parser_execute(std::string_view body, std::string_view boundary)
+{
+	basic_multipart_fields<String> fields{};
+
+	fields.boundary(boundary);
+
+	if (boundary.empty())
+		return fields;
+
+	// the whole body is in the memory already, so the headers is limited by the body only.
+	multipart_reader reader(boundary, body.size());
+
+	basic_multipart_field<String> field{};
+
+	for (;;)
+	{
+		std::size_t consumed = 0;
+
+		error_code ec{};
+
+		auto ev = reader.parse(body, consumed, ec);
+
+		if (ec || ev == multipart_reader::event::need_more || ev == multipart_reader::event::done)
+			break;
+
+		switch (ev)
+		{
+		case multipart_reader::event::part_begin:
+			field = {};
+			multipart_parser::assign_field(field, reader.part());
+			break;
+		case multipart_reader::event::part_data:
+			// the delimiter is always found in the whole body, so the data is the whole value.
+			field.value(reader.data());
+			break;
+		case multipart_reader::event::part_end:
+			fields.insert(std::move(field));
+			break;
+		default:
+			break;
+		}
+
+		body.remove_prefix(consumed);
+	}
+
+	return fields;
+}
+
+template<class String = std::string, bool isRequest, class Body, class Fields>
+basic_multipart_fields<String> multipart_parser_execute(const http::message<isRequest, Body, Fields>& msg)
+{
+	return multipart_parser_execute<String>(msg.body(), multipart_boundary(msg[http::field::content_type]));
 }
 
 #undef CRLF
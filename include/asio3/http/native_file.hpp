@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2017-2023 zhllxt
+ *
+ * author   : zhllxt
+ * email    : 37792738@qq.com
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include <asio3/core/beast.hpp>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef ASIO3_HEADER_ONLY
+namespace bho::beast::http
+#else
+namespace boost::beast::http
+#endif
+{
+#if defined(__unix__) || defined(__APPLE__)
+	/**
+	 * @brief A file which meets the requirements of the beast File, it holds a file descriptor,
+	 * so the body of the file can be sent by the kernel with sendfile (the file of the header
+	 * only beast is implemented with std::fstream which has no descriptor).
+	 */
+	class posix_file
+	{
+	public:
+		using native_handle_type = int;
+
+		posix_file() = default;
+
+		posix_file(posix_file&& other) noexcept : fd_(std::exchange(other.fd_, -1))
+		{
+		}
+
+		posix_file& operator=(posix_file&& other) noexcept
+		{
+			if (this != &other)
+			{
+				error_code ec{};
+				this->close(ec);
+				this->fd_ = std::exchange(other.fd_, -1);
+			}
+			return *this;
+		}
+
+		~posix_file()
+		{
+			error_code ec{};
+			this->close(ec);
+		}
+
+		inline native_handle_type native_handle() const noexcept
+		{
+			return this->fd_;
+		}
+
+		inline void native_handle(native_handle_type fd)
+		{
+			error_code ec{};
+			this->close(ec);
+			this->fd_ = fd;
+		}
+
+		inline bool is_open() const noexcept
+		{
+			return this->fd_ != -1;
+		}
+
+		inline void close(error_code& ec)
+		{
+			ec = {};
+
+			if (this->fd_ == -1)
+				return;
+
+			if (::close(std::exchange(this->fd_, -1)) != 0)
+				ec.assign(errno, system_category());
+		}
+
+		inline void open(char const* path, file_mode mode, error_code& ec)
+		{
+			this->close(ec);
+
+			int f = O_CLOEXEC;
+
+			switch (mode)
+			{
+			default:
+			case file_mode::read:
+			case file_mode::scan:            f |= O_RDONLY; break;
+			case file_mode::write:           f |= O_RDWR | O_CREAT | O_TRUNC; break;
+			case file_mode::write_new:       f |= O_RDWR | O_CREAT | O_EXCL; break;
+			case file_mode::write_existing:  f |= O_RDWR; break;
+			case file_mode::append:          f |= O_WRONLY | O_CREAT | O_APPEND; break;
+			case file_mode::append_existing: f |= O_WRONLY | O_APPEND; break;
+			}
+
+			for (;;)
+			{
+				this->fd_ = ::open(path, f, 0644);
+				if (this->fd_ != -1)
+					break;
+
+				if (errno != EINTR)
+				{
+					ec.assign(errno, system_category());
+					return;
+				}
+			}
+
+		#if defined(POSIX_FADV_SEQUENTIAL)
+			if (mode == file_mode::scan)
+				::posix_fadvise(this->fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+		#endif
+
+			ec = {};
+		}
+
+		inline std::uint64_t size(error_code& ec) const
+		{
+			if (this->fd_ == -1)
+			{
+				ec = make_error_code(errc::bad_file_descriptor);
+				return 0;
+			}
+
+			struct stat st {};
+			if (::fstat(this->fd_, &st) != 0)
+			{
+				ec.assign(errno, system_category());
+				return 0;
+			}
+
+			ec = {};
+			return static_cast<std::uint64_t>(st.st_size);
+		}
+
+		inline std::uint64_t pos(error_code& ec) const
+		{
+			if (this->fd_ == -1)
+			{
+				ec = make_error_code(errc::bad_file_descriptor);
+				return 0;
+			}
+
+			auto r = ::lseek(this->fd_, 0, SEEK_CUR);
+			if (r == off_t(-1))
+			{
+				ec.assign(errno, system_category());
+				return 0;
+			}
+
+			ec = {};
+			return static_cast<std::uint64_t>(r);
+		}
+
+		inline void seek(std::uint64_t offset, error_code& ec)
+		{
+			if (this->fd_ == -1)
+			{
+				ec = make_error_code(errc::bad_file_descriptor);
+				return;
+			}
+
+			if (::lseek(this->fd_, static_cast<off_t>(offset), SEEK_SET) == off_t(-1))
+			{
+				ec.assign(errno, system_category());
+				return;
+			}
+
+			ec = {};
+		}
+
+		inline std::size_t read(void* buffer, std::size_t n, error_code& ec) const
+		{
+			if (this->fd_ == -1)
+			{
+				ec = make_error_code(errc::bad_file_descriptor);
+				return 0;
+			}
+
+			std::size_t nread = 0;
+			while (n > 0)
+			{
+				auto r = ::read(this->fd_, static_cast<char*>(buffer) + nread, n);
+				if (r == -1)
+				{
+					if (errno == EINTR)
+						continue;
+					ec.assign(errno, system_category());
+					return nread;
+				}
+				if (r == 0)
+					break;
+				n -= static_cast<std::size_t>(r);
+				nread += static_cast<std::size_t>(r);
+			}
+
+			ec = {};
+			return nread;
+		}
+
+		inline std::size_t write(void const* buffer, std::size_t n, error_code& ec)
+		{
+			if (this->fd_ == -1)
+			{
+				ec = make_error_code(errc::bad_file_descriptor);
+				return 0;
+			}
+
+			std::size_t nwritten = 0;
+			while (n > 0)
+			{
+				auto r = ::write(this->fd_, static_cast<char const*>(buffer) + nwritten, n);
+				if (r == -1)
+				{
+					if (errno == EINTR)
+						continue;
+					ec.assign(errno, system_category());
+					return nwritten;
+				}
+				n -= static_cast<std::size_t>(r);
+				nwritten += static_cast<std::size_t>(r);
+			}
+
+			ec = {};
+			return nwritten;
+		}
+
+	protected:
+		int fd_ = -1;
+	};
+
+	using native_file = posix_file;
+#else
+	using native_file = beast::file;
+#endif
+
+	/**
+	 * @brief The file body which is used by the make_native_file_response.
+	 */
+	using native_file_body = http::basic_file_body<native_file>;
+
+	template<class BodyT>
+	inline constexpr bool is_file_body_v = false;
+
+	template<class FileT>
+	inline constexpr bool is_file_body_v<http::basic_file_body<FileT>> = true;
+
+	// whether the body is a file body which holds a file descriptor.
+	template<class BodyT>
+	inline constexpr bool is_descriptor_file_body_v = false;
+
+	template<class FileT>
+	inline constexpr bool is_descriptor_file_body_v<http::basic_file_body<FileT>> =
+		std::is_same_v<typename FileT::native_handle_type, int>;
+}
@@ -29,6 +29,7 @@
 #include <asio3/http/url.hpp>
 #include <asio3/http/read.hpp>
 #include <asio3/http/write.hpp>
+#include <asio3/http/compress.hpp>
 
 #include <asio3/proxy/handshake.hpp>
 
@@ -50,6 +51,8 @@ namespace boost::beast::http
 		http::verb method = http::verb::get;
 		std::chrono::steady_clock::duration timeout = asio::http_request_timeout;
 		std::optional<socks5::option> socks5_option;
+		// Ask for the compressed response, and decompress the gzip or deflate encoded body.
+		bool decompress = true;
 		std::optional<std::reference_wrapper<asio::ip::tcp::socket>> socket;
 	#if defined(ASIO3_ENABLE_SSL) || defined(ASIO3_USE_SSL)
 		std::optional<std::reference_wrapper<asio::ssl::stream<asio::ip::tcp::socket&>>> stream;
@@ -215,6 +218,10 @@ namespace boost::beast::http
 			req.set(http::field::user_agent,
 				"Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/105.0.0.0 Safari/537.36");
 		}
+		if (opt.decompress && req.find(http::field::accept_encoding) == req.end())
+		{
+			req.set(http::field::accept_encoding, "gzip, deflate");
+		}
 
 		if (asio::iequals(url.get_schema(), "https"))
 		{
@@ -333,6 +340,13 @@ namespace boost::beast::http
 			}
 		}
 
+		if (opt.decompress)
+		{
+			http::decompress_body(resp, ec);
+			if (ec)
+				co_return std::tuple{ ec, std::move(resp) };
+		}
+
 		co_return std::tuple{ error_code{}, std::move(resp) };
     }
 }
@@ -466,6 +480,10 @@ namespace boost::beast::http::detail
 				req.set(http::field::user_agent,
 					"Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/105.0.0.0 Safari/537.36");
 			}
+			if (opt.decompress && req.find(http::field::accept_encoding) == req.end())
+			{
+				req.set(http::field::accept_encoding, "gzip, deflate");
+			}
 
 			if (asio::iequals(url.get_schema(), "https"))
 			{
@@ -554,6 +572,13 @@ namespace boost::beast::http::detail
 					co_return{ e6, std::move(resp) };
 			}
 
+			if (opt.decompress)
+			{
+				http::decompress_body(resp, ec);
+				if (ec)
+					co_return{ ec, std::move(resp) };
+			}
+
 			co_return{ error_code{}, std::move(resp) };
         }
 	};
@@ -0,0 +1,792 @@
+/*
+ * Copyright (c) 2017-2023 zhllxt
+ *
+ * author   : zhllxt
+ * email    : 37792738@qq.com
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <array>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <charconv>
+#include <type_traits>
+
+#include <asio3/config.hpp>
+
+#include <asio3/core/strutil.hpp>
+#include <asio3/core/hash.hpp>
+
+#include <asio3/http/core.hpp>
+
+#ifdef ASIO3_HEADER_ONLY
+namespace bho::beast::http
+#else
+namespace boost::beast::http
+#endif
+{
+	struct path_param
+	{
+		std::string_view name;
+		std::string_view value;
+	};
+
+	/**
+	 * @brief The values captured by the ":param" and "*tail" segments of a route.
+	 * The names and values are views into the route tree and the request target, so the
+	 * object is only valid during the router function call, and it can't be copied.
+	 */
+	template<std::size_t Capacity>
+	class basic_path_params
+	{
+	public:
+		using value_type = path_param;
+		using const_iterator = const value_type*;
+
+		basic_path_params() = default;
+		~basic_path_params() = default;
+
+		basic_path_params(const basic_path_params&) = delete;
+		basic_path_params& operator=(const basic_path_params&) = delete;
+
+		inline bool push_back(std::string_view name, std::string_view value) noexcept
+		{
+			if (this->size_ == Capacity)
+				return false;
+
+			this->items_[this->size_++] = path_param{ name, value };
+			return true;
+		}
+
+		inline void clear() noexcept
+		{
+			this->size_ = 0;
+		}
+
+		[[nodiscard]] inline std::size_t size() const noexcept
+		{
+			return this->size_;
+		}
+
+		[[nodiscard]] inline bool empty() const noexcept
+		{
+			return this->size_ == 0;
+		}
+
+		[[nodiscard]] inline const_iterator begin() const noexcept
+		{
+			return this->items_.data();
+		}
+
+		[[nodiscard]] inline const_iterator end() const noexcept
+		{
+			return this->items_.data() + this->size_;
+		}
+
+		[[nodiscard]] inline bool contains(std::string_view name) const noexcept
+		{
+			return this->find(name) != this->end();
+		}
+
+		/**
+		 * @brief Get the captured value of the name, return empty string if not found.
+		 */
+		[[nodiscard]] inline std::string_view operator[](std::string_view name) const noexcept
+		{
+			auto it = this->find(name);
+			return it == this->end() ? std::string_view{} : it->value;
+		}
+
+		/**
+		 * @brief Get the captured value by the position of the segment in the route.
+		 */
+		[[nodiscard]] inline std::string_view at(std::size_t index) const noexcept
+		{
+			return index < this->size_ ? this->items_[index].value : std::string_view{};
+		}
+
+		/**
+		 * @brief Get the captured value of the name as the type T.
+		 * T can be std::string_view, std::string, bool, or an integer or floating point type.
+		 * @return empty if the name is not found or the value can't be converted to T.
+		 */
+		template<class T>
+		[[nodiscard]] inline std::optional<T> get(std::string_view name) const noexcept(
+			!std::is_same_v<T, std::string>)
+		{
+			auto it = this->find(name);
+			if (it == this->end())
+				return std::nullopt;
+
+			return convert<T>(it->value);
+		}
+
+		/**
+		 * @brief The buffer which holds the decoded path when the target is percent encoded.
+		 */
+		inline std::string& decoded_path() noexcept
+		{
+			return this->decoded_path_;
+		}
+
+	protected:
+		inline const_iterator find(std::string_view name) const noexcept
+		{
+			for (auto it = this->begin(); it != this->end(); ++it)
+			{
+				if (it->name == name)
+					return it;
+			}
+			return this->end();
+		}
+
+		template<class T>
+		static inline std::optional<T> convert(std::string_view v)
+		{
+			if /**/ constexpr (std::is_same_v<T, std::string_view>)
+			{
+				return v;
+			}
+			else if constexpr (std::is_same_v<T, std::string>)
+			{
+				return std::string(v);
+			}
+			else if constexpr (std::is_same_v<T, bool>)
+			{
+				if (v == "1" || asio::iequals(v, std::string_view{ "true" }))
+					return true;
+				if (v == "0" || asio::iequals(v, std::string_view{ "false" }))
+					return false;
+				return std::nullopt;
+			}
+			else
+			{
+				static_assert(std::is_arithmetic_v<T>, "Unsupported path parameter type");
+
+				T value{};
+				auto [p, ec] = std::from_chars(v.data(), v.data() + v.size(), value);
+				if (ec != std::errc{} || p != v.data() + v.size())
+					return std::nullopt;
+				return value;
+			}
+		}
+
+	protected:
+		std::array<path_param, Capacity> items_{};
+
+		std::size_t                      size_ = 0;
+
+		std::string                      decoded_path_;
+	};
+
+	using path_params = basic_path_params<8>;
+
+	/**
+	 * @brief A compressed radix tree which maps the route patterns to the values.
+	 * The pattern segments can be:
+	 *   static text   : "/user/list"
+	 *   ":name"       : matches one whole path segment, eg: "/user/:id"
+	 *   "*" "*name"   : at the end of the pattern, matches the rest of the path, include the '/'
+	 *   "*" in middle : matches one whole path segment as an unnamed parameter
+	 * When a path can be matched by several routes, the static text takes precedence over
+	 * the ":param", and the ":param" takes precedence over the "*tail".
+	 * The match is allocation free, and the cost is proportional to the length of the path.
+	 */
+	template<class T>
+	class basic_route_tree
+	{
+	protected:
+		struct node
+		{
+			// the edge label of the static node
+			std::string                        prefix;
+
+			// the first char of the prefix of each static child, for fast child lookup
+			std::string                        indices;
+
+			std::vector<std::unique_ptr<node>> children;
+
+			std::unique_ptr<node>              param;
+
+			std::unique_ptr<node>              catch_all;
+
+			// the names of the captured values of the route which ends at this node
+			std::vector<std::string>           names;
+
+			std::optional<T>                   value;
+		};
+
+		enum class token_kind : std::uint8_t { text, param, catch_all };
+
+		struct token
+		{
+			token_kind       kind;
+			std::string_view text;
+		};
+
+	public:
+		using value_type = T;
+
+		basic_route_tree() : root_(std::make_unique<node>())
+		{
+		}
+
+		~basic_route_tree() = default;
+
+		basic_route_tree(basic_route_tree&&) noexcept = default;
+		basic_route_tree& operator=(basic_route_tree&&) noexcept = default;
+
+		/**
+		 * @brief Insert a route pattern.
+		 * @return The pointer to the stored value, or nullptr if the pattern exists already.
+		 */
+		inline T* insert(std::string_view pattern, T value)
+		{
+			std::vector<token> tokens = tokenize(pattern);
+
+			node* n = this->root_.get();
+			std::vector<std::string> names;
+
+			for (const token& tok : tokens)
+			{
+				switch (tok.kind)
+				{
+				case token_kind::text:
+					n = insert_text(n, tok.text);
+					break;
+				case token_kind::param:
+					if (!n->param)
+						n->param = std::make_unique<node>();
+					n = n->param.get();
+					names.emplace_back(tok.text);
+					break;
+				case token_kind::catch_all:
+					if (!n->catch_all)
+						n->catch_all = std::make_unique<node>();
+					n = n->catch_all.get();
+					names.emplace_back(tok.text);
+					break;
+				}
+			}
+
+			if (n->value.has_value())
+				return nullptr;
+
+			n->names = std::move(names);
+			n->value.emplace(std::move(value));
+
+			++this->size_;
+
+			return std::addressof(n->value.value());
+		}
+
+		/**
+		 * @brief Find the value of the route which matches the path, and capture the values of
+		 * the parameters into the params.
+		 * @return The pointer to the value, or nullptr if not found.
+		 */
+		template<std::size_t Capacity>
+		inline T* match(std::string_view path, basic_path_params<Capacity>& params)
+		{
+			captures<Capacity> caps{};
+
+			node* n = do_match(*this->root_, path, caps);
+			if (!n)
+				return nullptr;
+
+			std::size_t count = (std::min)(caps.count, (std::min)(Capacity, n->names.size()));
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				params.push_back(n->names[i], caps.values[i]);
+			}
+
+			return std::addressof(n->value.value());
+		}
+
+		/**
+		 * @brief Find the value of the route which is exactly equal to the pattern.
+		 */
+		inline T* find_exact(std::string_view pattern)
+		{
+			std::vector<token> tokens = tokenize(pattern);
+
+			node* n = this->root_.get();
+
+			for (const token& tok : tokens)
+			{
+				if (!n)
+					return nullptr;
+
+				switch (tok.kind)
+				{
+				case token_kind::text:
+					n = find_text(n, tok.text);
+					break;
+				case token_kind::param:
+					n = n->param.get();
+					break;
+				case token_kind::catch_all:
+					n = n->catch_all.get();
+					break;
+				}
+			}
+
+			return (n && n->value.has_value()) ? std::addressof(n->value.value()) : nullptr;
+		}
+
+		/**
+		 * @brief Call the function for each static route (no ":param" and "*tail" segments).
+		 * The signature of the function is: void(std::string_view path, T& value)
+		 */
+		template<class Function>
+		inline void for_each_static(Function&& f)
+		{
+			std::string path;
+			do_for_each_static(*this->root_, path, f);
+		}
+
+		[[nodiscard]] inline std::size_t size() const noexcept
+		{
+			return this->size_;
+		}
+
+		[[nodiscard]] inline bool empty() const noexcept
+		{
+			return this->size_ == 0;
+		}
+
+	protected:
+		template<class Function>
+		static void do_for_each_static(node& n, std::string& path, Function& f)
+		{
+			std::size_t len = path.size();
+
+			path += n.prefix;
+
+			if (n.value.has_value())
+				f(std::string_view(path), n.value.value());
+
+			for (auto& child : n.children)
+				do_for_each_static(*child, path, f);
+
+			path.resize(len);
+		}
+
+		template<std::size_t Capacity>
+		struct captures
+		{
+			std::array<std::string_view, Capacity> values{};
+			std::size_t count = 0;
+
+			inline void push(std::string_view v) noexcept
+			{
+				if (count < Capacity)
+					values[count] = v;
+				++count;
+			}
+
+			inline void pop() noexcept
+			{
+				--count;
+			}
+		};
+
+		static std::vector<token> tokenize(std::string_view pattern)
+		{
+			std::vector<token> tokens;
+
+			std::size_t text_begin = 0;
+
+			auto flush_text = [&](std::size_t end) mutable
+			{
+				if (end > text_begin)
+					tokens.emplace_back(token{ token_kind::text, pattern.substr(text_begin, end - text_begin) });
+			};
+
+			for (std::size_t i = 0; i < pattern.size(); ++i)
+			{
+				char c = pattern[i];
+
+				if (c == ':' && i > 0 && pattern[i - 1] == '/')
+				{
+					flush_text(i);
+					std::size_t end = (std::min)(pattern.find('/', i), pattern.size());
+					tokens.emplace_back(token{ token_kind::param, pattern.substr(i + 1, end - i - 1) });
+					text_begin = end;
+					i = end - 1;
+				}
+				else if (c == '*')
+				{
+					flush_text(i);
+					std::size_t end = (std::min)(pattern.find('/', i), pattern.size());
+					if (end == pattern.size())
+					{
+						tokens.emplace_back(token{ token_kind::catch_all, pattern.substr(i + 1) });
+					}
+					else
+					{
+						// a '*' in the middle of the pattern matches one path segment
+						tokens.emplace_back(token{ token_kind::param, std::string_view{} });
+					}
+					text_begin = end;
+					i = end - 1;
+				}
+			}
+
+			flush_text(pattern.size());
+
+			return tokens;
+		}
+
+		static inline std::size_t common_prefix(std::string_view a, std::string_view b) noexcept
+		{
+			std::size_t i = 0, n = (std::min)(a.size(), b.size());
+			while (i < n && a[i] == b[i])
+				++i;
+			return i;
+		}
+
+		static node* insert_text(node* n, std::string_view text)
+		{
+			while (!text.empty())
+			{
+				std::size_t pos = n->indices.find(text.front());
+				if (pos == std::string::npos)
+				{
+					auto child = std::make_unique<node>();
+					child->prefix = text;
+					node* p = child.get();
+					n->indices.push_back(text.front());
+					n->children.emplace_back(std::move(child));
+					return p;
+				}
+
+				node* child = n->children[pos].get();
+
+				std::size_t len = common_prefix(child->prefix, text);
+
+				if (len < child->prefix.size())
+				{
+					// split the child at the common prefix
+					auto mid = std::make_unique<node>();
+					mid->prefix = child->prefix.substr(0, len);
+					child->prefix.erase(0, len);
+					mid->indices.push_back(child->prefix.front());
+					mid->children.emplace_back(std::move(n->children[pos]));
+					n->children[pos] = std::move(mid);
+					child = n->children[pos].get();
+				}
+
+				n = child;
+				text.remove_prefix(len);
+			}
+
+			return n;
+		}
+
+		static node* find_text(node* n, std::string_view text) noexcept
+		{
+			while (n && !text.empty())
+			{
+				std::size_t pos = n->indices.find(text.front());
+				if (pos == std::string::npos)
+					return nullptr;
+
+				node* child = n->children[pos].get();
+				if (!text.starts_with(child->prefix))
+					return nullptr;
+
+				n = child;
+				text.remove_prefix(child->prefix.size());
+			}
+
+			return n;
+		}
+
+		template<std::size_t Capacity>
+		static node* do_match(node& n, std::string_view path, captures<Capacity>& caps) noexcept
+		{
+			if (path.empty())
+			{
+				if (n.value.has_value())
+					return std::addressof(n);
+
+				// "/files/*" matches "/files" when the "/" has been split into a child of its own,
+				// eg: by the "/filesystem" route.
+				if (std::size_t pos = n.indices.find('/'); pos != std::string::npos)
+				{
+					node& child = *n.children[pos];
+
+					if (child.prefix.size() == 1 && child.catch_all && child.catch_all->value.has_value())
+					{
+						caps.push(path);
+						return child.catch_all.get();
+					}
+				}
+			}
+			else
+			{
+				if (std::size_t pos = n.indices.find(path.front()); pos != std::string::npos)
+				{
+					node& child = *n.children[pos];
+
+					if (path.starts_with(child.prefix))
+					{
+						if (node* r = do_match(child, path.substr(child.prefix.size()), caps))
+							return r;
+					}
+					// "/files/*" matches "/files" because the trailing slashes are removed.
+					else if (child.catch_all && child.catch_all->value.has_value() &&
+						child.prefix.size() == path.size() + 1 &&
+						child.prefix.back() == '/' && std::string_view(child.prefix).starts_with(path))
+					{
+						caps.push(std::string_view{ path.data() + path.size(), 0 });
+						return child.catch_all.get();
+					}
+				}
+
+				if (n.param)
+				{
+					std::size_t end = (std::min)(path.find('/'), path.size());
+					if (end > 0)
+					{
+						caps.push(path.substr(0, end));
+
+						if (node* r = do_match(*n.param, path.substr(end), caps))
+							return r;
+
+						caps.pop();
+					}
+				}
+			}
+
+			if (n.catch_all && n.catch_all->value.has_value())
+			{
+				caps.push(path);
+				return n.catch_all.get();
+			}
+
+			return nullptr;
+		}
+
+	protected:
+		std::unique_ptr<node> root_;
+
+		std::size_t           size_ = 0;
+	};
+
+	/**
+	 * @brief A read only table of the static routes which is built with a perfect hash
+	 * function (the CHD algorithm), so the lookup is a single probe into a contiguous array.
+	 * The keys are hashed into a few buckets first, then for each bucket, from the biggest
+	 * one, a seed is searched so that all keys of the bucket fall into free slots. The lookup
+	 * rehashes the key with the seed of its bucket, and compares the key of the slot.
+	 * see: http://cmph.sourceforge.net/papers/esa09.pdf
+	 */
+	template<class T>
+	class basic_frozen_route_table
+	{
+	public:
+		struct entry
+		{
+			http::verb  method;
+			std::string path;
+			T           value;
+		};
+
+	protected:
+		struct slot
+		{
+			http::verb       method = http::verb::unknown;
+			std::string      path;
+			std::optional<T> value;
+		};
+
+	public:
+		using value_type = T;
+
+		basic_frozen_route_table() = default;
+		~basic_frozen_route_table() = default;
+
+		/**
+		 * @brief Build the table with the entries, the old content is discarded.
+		 */
+		inline void build(std::vector<entry> entries)
+		{
+			this->clear();
+
+			if (entries.empty())
+				return;
+
+			const std::size_t n = entries.size();
+
+			std::vector<std::uint64_t> hashes(n);
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				hashes[i] = hash_key(entries[i].method, entries[i].path);
+			}
+
+			// about 2 keys per bucket, and 20% empty slots to keep the seed search short.
+			std::size_t bucket_count = n / 2 + 1;
+			std::size_t slot_count = n + n / 4 + 1;
+
+			std::vector<std::size_t> positions(n);
+
+			for (;;)
+			{
+				if (this->try_build(hashes, bucket_count, slot_count, positions))
+					break;
+
+				slot_count += slot_count / 4 + 1;
+			}
+
+			this->slots_.resize(slot_count);
+
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				slot& s = this->slots_[positions[i]];
+				s.method = entries[i].method;
+				s.path = std::move(entries[i].path);
+				s.value.emplace(std::move(entries[i].value));
+			}
+
+			this->size_ = n;
+		}
+
+		/**
+		 * @brief Find the value of the method and path.
+		 * @return The pointer to the value, or nullptr if not found.
+		 */
+		inline T* find(http::verb method, std::string_view path) noexcept
+		{
+			if (this->size_ == 0)
+				return nullptr;
+
+			std::uint64_t h = hash_key(method, path);
+			std::uint32_t seed = this->seeds_[h % this->seeds_.size()];
+			slot& s = this->slots_[mix(h, seed) % this->slots_.size()];
+
+			if (s.value.has_value() && s.method == method && s.path == path)
+				return std::addressof(s.value.value());
+
+			return nullptr;
+		}
+
+		inline void clear() noexcept
+		{
+			this->seeds_.clear();
+			this->slots_.clear();
+			this->size_ = 0;
+		}
+
+		[[nodiscard]] inline std::size_t size() const noexcept
+		{
+			return this->size_;
+		}
+
+		[[nodiscard]] inline bool empty() const noexcept
+		{
+			return this->size_ == 0;
+		}
+
+	protected:
+		static inline std::uint64_t hash_key(http::verb method, std::string_view path) noexcept
+		{
+			std::uint64_t v = 14695981039346656037ull ^ static_cast<std::uint64_t>(method);
+			v *= 1099511628211ull;
+			return asio::detail::fnv1a_hash<std::uint64_t>(v,
+				reinterpret_cast<const unsigned char*>(path.data()), static_cast<std::uint64_t>(path.size()));
+		}
+
+		static inline std::uint64_t mix(std::uint64_t h, std::uint32_t seed) noexcept
+		{
+			// the finalizer of the murmurhash3
+			h ^= static_cast<std::uint64_t>(seed) * 0x9e3779b97f4a7c15ull;
+			h ^= h >> 33;
+			h *= 0xff51afd7ed558ccdull;
+			h ^= h >> 33;
+			h *= 0xc4ceb9fe1a85ec53ull;
+			h ^= h >> 33;
+			return h;
+		}
+
+		inline bool try_build(const std::vector<std::uint64_t>& hashes,
+			std::size_t bucket_count, std::size_t slot_count, std::vector<std::size_t>& positions)
+		{
+			std::vector<std::vector<std::size_t>> buckets(bucket_count);
+			for (std::size_t i = 0; i < hashes.size(); ++i)
+			{
+				buckets[hashes[i] % bucket_count].emplace_back(i);
+			}
+
+			std::vector<std::size_t> order(bucket_count);
+			for (std::size_t i = 0; i < bucket_count; ++i)
+				order[i] = i;
+
+			std::stable_sort(order.begin(), order.end(), [&buckets](std::size_t a, std::size_t b)
+			{
+				return buckets[a].size() > buckets[b].size();
+			});
+
+			this->seeds_.assign(bucket_count, 0);
+
+			std::vector<bool> occupied(slot_count, false);
+			std::vector<std::size_t> tried;
+
+			for (std::size_t b : order)
+			{
+				const auto& keys = buckets[b];
+				if (keys.empty())
+					break;
+
+				bool placed = false;
+
+				for (std::uint32_t seed = 1; seed < (1u << 16); ++seed)
+				{
+					tried.clear();
+
+					for (std::size_t k : keys)
+					{
+						std::size_t pos = mix(hashes[k], seed) % slot_count;
+						if (occupied[pos] || std::find(tried.begin(), tried.end(), pos) != tried.end())
+							break;
+						tried.emplace_back(pos);
+					}
+
+					if (tried.size() == keys.size())
+					{
+						for (std::size_t i = 0; i < keys.size(); ++i)
+						{
+							occupied[tried[i]] = true;
+							positions[keys[i]] = tried[i];
+						}
+						this->seeds_[b] = seed;
+						placed = true;
+						break;
+					}
+				}
+
+				if (!placed)
+					return false;
+			}
+
+			return true;
+		}
+
+	protected:
+		std::vector<std::uint32_t> seeds_;
+
+		std::vector<slot>          slots_;
+
+		std::size_t                size_ = 0;
+	};
+}
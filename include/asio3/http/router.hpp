@@ -35,11 +35,15 @@
 #include <asio3/core/stdutil.hpp>
 #include <asio3/core/netutil.hpp>
 #include <asio3/core/strutil.hpp>
+#include <asio3/core/admission_controller.hpp>
 
 #include <asio3/http/util.hpp>
+#include <asio3/http/body_reader.hpp>
 #include <asio3/http/cache.hpp>
 #include <asio3/http/make.hpp>
 #include <asio3/http/core.hpp>
+#include <asio3/http/route_tree.hpp>
+#include <asio3/http/single_flight.hpp>
 
 #ifdef ASIO3_HEADER_ONLY
 namespace bho::beast::http
@@ -101,13 +105,37 @@ namespace boost::beast::http
 
 		struct dummy {};
 
+		enum class aop_kind : std::uint8_t
+		{
+			none,
+			async_short, // asio::awaitable<bool> before(RequestT&, ResponseT&)
+			async_full,  // asio::awaitable<bool> before(RequestT&, ResponseT&, Ts...)
+			sync_short,  // bool before(RequestT&, ResponseT&)
+			sync_full,   // bool before(RequestT&, ResponseT&, Ts...)
+		};
+
 	public:
 		using self  = basic_router<RequestT, ResponseT, Ts...>;
 		using request_type = RequestT;
 		using response_type = ResponseT;
 		using return_type = asio::awaitable<bool>;
 		using function_type = std::function<return_type(RequestT&, ResponseT&, Ts...)>;
+		using params_type = http::path_params;
+		using handler_type = std::function<return_type(RequestT&, ResponseT&, const params_type&, http::body_reader*, Ts...)>;
+
+		struct route_type
+		{
+			handler_type handler;
+
+			// whether the route function pulls the request body by the http::body_reader.
+			bool         stream_body = false;
+		};
+
+		using route_tree_type = http::basic_route_tree<std::shared_ptr<route_type>>;
+		using frozen_table_type = http::basic_frozen_route_table<std::shared_ptr<route_type>>;
 		using cache_type = cache;
+		using single_flight_type = http::basic_single_flight<typename cache_type::message_ptr>;
+		using admission_type = asio::admission_controller;
 
 		/**
 		 * @brief constructor
@@ -139,20 +167,27 @@ namespace boost::beast::http
 
 	protected:
 		template<http::verb... M>
-		inline decltype(auto) _make_uris(std::string name)
+		inline void _bind_routes(std::string name, std::shared_ptr<route_type> op)
 		{
-			std::size_t index = 0;
-			std::array<std::string, sizeof...(M)> uris;
-			//while (!name.empty() && name.back() == '*')
-			//	name.erase(std::prev(name.end()));
 			while (name.size() > static_cast<std::string::size_type>(1) && name.back() == '/')
 				name.erase(std::prev(name.end()));
+
 			assert(!name.empty());
-			if (!name.empty())
+
+			if (name.empty())
+				return;
+
+			// the frozen table doesn't contain the new route, it must be built again.
+			this->frozen_routers_.clear();
+
+			if (op->stream_body)
+				++this->stream_routes_;
+
+			([&]() mutable
 			{
-				((uris[index++] = std::string{ this->_to_char(M) } +name), ...);
-			}
-			return uris;
+				[[maybe_unused]] auto* p = this->routers_[M].insert(name, op);
+				assert(p && "the route exists already");
+			}(), ...);
 		}
 
 		template<http::verb... M, class F, class C, class... AOP>
@@ -166,11 +201,10 @@ namespace boost::beast::http
 
 			static_assert(!asio::has_type<http::enable_cache_t, Tup>::value);
 
-			std::shared_ptr<function_type> op = std::make_shared<function_type>(
-				std::bind_front(&self::template _proxy<CacheFlag, F, C, Tup>, this,
-					std::move(f), c, std::move(tp)));
+			std::shared_ptr<route_type> op = this->_make_route<CacheFlag>(
+				std::move(f), c, std::move(tp), std::make_index_sequence<std::tuple_size_v<Tup>>{});
 
-			this->_bind_uris(name, std::move(op), this->_make_uris<M...>(name));
+			this->_bind_routes<M...>(std::move(name), std::move(op));
 		}
 
 		template<http::verb... M, class F, class... AOP>
@@ -196,119 +230,274 @@ namespace boost::beast::http
 				std::move(f), std::addressof(c), std::forward<AOP>(aop)...);
 		}
 
-		template<class URIS>
-		inline void _bind_uris(std::string& name, std::shared_ptr<function_type> op, URIS uris)
+		template<bool Before, class A>
+		static constexpr aop_kind _aop_kind() noexcept
 		{
-			for (auto& uri : uris)
+			if constexpr (Before)
 			{
-				if (uri.empty())
-					continue;
-
-				if (name.back() == '*')
-				{
-					assert(this->wildcard_routers_.find(uri) == this->wildcard_routers_.end());
-					this->wildcard_routers_[std::move(uri)] = op;
-				}
+				if /**/ constexpr (has_member_before<A, asio::awaitable<bool>, RequestT&, ResponseT&>::value)
+					return aop_kind::async_short;
+				else if constexpr (has_member_before<A, asio::awaitable<bool>, RequestT&, ResponseT&, Ts...>::value)
+					return aop_kind::async_full;
+				else if constexpr (has_member_before<A, bool, RequestT&, ResponseT&>::value)
+					return aop_kind::sync_short;
+				else if constexpr (has_member_before<A, bool, RequestT&, ResponseT&, Ts...>::value)
+					return aop_kind::sync_full;
 				else
-				{
-					assert(this->strictly_routers_.find(uri) == this->strictly_routers_.end());
-					this->strictly_routers_[std::move(uri)] = op;
-				}
+					return aop_kind::none;
+			}
+			else
+			{
+				if /**/ constexpr (has_member_after<A, asio::awaitable<bool>, RequestT&, ResponseT&>::value)
+					return aop_kind::async_short;
+				else if constexpr (has_member_after<A, asio::awaitable<bool>, RequestT&, ResponseT&, Ts...>::value)
+					return aop_kind::async_full;
+				else if constexpr (has_member_after<A, bool, RequestT&, ResponseT&>::value)
+					return aop_kind::sync_short;
+				else if constexpr (has_member_after<A, bool, RequestT&, ResponseT&, Ts...>::value)
+					return aop_kind::sync_full;
+				else
+					return aop_kind::none;
 			}
 		}
 
-		template<class F, class C, class... TS>
-		inline return_type _call_route_function(F& f, C* c, RequestT& req, ResponseT& rep, TS&&... ts)
+		template<class F, class C>
+		static constexpr bool _is_stream_handler() noexcept
 		{
 			if constexpr (std::same_as<std::decay_t<C>, dummy>)
+				return
+					std::is_invocable_v<F&, RequestT&, ResponseT&, const params_type&, http::body_reader&, Ts&...> ||
+					std::is_invocable_v<F&, RequestT&, ResponseT&, http::body_reader&, Ts&...>;
+			else
+				return
+					std::is_invocable_v<F&, C*, RequestT&, ResponseT&, const params_type&, http::body_reader&, Ts&...> ||
+					std::is_invocable_v<F&, C*, RequestT&, ResponseT&, http::body_reader&, Ts&...>;
+		}
+
+		template<bool Before, std::size_t I, class Tup>
+		static constexpr bool _is_async_aop() noexcept
+		{
+			constexpr aop_kind k = _aop_kind<Before, std::tuple_element_t<I, Tup>>();
+			return k == aop_kind::async_short || k == aop_kind::async_full;
+		}
+
+		static inline return_type _ready(bool v)
+		{
+			co_return v;
+		}
+
+		/**
+		 * Returns the awaitable of the coroutine aspect directly, no extra coroutine frame.
+		 * It is only called for the coroutine aspects, see _proxy.
+		 */
+		template<bool Before, std::size_t I, class Tup>
+		inline return_type _call_async_aop(Tup& aops, RequestT& req, ResponseT& rep, Ts&... ts)
+		{
+			auto& aop = std::get<I>(aops);
+
+			constexpr aop_kind k = _aop_kind<Before, std::tuple_element_t<I, Tup>>();
+
+			asio::ignore_unused(aop, req, rep, ts...);
+
+			if /**/ constexpr (k == aop_kind::async_short)
+			{
+				if constexpr (Before)
+					return aop.before(req, rep);
+				else
+					return aop.after(req, rep);
+			}
+			else if constexpr (k == aop_kind::async_full)
 			{
-				co_return co_await f(req, rep, std::forward<TS>(ts)...);
+				if constexpr (Before)
+					return aop.before(req, rep, ts...);
+				else
+					return aop.after(req, rep, ts...);
 			}
 			else
 			{
-				co_return c ? (co_await (c->*f)(req, rep, std::forward<TS>(ts)...)) : false;
+				return _ready(true);
 			}
 		}
 
-		template<bool CacheFlag, class F, class C, class Tup>
-		requires (CacheFlag == false)
-		inline return_type _proxy(F& f, C* c, Tup& aops, RequestT& req, ResponseT& rep, Ts... ts)
+		/**
+		 * Calls the non-coroutine aspect synchronously.
+		 */
+		template<bool Before, std::size_t I, class Tup>
+		inline bool _call_sync_aop(Tup& aops, RequestT& req, ResponseT& rep, Ts&... ts)
 		{
-			if (!(co_await _call_aop_before(aops, req, rep, ts...)))
-				co_return false;
+			auto& aop = std::get<I>(aops);
 
-			if (!(co_await _call_route_function(f, c, req, rep, ts...)))
-				co_return false;
+			asio::ignore_unused(aop, req, rep, ts...);
 
-			if (!(co_await _call_aop_after(aops, req, rep, ts...)))
-				co_return false;
+			constexpr aop_kind k = _aop_kind<Before, std::tuple_element_t<I, Tup>>();
 
-			co_return true;
+			if /**/ constexpr (k == aop_kind::sync_short)
+			{
+				if constexpr (Before)
+					return aop.before(req, rep);
+				else
+					return aop.after(req, rep);
+			}
+			else if constexpr (k == aop_kind::sync_full)
+			{
+				if constexpr (Before)
+					return aop.before(req, rep, ts...);
+				else
+					return aop.after(req, rep, ts...);
+			}
+			else
+			{
+				// note: You have set a AOP, but the function signature of the AOP is incorrect
+				return true;
+			}
 		}
 
-		template<bool CacheFlag, class F, class C, class Tup>
-		requires (CacheFlag == true)
-		inline return_type _proxy(F& f, C* c, Tup& aops, RequestT& req, ResponseT& rep, Ts... ts)
+		/**
+		 * The whole chain of a route runs in this one coroutine: the non-coroutine aspects
+		 * are called directly, and only the coroutine aspects and the route function are
+		 * co_awaited. The conditions of the "?:" are constant, so the co_await branch is only
+		 * evaluated for the coroutine aspects.
+		 */
+		template<bool CacheFlag, class F, class C, class Tup, std::size_t... I>
+		inline return_type _proxy(F& f, C* c, Tup& aops,
+			RequestT& req, ResponseT& rep, const params_type& params, http::body_reader* body, Ts... ts)
 		{
-			using pcache_node = decltype(this->cache_.find(""));
+			asio::ignore_unused(aops, params, body);
 
-			if (http::is_cache_enabled(req))
+			// the body which has been read already is pulled from the memory, eg: the request
+			// of HTTP/2, or the request routed by the route function without the body reader.
+			std::optional<http::buffered_body_reader> buffered;
+
+			if constexpr (_is_stream_handler<F, C>())
 			{
-				pcache_node pcn = this->cache_.find(req.target());
-				if (!pcn)
+				if (!body)
+					body = std::addressof(buffered.emplace(std::string_view(req.body())));
+			}
+
+			typename cache_type::message_ptr cached;
+
+			typename single_flight_type::leader_guard leader;
+
+			bool stale = false;
+
+			// the responses of a target are cached and shared by the content coding.
+			std::string cache_key;
+
+			if constexpr (CacheFlag)
+			{
+				if (http::is_cache_enabled(req))
 				{
-					if (!(co_await _call_aop_before(aops, req, rep, ts...)))
-						co_return false;
+					cache_key = http::make_cache_key(req);
+					cached = this->cache_.find(cache_key, stale);
+				}
+			}
 
-					if (!(co_await _call_route_function(f, c, req, rep, ts...)))
-						co_return false;
+			bool continued = (true && ... && (_is_async_aop<true, I, Tup>()
+				? co_await this->template _call_async_aop<true, I>(aops, req, rep, ts...)
+				: this->template _call_sync_aop<true, I>(aops, req, rep, ts...)));
 
-					if (!(co_await _call_aop_after(aops, req, rep, ts...)))
-						co_return false;
+			if (!continued)
+				co_return false;
 
-					if (this->cache_.full())
+			if constexpr (CacheFlag)
+			{
+				// Only the first request of a missed (or stale) url calls the handler, the
+				// concurrent ones wait for its result, or are served with the stale message.
+				if ((!cached || stale) && http::is_cache_enabled(req))
+				{
+					auto [flight, is_leader] = this->flights_.join(cache_key);
+
+					if (is_leader)
 					{
-						this->cache_.shrink_to_fit();
+						cached.reset();
+						leader = typename single_flight_type::leader_guard(this->flights_, std::move(flight));
 					}
-
-					if (!this->cache_.full() && rep.get_response_header().result() == http::status::ok)
+					else if (!cached)
 					{
-						if (auto res = rep.to_string_body_response(); res.has_value())
-						{
-							this->cache_.add(req.target(), std::move(res.value()));
-						}
+						cached = co_await single_flight_type::wait(std::move(flight));
 					}
+				}
+			}
 
-					co_return true;
+			if (!cached)
+			{
+				if constexpr (std::same_as<std::decay_t<C>, dummy>)
+				{
+					if constexpr (std::is_invocable_v<F&, RequestT&, ResponseT&, const params_type&, http::body_reader&, Ts&...>)
+						continued = co_await f(req, rep, params, *body, ts...);
+					else if constexpr (std::is_invocable_v<F&, RequestT&, ResponseT&, http::body_reader&, Ts&...>)
+						continued = co_await f(req, rep, *body, ts...);
+					else if constexpr (std::is_invocable_v<F&, RequestT&, ResponseT&, const params_type&, Ts&...>)
+						continued = co_await f(req, rep, params, ts...);
+					else
+						continued = co_await f(req, rep, ts...);
 				}
 				else
 				{
-					if (!(co_await _call_aop_before(aops, req, rep, ts...)))
+					if (!c)
 						co_return false;
 
-					if (!(co_await _call_aop_after(aops, req, rep, ts...)))
-						co_return false;
+					if constexpr (std::is_invocable_v<F&, C*, RequestT&, ResponseT&, const params_type&, http::body_reader&, Ts&...>)
+						continued = co_await (c->*f)(req, rep, params, *body, ts...);
+					else if constexpr (std::is_invocable_v<F&, C*, RequestT&, ResponseT&, http::body_reader&, Ts&...>)
+						continued = co_await (c->*f)(req, rep, *body, ts...);
+					else if constexpr (std::is_invocable_v<F&, C*, RequestT&, ResponseT&, const params_type&, Ts&...>)
+						continued = co_await (c->*f)(req, rep, params, ts...);
+					else
+						continued = co_await (c->*f)(req, rep, ts...);
+				}
 
-					pcn->update_alive_time();
+				if (!continued)
+					co_return false;
+			}
 
-					rep = std::ref(pcn->msg);
+			continued = (true && ... && (_is_async_aop<false, I, Tup>()
+				? co_await this->template _call_async_aop<false, I>(aops, req, rep, ts...)
+				: this->template _call_sync_aop<false, I>(aops, req, rep, ts...)));
 
-					co_return true;
-				}
-			}
-			else
-			{
-				if (!(co_await _call_aop_before(aops, req, rep, ts...)))
-					co_return false;
+			if (!continued)
+				co_return false;
 
-				if (!(co_await _call_route_function(f, c, req, rep, ts...)))
-					co_return false;
+			if constexpr (CacheFlag)
+			{
+				if (cached)
+				{
+					// the serialized response is kept alive by the response even if it's evicted.
+					if (http::is_not_modified(req, cached->header))
+						rep = http::make_not_modified_response(cached->header);
+					else
+						rep = std::move(cached);
+				}
+				else if (http::is_cache_enabled(req))
+				{
+					if (rep.get_response_header().result() == http::status::ok)
+					{
+						if (auto res = rep.to_string_body_response(); res.has_value())
+						{
+							auto sp = http::make_serialized_response(res.value());
 
-				if (!(co_await _call_aop_after(aops, req, rep, ts...)))
-					co_return false;
+							// send the serialized one too, so the ETag is the same as the later hits.
+							if (sp && this->cache_.add(cache_key, sp))
+							{
+								leader.finish(sp);
 
-				co_return true;
+								rep = std::move(sp);
+							}
+						}
+					}
+				}
 			}
+
+			co_return true;
+		}
+
+		template<bool CacheFlag, class F, class C, class Tup, std::size_t... I>
+		inline std::shared_ptr<route_type> _make_route(F f, C* c, Tup tp, std::index_sequence<I...>)
+		{
+			return std::make_shared<route_type>(route_type{
+				std::bind_front(&self::template _proxy<CacheFlag, F, C, Tup, I...>, this,
+					std::move(f), c, std::move(tp)),
+				_is_stream_handler<F, C>() });
 		}
 
 		template<class F, class... TS>
@@ -343,154 +532,48 @@ namespace boost::beast::http
 			this->_add_not_found_impl(std::move(f), std::addressof(c));
 		}
 
-		template <typename... Args, typename F, std::size_t... I>
-		inline asio::awaitable<void> _for_each_tuple(std::tuple<Args...>& t, const F& f, std::index_sequence<I...>)
+		template<class... TS>
+		inline return_type _route(RequestT& req, ResponseT& rep, http::body_reader* body, TS&&... ts)
 		{
-			((co_await f(std::get<I>(t))), ...);
-		}
+			params_type params{};
 
-		template<class Tup>
-		inline return_type _do_call_aop_before(Tup& aops, RequestT& req, ResponseT& rep, Ts... ts)
-		{
-			asio::ignore_unused(aops, req, rep, ts...);
+			route_type* router_ptr = this->find(req, params);
 
-			bool continued = true;
-			co_await _for_each_tuple(aops, [&](auto& aop) -> asio::awaitable<void>
-			{
-				asio::ignore_unused(req, rep, ts...);
-
-				if (!continued)
-					co_return;
-
-				if constexpr (has_member_before<
-					decltype(aop), asio::awaitable<bool>, RequestT&, ResponseT&>::value)
-				{
-					continued = co_await aop.before(req, rep);
-				}
-				else if constexpr (has_member_before<
-					decltype(aop), asio::awaitable<bool>, RequestT&, ResponseT&, Ts...>::value)
-				{
-					continued = co_await aop.before(req, rep, ts...);
-				}
-				else
-				{
-					// note: You have set a AOP, but the function signature of the AOP is incorrect
-				}
-			}, std::make_index_sequence<std::tuple_size_v<Tup>>{});
-
-			co_return continued;
-		}
-
-		template<class Tup, class... TS>
-		inline return_type _call_aop_before(Tup& aops, RequestT& req, ResponseT& rep, TS&&... ts)
-		{
-			asio::ignore_unused(aops, req, rep, ts...);
-
-			if constexpr (!std::tuple_size_v<Tup>)
-			{
-				co_return true;
-			}
-			else
+			if (router_ptr)
 			{
-				co_return co_await this->_do_call_aop_before(aops, req, rep, std::forward<TS>(ts)...);
+				co_return co_await router_ptr->handler(req, rep, params, body, std::forward<TS>(ts)...);
 			}
-		}
-
-		template<class Tup>
-		inline return_type _do_call_aop_after(Tup& aops, RequestT& req, ResponseT& rep, Ts... ts)
-		{
-			asio::ignore_unused(aops, req, rep, ts...);
-
-			bool continued = true;
-			co_await _for_each_tuple(aops, [&](auto& aop) -> asio::awaitable<void>
-			{
-				asio::ignore_unused(req, rep, ts...);
-
-				if (!continued)
-					co_return;
-
-				if constexpr (has_member_after<
-					decltype(aop), asio::awaitable<bool>, RequestT&, ResponseT&>::value)
-				{
-					continued = co_await aop.after(req, rep);
-				}
-				else if constexpr (has_member_after<
-					decltype(aop), asio::awaitable<bool>, RequestT&, ResponseT&, Ts...>::value)
-				{
-					continued = co_await aop.after(req, rep, ts...);
-				}
-				else
-				{
-					// note: You have set a AOP, but the function signature of the AOP is incorrect
-				}
-			}, std::make_index_sequence<std::tuple_size_v<Tup>>{});
-
-			co_return continued;
-		}
-
-		template<class Tup, class... TS>
-		inline return_type _call_aop_after(Tup& aops, RequestT& req, ResponseT& rep, TS&&... ts)
-		{
-			asio::ignore_unused(aops, req, rep, ts...);
 
-			if constexpr (!std::tuple_size_v<Tup>)
-			{
-				co_return true;
-			}
-			else
+			if (this->not_found_router_ && (*(this->not_found_router_)))
 			{
-				co_return co_await this->_do_call_aop_after(aops, req, rep, std::forward<TS>(ts)...);
+				co_return co_await (*(this->not_found_router_))(req, rep, std::forward<TS>(ts)...);
 			}
+
+			co_return false;
 		}
 
-		inline std::string _make_uri(std::string_view root, std::string_view path)
+		inline return_type _shed(RequestT& req, ResponseT& rep)
 		{
-			std::string uri;
+			auto res = http::make_error_page_response(
+				http::status::service_unavailable, std::string_view{}, "text/html", req.version());
+			res.set(http::field::retry_after, "1");
+			res.keep_alive(req.keep_alive());
 
-			if (http::has_undecode_char(path, 1))
-			{
-				std::string decoded = http::url_decode(path);
-
-				path = decoded;
-
-				while (path.size() > static_cast<std::string_view::size_type>(1) && path.back() == '/')
-				{
-					path.remove_suffix(1);
-				}
+			rep = std::move(res);
 
-				uri.reserve(root.size() + path.size());
-				uri += root;
-				uri += path;
-			}
-			else
-			{
-				while (path.size() > static_cast<std::string_view::size_type>(1) && path.back() == '/')
-				{
-					path.remove_suffix(1);
-				}
-
-				uri.reserve(root.size() + path.size());
-				uri += root;
-				uri += path;
-			}
-
-			return uri;
-		}
-
-		inline constexpr std::string_view _to_char(http::verb method) noexcept
-		{
-			using namespace std::literals;
-			// Use a special name to avoid conflicts with global variable names
-			constexpr std::string_view _hrmchars =
-				"0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ"sv;
-			return _hrmchars.substr(std::to_underlying(method), 1);
+			co_return true;
 		}
 
 	public:
 		/**
 		 * @brief bind a function for http router
-		 * @param name - uri name in string format.
-		 * @param fun - Function object.
+		 * @param name - uri name in string format, the ":name" segment matches one path segment,
+		 *               and the "*name" at the end matches the rest of the path, eg: "/user/:id".
+		 * @param fun - Function object, the signature can be (RequestT&, ResponseT&, Ts...) or
+		 *              (RequestT&, ResponseT&, const http::path_params&, Ts...). If the function
+		 *              has the http::body_reader& after them, eg: (RequestT&, ResponseT&,
+		 *              http::body_reader&, Ts...), it's a streaming route: the request is routed
+		 *              after the header is read, and the function pulls the body by the reader.
 		 * @param aops - A pointer or reference to a aop object list.
 		 * if fun is member function, the first aops param must the class object's pointer or reference.
 		 */
@@ -542,8 +625,42 @@ namespace boost::beast::http
 			return (*this);
 		}
 
-		inline std::shared_ptr<function_type>& find(RequestT& req)
+		/**
+		 * @brief Build the perfect hash table of the static routes, so the static routes are
+		 * found with a single probe instead of walking the radix tree.
+		 * Call it after all the routes are added, adding a route drops the frozen table.
+		 * The table shares the routes with the radix trees, so a route which is added for
+		 * several methods is still one object, and the state of its function and aspects
+		 * isn't copied.
+		 */
+		inline self& freeze()
+		{
+			std::vector<typename frozen_table_type::entry> entries;
+
+			for (auto& [method, tree] : this->routers_)
+			{
+				tree.for_each_static([&entries, method](std::string_view path, std::shared_ptr<route_type>& op)
+				{
+					if (op && op->handler)
+						entries.emplace_back(method, std::string(path), op);
+				});
+			}
+
+			this->frozen_routers_.build(std::move(entries));
+
+			return (*this);
+		}
+
+		/**
+		 * @brief Find the route of the request, and capture the path parameters.
+		 * The params must outlive the call of the router function.
+		 * @return The pointer to the route, or nullptr if not found.
+		 */
+		inline route_type* find(RequestT& req, params_type& params)
 		{
+			if (this->routers_.empty())
+				return nullptr;
+
 			std::string_view path = req.target();
 
 			if (auto pos = path.find('?'); pos != std::string_view::npos)
@@ -551,50 +668,114 @@ namespace boost::beast::http
 				path = path.substr(0, pos);
 			}
 
-			std::string uri = this->_make_uri(this->_to_char(req.method()), path);
-
+			// only allocate when the path is percent encoded.
+			if (http::has_undecode_char(path, 1))
 			{
-				auto it = this->strictly_routers_.find(uri);
-				if (it != this->strictly_routers_.end())
-				{
-					return (it->second);
-				}
+				params.decoded_path() = http::url_decode(path);
+				path = params.decoded_path();
 			}
 
-			// Find the best match url from tail to head
-			if (!wildcard_routers_.empty())
+			while (path.size() > static_cast<std::string_view::size_type>(1) && path.back() == '/')
 			{
-				for (auto it = this->wildcard_routers_.rbegin(); it != this->wildcard_routers_.rend(); ++it)
-				{
-					auto& k = it->first;
-					assert(k.size() >= std::size_t(3));
-					if (!uri.empty() && !k.empty() && uri.front() == k.front() && uri.size() >= (k.size() - 2)
-						&& uri[k.size() - 3] == k[k.size() - 3] && http::url_match(k, uri))
-					{
-						return (it->second);
-					}
-				}
+				path.remove_suffix(1);
 			}
 
-			return this->dummy_router_;
+			if (std::shared_ptr<route_type>* p = this->frozen_routers_.find(req.method(), path))
+				return p->get();
+
+			auto it = this->routers_.find(req.method());
+			if (it == this->routers_.end())
+				return nullptr;
+
+			if (std::shared_ptr<route_type>* p = it->second.match(path, params))
+				return p->get();
+
+			return nullptr;
+		}
+
+		/**
+		 * @brief Returns true if any streaming route has been added, see find_stream_route.
+		 */
+		inline bool has_stream_route() const noexcept
+		{
+			return this->stream_routes_ > 0;
+		}
+
+		/**
+		 * @brief Find the streaming route of the request, whose function pulls the body by the
+		 * http::body_reader, so the body must not be read before routing.
+		 * The found route and the params are passed to the route_stream, so the request isn't
+		 * looked up again, the params must outlive the call of the route_stream.
+		 * @return The pointer to the route, or nullptr if the request isn't routed to a
+		 * streaming route.
+		 */
+		inline route_type* find_stream_route(RequestT& req, params_type& params)
+		{
+			if (this->stream_routes_ == 0)
+				return nullptr;
+
+			route_type* p = this->find(req, params);
+
+			return p && p->stream_body ? p : nullptr;
+		}
+
+		/**
+		 * @brief Check whether the request is routed to a streaming route, see find_stream_route.
+		 */
+		inline bool is_stream_route(RequestT& req)
+		{
+			params_type params{};
+
+			return this->find_stream_route(req, params) != nullptr;
 		}
 
 		template<class... TS>
 		inline return_type route(RequestT& req, ResponseT& rep, TS&&... ts)
 		{
-			std::shared_ptr<function_type>& router_ptr = this->find(req);
+			return this->_route(req, rep, nullptr, std::forward<TS>(ts)...);
+		}
+
+		/**
+		 * @brief Route the request with admission control.
+		 * If the request has been queued longer than the admission controller allows, it is
+		 * answered with 503 Service Unavailable immediately, and the handler is not called.
+		 * @param parsed_time - The time point when the request was parsed.
+		 */
+		template<class... TS>
+		inline return_type route(
+			std::chrono::steady_clock::time_point parsed_time, RequestT& req, ResponseT& rep, TS&&... ts)
+		{
+			auto now = std::chrono::steady_clock::now();
 
-			if (router_ptr)
+			if (this->admission_.admit(now - parsed_time, now))
 			{
-				co_return co_await (*router_ptr)(req, rep, std::forward<TS>(ts)...);
+				return this->_route(req, rep, nullptr, std::forward<TS>(ts)...);
 			}
 
-			if (this->not_found_router_ && (*(this->not_found_router_)))
+			return this->_shed(req, rep);
+		}
+
+		/**
+		 * @brief Route the request whose body hasn't been read to the streaming route which was
+		 * found by the find_stream_route, the body is pulled from the reader by the function of
+		 * the route.
+		 * @param parsed_time - The time point when the header of the request was parsed.
+		 * @param route - The route which was returned by the find_stream_route.
+		 * @param params - The params which were captured by the find_stream_route.
+		 */
+		template<class... TS>
+		inline return_type route_stream(std::chrono::steady_clock::time_point parsed_time,
+			RequestT& req, ResponseT& rep, http::body_reader& body, route_type& route, const params_type& params,
+			TS&&... ts)
+		{
+			auto now = std::chrono::steady_clock::now();
+
+			if (this->admission_.admit(now - parsed_time, now))
 			{
-				co_return co_await (*(this->not_found_router_))(req, rep, std::forward<TS>(ts)...);
+				return route.handler(req, rep, params, std::addressof(body), std::forward<TS>(ts)...);
 			}
 
-			co_return false;
+			return this->_shed(req, rep);
 		}
 
 		inline cache_type& get_cache()
@@ -602,16 +783,25 @@ namespace boost::beast::http
 			return this->cache_;
 		}
 
+		inline admission_type& get_admission_controller()
+		{
+			return this->admission_;
+		}
+
 	protected:
-		std::unordered_map<std::string, std::shared_ptr<function_type>> strictly_routers_;
+		std::unordered_map<http::verb, route_tree_type>                 routers_;
 
-		std::          map<std::string, std::shared_ptr<function_type>> wildcard_routers_;
+		frozen_table_type                                               frozen_routers_;
 
 		std::shared_ptr<function_type>                                  not_found_router_;
 
-		inline static std::shared_ptr<function_type>                    dummy_router_;
-
 		cache_type                                                      cache_;
+
+		single_flight_type                                              flights_;
+
+		admission_type                                                  admission_;
+
+		std::size_t                                                     stream_routes_ = 0;
 	};
 }
 
@@ -0,0 +1,832 @@
+/*
+ * Copyright (c) 2017-2023 zhllxt
+ *
+ * author   : zhllxt
+ * email    : 37792738@qq.com
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <charconv>
+#include <concepts>
+#include <chrono>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <asio3/core/asio.hpp>
+#include <asio3/core/beast.hpp>
+#include <asio3/core/netutil.hpp>
+#include <asio3/core/timer.hpp>
+#include <asio3/core/deadline.hpp>
+#include <asio3/http/core.hpp>
+#include <asio3/http/arena.hpp>
+#include <asio3/http/body_reader.hpp>
+#include <asio3/http/make.hpp>
+#include <asio3/http/sse.hpp>
+#include <asio3/http/write.hpp>
+
+#ifdef ASIO_STANDALONE
+namespace asio
+#else
+namespace boost::asio
+#endif
+{
+	struct http_serve_option
+	{
+		// The max count of the requests served on one connection, zero means no limit.
+		// The connection is closed after the response of the last request is sent.
+		std::size_t max_requests = 0;
+
+		// The max size of the request header, the request is answered with 431 if exceeded.
+		std::uint32_t header_limit = 8 * 1024;
+
+		// The max size of the request body, the request is answered with 413 if exceeded.
+		std::uint64_t body_limit = 8 * 1024 * 1024;
+
+		// The max size of the request body which is pulled by the streaming route, the body
+		// isn't held in the memory, so it can be much larger. Zero means no limit.
+		std::uint64_t stream_body_limit = 0;
+
+		// How many parsed requests can be queued while the earlier ones are being handled and
+		// their responses are being written.
+		std::size_t pipeline_depth = 8;
+
+		// The max duration to wait for the next request on an idle keep-alive connection.
+		std::chrono::steady_clock::duration idle_timeout = asio::http_idle_timeout;
+
+		// The max duration to read the request header since the first byte has arrived.
+		std::chrono::steady_clock::duration header_timeout = std::chrono::seconds(30);
+
+		// The max duration to read the request body, or to wait for each piece of the body which
+		// is pulled by the streaming route.
+		std::chrono::steady_clock::duration body_timeout = std::chrono::seconds(60);
+
+		// The min average rate (bytes per second) of receiving the request body after the grace
+		// period, only the time while the server is waiting for the body is counted. The client
+		// which trickles the body is disconnected with 408. Zero means no limit.
+		std::uint64_t min_body_rate = 240;
+
+		// The grace period of the min_body_rate.
+		std::chrono::steady_clock::duration min_body_rate_grace = std::chrono::seconds(5);
+
+		// The max duration of the route handler, the async operations of the handler are cancelled
+		// when it's exceeded, and the request is answered with 503. Zero means no limit.
+		std::chrono::steady_clock::duration handler_timeout = std::chrono::steady_clock::duration::zero();
+
+		// The max duration to write a response.
+		std::chrono::steady_clock::duration write_timeout = std::chrono::seconds(60);
+
+		// The comment line is sent on the idle event stream at this interval, it keeps the
+		// proxies from closing the stream and finds out the clients which have gone.
+		std::chrono::steady_clock::duration sse_heartbeat_interval = std::chrono::seconds(15);
+
+		// Whether the HTTP/2 is served, the cleartext connection which starts with the preface
+		// of HTTP/2 (h2c with prior knowledge) and the tls connection which negotiated "h2" by
+		// ALPN. The max_requests and the pipeline_depth are not used by HTTP/2.
+		bool enable_http2 = true;
+
+		// The max count of the concurrent streams of a HTTP/2 connection, the streams beyond it
+		// are refused.
+		std::uint32_t http2_max_concurrent_streams = 100;
+
+		// The flow control window of a HTTP/2 connection and each of its streams, which limits
+		// how much of the request bodies the client can send before they're consumed.
+		std::uint32_t http2_initial_window_size = 1024 * 1024;
+	};
+}
+
+#ifdef ASIO_STANDALONE
+namespace asio::detail
+#else
+namespace boost::asio::detail
+#endif
+{
+	/**
+	 * @brief Whether the router has the streaming routes, see http::basic_router::find_stream_route.
+	 */
+	template<class RouterT>
+	concept is_stream_router = requires(RouterT& router, typename RouterT::request_type& req,
+		typename RouterT::response_type& rep, typename RouterT::route_type& route,
+		typename RouterT::params_type& params, http::body_reader& body)
+	{
+		router.has_stream_route();
+		{ router.find_stream_route(req, params) } -> std::same_as<typename RouterT::route_type*>;
+		router.route_stream(std::chrono::steady_clock::time_point{}, req, rep, body, route, params);
+	};
+
+	/**
+	 * @brief The streaming route which is found by the reader when the header is read, the
+	 * writer routes the request to it with the body reader, so the route isn't looked up again.
+	 * It's destroyed by the reader after the route has returned.
+	 */
+	template<class RouterT>
+	struct http_serve_stream
+	{
+		typename RouterT::route_type*  route = nullptr;
+
+		typename RouterT::params_type  params{};
+
+		http::body_reader*             body = nullptr;
+	};
+
+	template<class RequestT, class RouterT>
+	using http_serve_channel = asio::experimental::channel<
+		void(asio::error_code, http::status, RequestT, std::chrono::steady_clock::time_point,
+			http::request_arena*, http_serve_stream<RouterT>*)>;
+
+	/**
+	 * @brief The writer tells the reader that the streaming route has returned, so the reader
+	 * can go on to read the next request.
+	 */
+	struct http_serve_body_signal
+	{
+		asio::steady_timer timer;
+
+		bool               released = false;
+	};
+
+	/**
+	 * @brief The body of the request which is pulled by the streaming route in the writer,
+	 * the reader waits until the route has returned, then the next request can be read.
+	 */
+	template<class StreamT, class ParserT>
+	class http_serve_body_reader final : public http::body_reader
+	{
+	public:
+		http_serve_body_reader(StreamT& sock, beast::flat_buffer& buffer, ParserT& parser,
+			asio::connection_deadline& deadline, bool expect_continue, const http_serve_option& opt)
+			: sock_(sock), buffer_(buffer), parser_(parser), deadline_(deadline), opt_(opt)
+			, expect_continue_(expect_continue)
+		{
+		}
+
+		asio::awaitable<std::tuple<error_code, std::size_t>> async_read_some(asio::mutable_buffer buf) override
+		{
+			if (buf.size() == 0)
+				co_return std::tuple{ error_code{}, std::size_t(0) };
+
+			// the client waits for the interim response before sending the body, it's sent when
+			// the body is pulled, so the route which rejects the request doesn't get the body.
+			if (this->expect_continue_)
+			{
+				this->expect_continue_ = false;
+
+				static constexpr std::string_view interim = "HTTP/1.1 100 Continue\r\n\r\n";
+
+				this->deadline_.expires_after(this->opt_.write_timeout);
+
+				auto [e1, n1] = co_await asio::async_write(this->sock_, asio::buffer(interim),
+					this->deadline_.bind(asio::use_nothrow_awaitable));
+
+				this->deadline_.expires_never();
+
+				if (this->deadline_.expired())
+					co_return std::tuple{ error_code(asio::error::timed_out), std::size_t(0) };
+
+				if (e1)
+					co_return std::tuple{ e1, std::size_t(0) };
+			}
+
+			auto& body = this->parser_.get().body();
+
+			// the size of each read is limited by the capacity of the buffer, it's grown once
+			// so the large body isn't read by the small pieces.
+			if (std::size_t n = (std::min)(buf.size(), max_read_size); this->buffer_.capacity() < n)
+				this->buffer_.reserve(n);
+
+			// the parser may consume the chunk headers only, read again until some data is got.
+			while (!this->parser_.is_done())
+			{
+				body.data = buf.data();
+				body.size = buf.size();
+
+				this->deadline_.expires_after(this->opt_.body_timeout);
+
+				auto [ec, n] = co_await http::async_read_some(this->sock_, this->buffer_, this->parser_,
+					this->deadline_.bind(asio::use_nothrow_awaitable));
+
+				this->deadline_.expires_never();
+
+				if (this->deadline_.expired())
+					co_return std::tuple{ error_code(asio::error::timed_out), std::size_t(0) };
+
+				if (ec == http::error::need_buffer)
+					ec = {};
+
+				std::size_t bytes = buf.size() - body.size;
+
+				this->deadline_.consume(bytes);
+
+				if (ec || bytes > 0)
+					co_return std::tuple{ ec, bytes };
+			}
+
+			co_return std::tuple{ error_code{}, std::size_t(0) };
+		}
+
+		bool is_done() const override
+		{
+			return this->parser_.is_done();
+		}
+
+		std::optional<std::uint64_t> content_length() const override
+		{
+			if (auto n = this->parser_.content_length(); n)
+				return *n;
+			return std::nullopt;
+		}
+
+	protected:
+		static constexpr std::size_t max_read_size = 64 * 1024;
+
+		StreamT&                   sock_;
+
+		beast::flat_buffer&        buffer_;
+
+		ParserT&                   parser_;
+
+		asio::connection_deadline& deadline_;
+
+		const http_serve_option&   opt_;
+
+		bool                       expect_continue_ = false;
+	};
+
+	/**
+	 * @brief Map the read error to the status of the error response, the unknown status
+	 * means the connection is closed without response.
+	 */
+	template<typename = void>
+	inline http::status http_serve_error_status(const asio::error_code& ec) noexcept
+	{
+		if (ec == http::error::header_limit)
+			return http::status::request_header_fields_too_large;
+
+		if (ec == http::error::body_limit || ec == http::error::buffer_overflow)
+			return http::status::payload_too_large;
+
+		if (ec == http::error::end_of_stream || ec == http::error::partial_message)
+			return http::status::unknown;
+
+		if (ec.category() == http::make_error_code(http::error::bad_target).category())
+			return http::status::bad_request;
+
+		return http::status::unknown;
+	}
+
+	/**
+	 * @brief Read the requests and push them into the channel, so the next requests are
+	 * parsed while the earlier ones are still being handled.
+	 */
+	template<class SessionT, class RouterT, class ChannelT>
+	asio::awaitable<void> http_serve_read(SessionT& session, RouterT& router, ChannelT& ch,
+		http_serve_body_signal& signal, asio::connection_deadline& deadline, const http_serve_option& opt,
+		beast::flat_buffer& buffer)
+	{
+		using request_type = typename SessionT::request_type;
+		using body_type = typename request_type::body_type;
+		using allocator_type = typename request_type::fields_type::allocator_type;
+		using time_point = std::chrono::steady_clock::time_point;
+
+		auto& sock = session.get_stream();
+
+		asio::error_code ec{};
+		http::status status = http::status::unknown;
+
+		for (std::size_t count = 0; opt.max_requests == 0 || count < opt.max_requests; ++count)
+		{
+			// idle phase: wait for the first bytes of the next request. The tls stream can't be
+			// waited, the idle duration is added to the timeout of reading the header.
+			auto header_timeout = opt.header_timeout;
+
+			if constexpr (!requires { sock.async_wait(asio::socket_base::wait_read); })
+			{
+				if (buffer.size() == 0)
+					header_timeout += opt.idle_timeout;
+			}
+			else if (buffer.size() == 0)
+			{
+				deadline.expires_after(opt.idle_timeout);
+
+				auto [e0] = co_await sock.async_wait(asio::socket_base::wait_read,
+					deadline.bind(asio::use_nothrow_awaitable));
+
+				deadline.expires_never();
+
+				if (deadline.expired())
+				{
+					ec = asio::error::timed_out;
+					break;
+				}
+
+				ec = e0;
+				if (ec)
+					break;
+			}
+
+			// the arena request is parsed into the memory of an unused arena of the session,
+			// the arena is given back after the response of the request is written.
+			http::request_arena* arena = nullptr;
+
+			std::optional<http::request_parser<body_type, allocator_type>> parser;
+
+			if constexpr (http::is_arena_request_v<request_type>)
+			{
+				arena = session.arena_pool.acquire();
+				parser.emplace(http::make_arena_request(*arena));
+			}
+			else
+			{
+				parser.emplace();
+			}
+
+			parser->header_limit(opt.header_limit);
+
+			// the Content-Length is checked by the parser when the header is parsed, but the limit
+			// of the streaming route is only known after the route is found.
+			if constexpr (is_stream_router<RouterT>)
+			{
+				if (router.has_stream_route())
+					parser->body_limit(std::nullopt);
+				else
+					parser->body_limit(opt.body_limit);
+			}
+			else
+			{
+				parser->body_limit(opt.body_limit);
+			}
+
+			deadline.expires_after(header_timeout);
+
+			auto [e1, n1] = co_await http::async_read_header(sock, buffer, *parser,
+				deadline.bind(asio::use_nothrow_awaitable));
+
+			deadline.expires_never();
+
+			if (deadline.expired())
+			{
+				ec = asio::error::timed_out;
+				status = http::status::request_timeout;
+				break;
+			}
+
+			ec = e1;
+			if (ec)
+			{
+				status = detail::http_serve_error_status(ec);
+				break;
+			}
+
+			// the body of the streaming route is pulled by the route in the writer, and this
+			// reader waits until the route has returned.
+			if constexpr (is_stream_router<RouterT>)
+			{
+				// the params are the views into the target of the request, which is moved along
+				// with the request.
+				http_serve_stream<RouterT> stream{};
+
+				if (router.has_stream_route() && !parser->is_done())
+					stream.route = router.find_stream_route(parser->get(), stream.params);
+
+				std::uint64_t limit = stream.route ? opt.stream_body_limit : opt.body_limit;
+
+				if (router.has_stream_route())
+				{
+					if (auto n = parser->content_length(); n && limit > 0 && *n > limit)
+					{
+						ec = http::error::body_limit;
+						status = http::status::payload_too_large;
+						break;
+					}
+
+					parser->body_limit(limit > 0 ? std::optional<std::uint64_t>(limit) : std::nullopt);
+				}
+
+				if (stream.route)
+				{
+					bool keep_alive = parser->keep_alive();
+
+					bool expect_continue = parser->get().version() >= 11 &&
+						beast::iequals(parser->get()[http::field::expect], "100-continue");
+
+					std::optional<http::request_parser<http::buffer_body, allocator_type>> body_parser;
+					body_parser.emplace(std::move(*parser));
+
+					detail::http_serve_body_reader<std::remove_cvref_t<decltype(sock)>,
+						http::request_parser<http::buffer_body, allocator_type>> reader(
+							sock, buffer, *body_parser, deadline, expect_continue, opt);
+
+					stream.body = std::addressof(reader);
+
+					deadline.min_rate(opt.min_body_rate, opt.min_body_rate_grace);
+
+					session.update_alive_time();
+
+					signal.released = false;
+
+					auto [e3] = co_await ch.async_send(asio::error_code{}, http::status::unknown,
+						request_type(std::move(body_parser->get().base())), std::chrono::steady_clock::now(),
+						arena, std::addressof(stream), asio::as_tuple(asio::use_awaitable));
+					if (e3)
+						co_return;
+
+					while (!signal.released && ch.is_open())
+					{
+						signal.timer.expires_at((time_point::max)());
+						co_await signal.timer.async_wait(asio::use_nothrow_awaitable);
+					}
+
+					deadline.min_rate(0);
+
+					if (!ch.is_open())
+						co_return;
+
+					// the rest of the body is unread, the connection can't be used anymore.
+					if (!keep_alive || !reader.is_done())
+					{
+						ec = asio::error::eof;
+						break;
+					}
+
+					continue;
+				}
+			}
+
+			// the body is read piece by piece, so the client which trickles the body is found out
+			// by the min rate before the body_timeout.
+			if (!parser->is_done())
+			{
+				deadline.min_rate(opt.min_body_rate, opt.min_body_rate_grace);
+				deadline.expires_after(opt.body_timeout);
+
+				while (!ec && !parser->is_done())
+				{
+					auto [e2, n2] = co_await http::async_read_some(sock, buffer, *parser,
+						deadline.bind(asio::use_nothrow_awaitable));
+
+					deadline.consume(n2);
+
+					ec = e2;
+				}
+
+				deadline.expires_never();
+				deadline.min_rate(0);
+
+				if (deadline.expired())
+				{
+					ec = asio::error::timed_out;
+					status = http::status::request_timeout;
+					break;
+				}
+
+				if (ec)
+				{
+					status = detail::http_serve_error_status(ec);
+					break;
+				}
+			}
+
+			session.update_alive_time();
+
+			bool keep_alive = parser->keep_alive();
+
+			auto [e3] = co_await ch.async_send(asio::error_code{}, http::status::unknown,
+				request_type(parser->release()), std::chrono::steady_clock::now(), arena, nullptr,
+				asio::as_tuple(asio::use_awaitable));
+			if (e3)
+				co_return;
+
+			// the client will close the connection after this request.
+			if (!keep_alive)
+			{
+				ec = asio::error::eof;
+				break;
+			}
+		}
+
+		// notify the writer that there are no more requests.
+		co_await ch.async_send(ec ? ec : asio::error::eof, status, request_type{}, time_point{}, nullptr, nullptr,
+			asio::as_tuple(asio::use_awaitable));
+	}
+
+	/**
+	 * @brief Write the header of the event stream response, then write the events of the
+	 * stream as the chunks until the stream is closed. The events which are waiting are
+	 * gathered into one chunk, the encoded events are written without being copied.
+	 */
+	template<class SessionT, class StreamT, class ResponseT>
+	asio::awaitable<asio::error_code> http_serve_event_stream(SessionT& session, StreamT& sock,
+		ResponseT& rep, std::shared_ptr<http::sse_stream> stream, asio::connection_deadline& deadline,
+		const http_serve_option& opt)
+	{
+		static constexpr std::string_view heartbeat = ": keep-alive\n\n";
+		static constexpr std::string_view crlf = "\r\n";
+		static constexpr std::string_view last_chunk = "0\r\n\r\n";
+
+		asio::error_code ec{};
+
+		std::string head;
+
+		while (!ec && !rep.is_header_done())
+		{
+			auto bufs = rep.prepare(ec);
+			if (ec)
+				break;
+
+			std::size_t n = 0;
+			for (const auto& b : bufs)
+			{
+				head.append(static_cast<const char*>(b.data()), b.size());
+				n += b.size();
+			}
+
+			rep.consume(n);
+		}
+
+		std::vector<http::sse_stream::event_ptr> events;
+		std::vector<asio::const_buffer> bufs;
+
+		// the header is sent at once, the client is waiting for it to start the stream.
+		if (!ec)
+			bufs.emplace_back(asio::buffer(head));
+
+		while (!ec)
+		{
+			if (bufs.empty())
+			{
+				events.clear();
+
+				bool open = co_await stream->async_fetch(events, opt.sse_heartbeat_interval);
+
+				std::size_t size = 0;
+				for (const auto& e : events)
+					size += e->size();
+
+				if (size == 0 && open)
+				{
+					size = heartbeat.size();
+					bufs.emplace_back(asio::buffer(heartbeat));
+				}
+				else
+				{
+					for (const auto& e : events)
+						bufs.emplace_back(asio::buffer(*e));
+				}
+
+				if (size > 0)
+				{
+					head.resize(16);
+					auto [p, e1] = std::to_chars(head.data(), head.data() + head.size(), size, 16);
+					head.resize(p - head.data());
+					head.append(crlf);
+
+					bufs.insert(bufs.begin(), asio::buffer(head));
+					bufs.emplace_back(asio::buffer(crlf));
+				}
+
+				if (!open)
+					bufs.emplace_back(asio::buffer(last_chunk));
+				else if (bufs.empty())
+					continue;
+
+				ec = open ? asio::error_code{} : asio::error::eof;
+			}
+
+			deadline.expires_after(opt.write_timeout);
+
+			auto [e2, n2] = co_await asio::async_write(sock, bufs, deadline.bind(asio::use_nothrow_awaitable));
+
+			deadline.expires_never();
+
+			if (deadline.expired())
+			{
+				ec = asio::error::timed_out;
+				break;
+			}
+
+			if (e2)
+			{
+				ec = e2;
+				break;
+			}
+
+			bufs.clear();
+
+			session.update_alive_time();
+		}
+
+		// the hub drops the closed stream when the next event is published.
+		stream->close();
+
+		co_return ec == asio::error::eof ? asio::error_code{} : ec;
+	}
+
+	/**
+	 * @brief Receive the requests from the channel in order, route them and write the responses.
+	 */
+	template<class SessionT, class RouterT, class ChannelT>
+	asio::awaitable<asio::error_code> http_serve_write(SessionT& session, RouterT& router, ChannelT& ch,
+		http_serve_body_signal& signal, asio::connection_deadline& deadline, const http_serve_option& opt)
+	{
+		using request_type = typename SessionT::request_type;
+		using response_type = typename SessionT::response_type;
+
+		auto& sock = session.get_stream();
+
+		asio::error_code result{};
+
+		// the arena of the last request, it's given back after the request was destroyed.
+		http::request_arena* last_arena = nullptr;
+
+		for (;;)
+		{
+			if constexpr (http::is_arena_request_v<request_type>)
+			{
+				if (last_arena)
+					session.arena_pool.release(std::exchange(last_arena, nullptr));
+			}
+
+			auto [ec, status, req, parsed_time, arena, stream_route] = co_await ch.async_receive(asio::as_tuple(asio::use_awaitable));
+
+			last_arena = arena;
+
+			if (ec)
+			{
+				if (status != http::status::unknown)
+				{
+					auto res = http::make_error_page_response(status);
+					res.keep_alive(false);
+
+					deadline.expires_after(opt.write_timeout);
+
+					co_await beast::async_write(sock, response_type(std::move(res)),
+						deadline.bind(asio::use_nothrow_awaitable));
+
+					deadline.expires_never();
+				}
+
+				if (ec != asio::error::eof && ec != http::error::end_of_stream &&
+					ec != asio::experimental::error::channel_closed)
+					result = ec;
+
+				break;
+			}
+
+			response_type rep;
+			bool handled = false;
+			bool handler_timed_out = false;
+
+			auto call_route = [&]() -> asio::awaitable<bool>
+			{
+				if constexpr (is_stream_router<RouterT>)
+				{
+					if (stream_route)
+						co_return co_await router.route_stream(parsed_time, req, rep,
+							*stream_route->body, *stream_route->route, stream_route->params);
+				}
+
+				co_return co_await router.route(parsed_time, req, rep);
+			};
+
+			// the handler is run as a child coroutine which is bound to the deadline, so its
+			// async operations can be cancelled when it's running too long.
+			if (opt.handler_timeout > std::chrono::steady_clock::duration::zero())
+			{
+				deadline.expires_after(opt.handler_timeout);
+
+				auto [ep, h] = co_await asio::co_spawn(co_await asio::this_coro::executor, call_route(),
+					deadline.bind(asio::as_tuple(asio::use_awaitable)));
+
+				deadline.expires_never();
+
+				handler_timed_out = deadline.expired();
+
+				// the cancelled handler may throw when it goes on to co_await, that's expected.
+				if (ep && !handler_timed_out)
+					std::rethrow_exception(ep);
+
+				handled = h;
+			}
+			else
+			{
+				handled = co_await call_route();
+			}
+
+			// the rest of the body which isn't read by the route is not drained, the connection
+			// is closed after the response.
+			bool body_done = true;
+
+			if constexpr (is_stream_router<RouterT>)
+			{
+				if (stream_route)
+				{
+					body_done = stream_route->body->is_done();
+
+					signal.released = true;
+					signal.timer.cancel();
+				}
+			}
+
+			if (handler_timed_out)
+			{
+				handled = false;
+				rep = http::make_error_page_response(http::status::service_unavailable);
+			}
+			else if (!handled && rep.get_response_header().result() == http::status::unknown)
+			{
+				rep = http::make_error_page_response(http::status::internal_server_error);
+			}
+
+			// the event stream takes over the connection until the stream is closed.
+			if (auto stream = rep.split_event_stream())
+			{
+				result = co_await detail::http_serve_event_stream(session, sock, rep, std::move(stream), deadline, opt);
+				break;
+			}
+
+			bool keep_alive = handled && body_done && req.keep_alive() && rep.keep_alive();
+
+			deadline.expires_after(opt.write_timeout);
+
+			auto [e1, n1] = co_await http::async_write_response(sock, std::move(rep),
+				deadline.bind(asio::use_nothrow_awaitable));
+
+			deadline.expires_never();
+
+			if (deadline.expired())
+			{
+				result = asio::error::timed_out;
+				break;
+			}
+
+			if (e1)
+			{
+				result = e1;
+				break;
+			}
+
+			session.update_alive_time();
+
+			if (!keep_alive)
+				break;
+		}
+
+		if constexpr (http::is_arena_request_v<request_type>)
+		{
+			if (last_arena)
+				session.arena_pool.release(last_arena);
+		}
+
+		// stop the reader, it may be waiting for the socket, the channel or the streaming route.
+		ch.close();
+		signal.timer.cancel();
+
+		asio::error_code ec{};
+		beast::get_lowest_layer(sock).cancel(ec);
+
+		co_return result;
+	}
+
+	/**
+	 * @brief Serve the HTTP/1 connection with the router until it's closed.
+	 * @param buffer - The data which has been read from the stream, eg: by the http2_async_detect.
+	 */
+	template<class SessionT, class RouterT>
+	asio::awaitable<asio::error_code> http_async_serve(SessionT& session, RouterT& router, http_serve_option opt,
+		beast::flat_buffer buffer = {})
+	{
+		using request_type = typename SessionT::request_type;
+
+		asio::error_code ec{};
+
+		{
+			auto ex = co_await asio::this_coro::executor;
+
+			detail::http_serve_channel<request_type, RouterT> ch(ex, opt.pipeline_depth);
+
+			detail::http_serve_body_signal signal{ asio::steady_timer(ex) };
+
+			// the reader and the writer wait for the peer at the same time, each of them has its
+			// own deadline, the deadlines are checked by the sweeper of the thread.
+			asio::connection_deadline read_deadline(ex), write_deadline(ex);
+
+			ec = co_await(
+				detail::http_serve_read(session, router, ch, signal, read_deadline, opt, buffer) &&
+				detail::http_serve_write(session, router, ch, signal, write_deadline, opt));
+		}
+
+		// the requests which were read but not handled are destroyed with the channel.
+		if constexpr (http::is_arena_request_v<request_type>)
+			session.arena_pool.release_all();
+
+		co_return ec;
+	}
+}
@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2017-2023 zhllxt
+ *
+ * author   : zhllxt
+ * email    : 37792738@qq.com
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <asio3/core/asio.hpp>
+#include <asio3/core/beast.hpp>
+
+#ifdef ASIO_STANDALONE
+#include <asio/experimental/concurrent_channel.hpp>
+#else
+#include <boost/asio/experimental/concurrent_channel.hpp>
+#endif
+
+#ifdef ASIO3_HEADER_ONLY
+namespace bho::beast::http
+#else
+namespace boost::beast::http
+#endif
+{
+	/**
+	 * @brief The table of the in-flight requests, the concurrent requests of the same key
+	 * wait for the result of the first one (the leader) instead of all executing the handler.
+	 * It can be used across the threads.
+	 */
+	template<class ValueT>
+	class basic_single_flight
+	{
+	public:
+		using value_type = ValueT;
+		using channel_type = asio::experimental::concurrent_channel<void(asio::error_code)>;
+
+		struct flight
+		{
+			std::string                                key;
+
+			std::mutex                                 mutex;
+
+			bool                                       done = false;
+
+			ValueT                                     value{};
+
+			std::vector<std::shared_ptr<channel_type>> waiters;
+		};
+
+		using flight_ptr = std::shared_ptr<flight>;
+
+		/**
+		 * @brief Finish the flight with an empty value when the leader exits without a result,
+		 * so the waiters are never blocked forever.
+		 */
+		class leader_guard
+		{
+		public:
+			leader_guard() = default;
+
+			leader_guard(basic_single_flight& table, flight_ptr f) : table_(&table), flight_(std::move(f))
+			{
+			}
+
+			leader_guard(leader_guard&& other) noexcept
+				: table_(std::exchange(other.table_, nullptr)), flight_(std::move(other.flight_))
+			{
+			}
+
+			leader_guard& operator=(leader_guard&& other) noexcept
+			{
+				if (this != &other)
+				{
+					this->finish(ValueT{});
+					this->table_ = std::exchange(other.table_, nullptr);
+					this->flight_ = std::move(other.flight_);
+				}
+				return *this;
+			}
+
+			~leader_guard()
+			{
+				this->finish(ValueT{});
+			}
+
+			/**
+			 * @brief Wake up the waiters with the result.
+			 */
+			inline void finish(ValueT value)
+			{
+				if (this->table_ && this->flight_)
+					this->table_->finish(this->flight_, std::move(value));
+
+				this->table_ = nullptr;
+				this->flight_.reset();
+			}
+
+			inline explicit operator bool() const noexcept
+			{
+				return this->flight_ != nullptr;
+			}
+
+		protected:
+			basic_single_flight* table_ = nullptr;
+
+			flight_ptr           flight_;
+		};
+
+		basic_single_flight() = default;
+
+		// the flights in progress are not moved with the table, it must be idle when it's moved.
+		basic_single_flight(basic_single_flight&& other) noexcept : flights_(std::move(other.flights_))
+		{
+		}
+
+		/**
+		 * @brief Join the flight of the key.
+		 * @return The flight, and whether the caller is the leader which must finish it.
+		 */
+		inline std::pair<flight_ptr, bool> join(std::string_view key)
+		{
+			std::lock_guard guard(this->mutex_);
+
+			if (auto it = this->flights_.find(key); it != this->flights_.end())
+				return { it->second, false };
+
+			auto f = std::make_shared<flight>();
+
+			f->key = key;
+
+			this->flights_.emplace(std::string_view(f->key), f);
+
+			return { std::move(f), true };
+		}
+
+		/**
+		 * @brief Remove the flight from the table and wake up all its waiters.
+		 */
+		inline void finish(const flight_ptr& f, ValueT value)
+		{
+			{
+				std::lock_guard guard(this->mutex_);
+
+				if (auto it = this->flights_.find(std::string_view(f->key)); it != this->flights_.end() && it->second == f)
+					this->flights_.erase(it);
+			}
+
+			std::vector<std::shared_ptr<channel_type>> waiters;
+
+			{
+				std::lock_guard guard(f->mutex);
+
+				f->done = true;
+				f->value = std::move(value);
+
+				waiters = std::move(f->waiters);
+			}
+
+			for (auto& ch : waiters)
+			{
+				ch->try_send(asio::error_code{});
+			}
+		}
+
+		/**
+		 * @brief Wait until the leader finishes the flight, and get its result.
+		 */
+		static inline asio::awaitable<ValueT> wait(flight_ptr f)
+		{
+			auto ex = co_await asio::this_coro::executor;
+
+			std::shared_ptr<channel_type> ch;
+
+			{
+				std::lock_guard guard(f->mutex);
+
+				if (f->done)
+					co_return f->value;
+
+				// the capacity is one, so the notify which is sent before the receive isn't lost.
+				ch = std::make_shared<channel_type>(ex, 1);
+
+				f->waiters.emplace_back(ch);
+			}
+
+			co_await ch->async_receive(asio::as_tuple(asio::use_awaitable));
+
+			std::lock_guard guard(f->mutex);
+
+			co_return f->value;
+		}
+
+		/**
+		 * @brief Get the count of the flights in progress.
+		 */
+		inline std::size_t size() const
+		{
+			std::lock_guard guard(this->mutex_);
+
+			return this->flights_.size();
+		}
+
+	protected:
+		mutable std::mutex                                 mutex_;
+
+		std::unordered_map<std::string_view, flight_ptr>   flights_;
+	};
+}
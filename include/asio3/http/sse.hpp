@@ -0,0 +1,478 @@
+/*
+ * Copyright (c) 2017-2023 zhllxt
+ *
+ * author   : zhllxt
+ * email    : 37792738@qq.com
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <charconv>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <asio3/core/asio.hpp>
+#include <asio3/core/beast.hpp>
+
+#ifdef ASIO3_HEADER_ONLY
+namespace bho::beast::http
+#else
+namespace boost::beast::http
+#endif
+{
+	/**
+	 * @brief An event of the Server-Sent Events (the text/event-stream of the html standard).
+	 */
+	struct sse_event
+	{
+		// The data of the event, it's sent as a "data:" line for each line of it.
+		std::string_view data;
+
+		// The type of the event, the "message" type is used by the browser if it's empty.
+		std::string_view event;
+
+		// The id of the event, the browser sends it back in the Last-Event-ID header when
+		// it reconnects.
+		std::string_view id;
+
+		// The reconnection time which is told to the browser.
+		std::optional<std::chrono::milliseconds> retry;
+	};
+
+	/**
+	 * @brief Encode the event into the wire format of the text/event-stream, eg:
+	 * "id: 7\nevent: price\ndata: line1\ndata: line2\n\n".
+	 */
+	inline std::string encode_sse_event(const sse_event& e)
+	{
+		std::string s;
+
+		s.reserve(e.data.size() + e.event.size() + e.id.size() + 32);
+
+		// the line breaks would end the field, they can't be contained in the id or the event.
+		auto field = [&s](std::string_view name, std::string_view value)
+		{
+			s.append(name);
+			s.append(": ");
+			for (char c : value)
+			{
+				if (c != '\r' && c != '\n')
+					s.push_back(c);
+			}
+			s.push_back('\n');
+		};
+
+		if (!e.id.empty())
+			field("id", e.id);
+
+		if (!e.event.empty())
+			field("event", e.event);
+
+		if (e.retry.has_value())
+		{
+			s.append("retry: ");
+			s.append(std::to_string(e.retry->count()));
+			s.push_back('\n');
+		}
+
+		// each of the "\r\n", "\r" and "\n" is a line break of the stream.
+		std::string_view data = e.data;
+		for (;;)
+		{
+			std::size_t pos = data.find_first_of("\r\n");
+
+			s.append("data: ");
+			s.append(data.substr(0, pos));
+			s.push_back('\n');
+
+			if (pos == std::string_view::npos)
+				break;
+
+			if (data[pos] == '\r' && pos + 1 < data.size() && data[pos + 1] == '\n')
+				++pos;
+
+			data.remove_prefix(pos + 1);
+		}
+
+		s.push_back('\n');
+
+		return s;
+	}
+
+	/**
+	 * @brief The queue of the encoded events which are waiting to be sent to one subscriber.
+	 * The events are pushed by the hub from any thread, and are taken by the session which
+	 * serves the event stream. The encoded event is shared by all the queues, it's not copied.
+	 */
+	class sse_stream : public std::enable_shared_from_this<sse_stream>
+	{
+	public:
+		using event_ptr = std::shared_ptr<const std::string>;
+
+		/**
+		 * @brief constructor
+		 * @param ex - The executor of the session which serves the stream.
+		 * @param queue_limit - The stream is closed if more events than this are waiting,
+		 *                      the client is too slow and it will reconnect with Last-Event-ID.
+		 */
+		explicit sse_stream(const auto& ex, std::size_t queue_limit = 1024)
+			: timer_(ex), limit_(queue_limit)
+		{
+		}
+
+		/**
+		 * @brief Append the encoded event to the queue, it's safe to be called in any thread.
+		 * @return false if the stream is closed.
+		 */
+		inline bool push(event_ptr e)
+		{
+			std::lock_guard g{ this->mutex_ };
+
+			if (this->closed_)
+				return false;
+
+			if (this->queue_.size() >= this->limit_)
+			{
+				this->queue_.clear();
+				this->closed_ = true;
+				this->wake();
+				return false;
+			}
+
+			this->queue_.emplace_back(std::move(e));
+			this->wake();
+			return true;
+		}
+
+		/**
+		 * @brief Close the stream, the events which are waiting are still sent.
+		 * It's safe to be called in any thread.
+		 */
+		inline void close()
+		{
+			std::lock_guard g{ this->mutex_ };
+
+			this->closed_ = true;
+			this->wake();
+		}
+
+		inline bool is_open()
+		{
+			std::lock_guard g{ this->mutex_ };
+
+			return !this->closed_;
+		}
+
+		/**
+		 * @brief Wait until some events are pushed, or the stream is closed, or the timeout
+		 * has elapsed. The waiting events are moved into the vector.
+		 * @return false if the stream is closed and all the events have been taken.
+		 */
+		asio::awaitable<bool> async_fetch(std::vector<event_ptr>& events, std::chrono::steady_clock::duration timeout)
+		{
+			{
+				std::lock_guard g{ this->mutex_ };
+
+				if (!this->queue_.empty() || this->closed_)
+					co_return this->take(events);
+
+				this->waiting_ = true;
+			}
+
+			this->timer_.expires_after(timeout);
+
+			co_await this->timer_.async_wait(asio::use_nothrow_awaitable);
+
+			std::lock_guard g{ this->mutex_ };
+
+			this->waiting_ = false;
+
+			co_return this->take(events);
+		}
+
+	protected:
+		inline bool take(std::vector<event_ptr>& events)
+		{
+			events.insert(events.end(),
+				std::make_move_iterator(this->queue_.begin()), std::make_move_iterator(this->queue_.end()));
+
+			this->queue_.clear();
+
+			return !(this->closed_ && events.empty());
+		}
+
+		// the timer can only be cancelled in the thread of the session.
+		inline void wake()
+		{
+			if (!this->waiting_)
+				return;
+
+			this->waiting_ = false;
+
+			asio::post(this->timer_.get_executor(), [self = this->shared_from_this()]() mutable
+			{
+				self->timer_.cancel();
+			});
+		}
+
+	protected:
+		asio::steady_timer     timer_;
+
+		std::mutex             mutex_;
+
+		std::deque<event_ptr>  queue_;
+
+		std::size_t            limit_ = 1024;
+
+		bool                   waiting_ = false;
+
+		bool                   closed_ = false;
+	};
+
+	/**
+	 * @brief The body of the event stream response, the events of the stream are sent by the
+	 * serve loop of the session after the header, see @ref make_sse_response.
+	 * If the response is written by other ways, only the header is sent.
+	 */
+	struct sse_body
+	{
+		using value_type = std::shared_ptr<sse_stream>;
+
+		class writer
+		{
+		public:
+			using const_buffers_type = asio::const_buffer;
+
+			template<bool isRequest, class Fields>
+			writer(http::header<isRequest, Fields>&, value_type&)
+			{
+			}
+
+			inline void init(error_code& ec)
+			{
+				ec = {};
+			}
+
+			inline std::optional<std::pair<const_buffers_type, bool>> get(error_code& ec)
+			{
+				ec = {};
+				return std::nullopt;
+			}
+		};
+	};
+
+	/**
+	 * @brief Make the response which switches the session into the text/event-stream mode,
+	 * the events of the stream are sent chunked until the stream or the connection is closed.
+	 */
+	inline http::response<http::sse_body> make_sse_response(std::shared_ptr<sse_stream> stream)
+	{
+		http::response<http::sse_body> rep{ http::status::ok, 11 };
+
+		rep.set(http::field::server, BEAST_VERSION_STRING);
+		rep.set(http::field::content_type, "text/event-stream");
+		rep.set(http::field::cache_control, "no-cache");
+
+		// tell the reverse proxy (nginx) not to buffer the events.
+		rep.set("X-Accel-Buffering", "no");
+
+		rep.body() = std::move(stream);
+		rep.chunked(true);
+
+		return rep;
+	}
+
+	/**
+	 * @brief A hub of the event channels, each event is encoded once and the encoded buffer
+	 * is shared by all the subscribers of the channel. The recent events of each channel are
+	 * kept in a bounded ring, so the client which reconnects with the Last-Event-ID gets the
+	 * events it has missed. The hub can be used in any thread.
+	 * eg:
+	 *   server.router.add("/events", [&hub](http::web_request& req, http::web_response& rep)
+	 *   -> net::awaitable<bool>
+	 *   {
+	 *       rep = http::make_sse_response(hub.subscribe(co_await net::this_coro::executor, "news", req));
+	 *       co_return true;
+	 *   });
+	 *
+	 *   hub.publish("news", "hello");
+	 */
+	class sse_hub
+	{
+	public:
+		using event_ptr = sse_stream::event_ptr;
+
+		/**
+		 * @brief constructor
+		 * @param history_size - How many recent events of each channel are kept for the replay.
+		 * @param queue_limit - The max count of the events waiting to be sent to a subscriber.
+		 */
+		explicit sse_hub(std::size_t history_size = 256, std::size_t queue_limit = 1024)
+			: history_size_(history_size), queue_limit_(queue_limit)
+		{
+		}
+
+		/**
+		 * @brief Subscribe the channel, the events after the last event id are replayed if
+		 * they are still in the history of the channel.
+		 * @param ex - The executor of the session which serves the stream.
+		 */
+		std::shared_ptr<sse_stream> subscribe(const auto& ex, std::string_view channel, std::string_view last_event_id = {})
+		{
+			auto stream = std::make_shared<sse_stream>(ex, (std::max)(this->queue_limit_, this->history_size_));
+
+			std::optional<std::uint64_t> last;
+
+			if (std::uint64_t n = 0; !last_event_id.empty() &&
+				std::from_chars(last_event_id.data(), last_event_id.data() + last_event_id.size(), n).ec == std::errc{})
+				last = n;
+
+			std::lock_guard g{ this->mutex_ };
+
+			auto& ch = this->get_channel(channel);
+
+			// the ids which are beyond the last one are from the other run of the server.
+			if (last.has_value() && *last < ch.next_id)
+			{
+				for (auto& [id, e] : ch.history)
+				{
+					if (id > *last)
+						stream->push(e);
+				}
+			}
+
+			ch.subscribers.emplace_back(stream);
+
+			return stream;
+		}
+
+		/**
+		 * @brief Subscribe the channel, the last event id is taken from the Last-Event-ID header.
+		 */
+		template<bool isRequest, class Body, class Fields>
+		std::shared_ptr<sse_stream> subscribe(
+			const auto& ex, std::string_view channel, const http::message<isRequest, Body, Fields>& req)
+		{
+			std::string_view last_event_id;
+
+			if (auto it = req.find("Last-Event-ID"); it != req.end())
+				last_event_id = it->value();
+
+			return this->subscribe(ex, channel, last_event_id);
+		}
+
+		/**
+		 * @brief Publish the event to all the subscribers of the channel.
+		 * The id of the event is assigned by the hub, it's increased in each channel.
+		 * @return The id of the event.
+		 */
+		std::uint64_t publish(std::string_view channel, std::string_view data, std::string_view event = {})
+		{
+			std::lock_guard g{ this->mutex_ };
+
+			auto& ch = this->get_channel(channel);
+
+			std::uint64_t id = ch.next_id++;
+
+			char buf[24]{};
+			auto [p, ec] = std::to_chars(buf, buf + sizeof(buf), id);
+
+			event_ptr e = std::make_shared<const std::string>(http::encode_sse_event(
+				http::sse_event{ .data = data, .event = event, .id = std::string_view(buf, p - buf) }));
+
+			if (this->history_size_ > 0)
+			{
+				if (ch.history.size() >= this->history_size_)
+					ch.history.pop_front();
+
+				ch.history.emplace_back(id, e);
+			}
+
+			std::erase_if(ch.subscribers, [&e](const std::weak_ptr<sse_stream>& w)
+			{
+				auto stream = w.lock();
+				return !stream || !stream->push(e);
+			});
+
+			return id;
+		}
+
+		/**
+		 * @brief Get the count of the subscribers of the channel.
+		 */
+		std::size_t subscriber_count(std::string_view channel)
+		{
+			std::lock_guard g{ this->mutex_ };
+
+			auto it = this->channels_.find(channel);
+			if (it == this->channels_.end())
+				return 0;
+
+			std::erase_if(it->second.subscribers, [](const std::weak_ptr<sse_stream>& w)
+			{
+				auto stream = w.lock();
+				return !stream || !stream->is_open();
+			});
+
+			return it->second.subscribers.size();
+		}
+
+		/**
+		 * @brief Close the streams of all the subscribers, eg: when the server is stopping.
+		 */
+		void close()
+		{
+			std::lock_guard g{ this->mutex_ };
+
+			for (auto& [name, ch] : this->channels_)
+			{
+				for (auto& w : ch.subscribers)
+				{
+					if (auto stream = w.lock())
+						stream->close();
+				}
+
+				ch.subscribers.clear();
+			}
+		}
+
+	protected:
+		struct channel_state
+		{
+			std::uint64_t                                     next_id = 1;
+
+			std::deque<std::pair<std::uint64_t, event_ptr>>   history;
+
+			std::vector<std::weak_ptr<sse_stream>>            subscribers;
+		};
+
+		inline channel_state& get_channel(std::string_view channel)
+		{
+			auto it = this->channels_.find(channel);
+			if (it == this->channels_.end())
+				it = this->channels_.emplace(std::string(channel), channel_state{}).first;
+			return it->second;
+		}
+
+	protected:
+		std::mutex                                         mutex_;
+
+		std::map<std::string, channel_state, std::less<>>  channels_;
+
+		std::size_t                                        history_size_ = 256;
+
+		std::size_t                                        queue_limit_ = 1024;
+	};
+}
@@ -10,7 +10,17 @@
 
 #pragma once
 
-#include <asio3/http/util.hpp>
+#include <cstring>
+#include <array>
+#include <vector>
+#include <string>
+#include <string_view>
+
+#include <asio3/core/asio.hpp>
+#include <asio3/core/beast.hpp>
+#include <asio3/core/strutil.hpp>
+
+#include <asio3/http/detail/parser.h>
 
 #ifdef ASIO3_HEADER_ONLY
 namespace bho::beast::http
@@ -18,6 +28,404 @@ namespace bho::beast::http
 namespace boost::beast::http
 #endif
 {
+	struct query_param
+	{
+		std::string_view name;
+		std::string_view value;
+	};
+
+	/**
+	 * @brief The view of the query string like "a=1&b=x%20y&c", the parameters are split and
+	 * percent-decoded on the first lookup only, and kept in a small flat index. The names and
+	 * values are views into the query string, the decoded buffer is allocated only when some
+	 * parameter is percent encoded, and the index is allocated only when the count of the
+	 * parameters is greater than the Capacity.
+	 * The query string must outlive the object, and the object can't be copied.
+	 */
+	template<std::size_t Capacity>
+	class basic_query_view
+	{
+	public:
+		using value_type = query_param;
+		using const_iterator = const value_type*;
+
+		basic_query_view() = default;
+		~basic_query_view() = default;
+
+		/**
+		 * @brief constructor, the leading '?' is ignored.
+		 */
+		explicit basic_query_view(std::string_view query) noexcept : query_(query)
+		{
+			if (!this->query_.empty() && this->query_.front() == '?')
+				this->query_.remove_prefix(1);
+		}
+
+		basic_query_view(const basic_query_view&) = delete;
+		basic_query_view& operator=(const basic_query_view&) = delete;
+
+		/**
+		 * @brief Gets the undecoded query string.
+		 */
+		[[nodiscard]] inline std::string_view query() const noexcept
+		{
+			return this->query_;
+		}
+
+		[[nodiscard]] inline std::size_t size() const
+		{
+			return this->index().size_;
+		}
+
+		[[nodiscard]] inline bool empty() const
+		{
+			return this->size() == 0;
+		}
+
+		[[nodiscard]] inline const_iterator begin() const
+		{
+			return this->index().data_;
+		}
+
+		[[nodiscard]] inline const_iterator end() const
+		{
+			const basic_query_view& ix = this->index();
+			return ix.data_ + ix.size_;
+		}
+
+		[[nodiscard]] inline bool contains(std::string_view name) const
+		{
+			return this->find(name) != this->end();
+		}
+
+		/**
+		 * @brief Return the number of the parameters with the name, eg: "id=1&id=2".
+		 */
+		[[nodiscard]] inline std::size_t count(std::string_view name) const
+		{
+			return static_cast<std::size_t>(std::count_if(this->begin(), this->end(),
+				[name](const value_type& v) { return v.name == name; }));
+		}
+
+		/**
+		 * @brief Find the first parameter with the name.
+		 */
+		[[nodiscard]] inline const_iterator find(std::string_view name) const
+		{
+			return std::find_if(this->begin(), this->end(),
+				[name](const value_type& v) { return v.name == name; });
+		}
+
+		/**
+		 * @brief Get the decoded value of the first parameter with the name, return empty
+		 * string if not found.
+		 */
+		[[nodiscard]] inline std::string_view operator[](std::string_view name) const
+		{
+			auto it = this->find(name);
+			return it == this->end() ? std::string_view{} : it->value;
+		}
+
+		/**
+		 * @brief Get the decoded value by the position of the parameter in the query.
+		 */
+		[[nodiscard]] inline std::string_view at(std::size_t index) const
+		{
+			const basic_query_view& ix = this->index();
+			return index < ix.size_ ? ix.data_[index].value : std::string_view{};
+		}
+
+	protected:
+		inline static bool is_encoded(std::string_view s) noexcept
+		{
+			return s.find_first_of("%+") != std::string_view::npos;
+		}
+
+		inline static int hex_value(char c) noexcept
+		{
+			if (c >= '0' && c <= '9') return c - '0';
+			if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+			if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+			return -1;
+		}
+
+		/*
+		 * Decode the s into the tail of the decoded buffer, same as http::url_decode.
+		 * The buffer is reserved with the size of the query, and the decoded string is never
+		 * longer than the source, so the views of the buffer are never invalidated.
+		 */
+		inline std::string_view decode(std::string_view s) const
+		{
+			if (!is_encoded(s))
+				return s;
+
+			if (this->decoded_.capacity() < this->query_.size())
+				this->decoded_.reserve(this->query_.size());
+
+			std::size_t offset = this->decoded_.size();
+
+			for (std::size_t i = 0; i < s.size(); ++i)
+			{
+				char c = s[i];
+
+				if (c == '%' && i + 2 < s.size() && hex_value(s[i + 1]) >= 0 && hex_value(s[i + 2]) >= 0)
+				{
+					this->decoded_ += static_cast<char>(hex_value(s[i + 1]) * 16 + hex_value(s[i + 2]));
+					i += 2;
+				}
+				else
+				{
+					this->decoded_ += (c == '+' ? ' ' : c);
+				}
+			}
+
+			return std::string_view{ this->decoded_.data() + offset, this->decoded_.size() - offset };
+		}
+
+		inline const basic_query_view& index() const
+		{
+			if (this->indexed_)
+				return *this;
+
+			this->indexed_ = true;
+
+			if (this->query_.empty())
+				return *this;
+
+			std::size_t n = static_cast<std::size_t>(std::count(this->query_.begin(), this->query_.end(), '&')) + 1;
+
+			if (n > Capacity)
+			{
+				this->overflow_.resize(n);
+				this->data_ = this->overflow_.data();
+			}
+
+			for (std::string_view q = this->query_; ;)
+			{
+				auto pos = q.find('&');
+
+				std::string_view kv = q.substr(0, pos);
+
+				if (!kv.empty())
+				{
+					auto eq = kv.find('=');
+
+					value_type& v = this->data_[this->size_++];
+
+					v.name  = this->decode(kv.substr(0, eq));
+					v.value = (eq == std::string_view::npos ? std::string_view{} : this->decode(kv.substr(eq + 1)));
+				}
+
+				if (pos == std::string_view::npos)
+					break;
+
+				q.remove_prefix(pos + 1);
+			}
+
+			return *this;
+		}
+
+	protected:
+		std::string_view                      query_;
+
+		mutable std::array<value_type, Capacity> items_{};
+
+		mutable std::vector<value_type>       overflow_;
+
+		mutable value_type*                   data_ = items_.data();
+
+		mutable std::size_t                   size_ = 0;
+
+		mutable std::string                   decoded_;
+
+		mutable bool                          indexed_ = false;
+	};
+
+	using query_view = basic_query_view<16>;
+
+	/**
+	 * @brief The view of a url string or a request target, the url is parsed only once into the
+	 * offsets of the sections, and all the sections are returned as the views of the url.
+	 * <scheme>://<user>:<password>@<host>:<port>/<path>;<params>?<query>#<fragment>
+	 * The url string must outlive the object.
+	 */
+	class url_view
+	{
+	public:
+		/**
+		 * @brief constructor
+		 */
+		url_view() noexcept
+		{
+			std::memset((void*)(std::addressof(parser_)), 0, sizeof(http::parses::http_parser_url));
+		}
+
+		/**
+		 * @brief constructor, use reset to get the parse error.
+		 */
+		explicit url_view(std::string_view str) noexcept
+		{
+			this->reset(str);
+		}
+
+		/**
+		 * @brief constructor with the parsed offsets, nothing is parsed.
+		 */
+		url_view(std::string_view str, const http::parses::http_parser_url& parser) noexcept
+			: string_(str), parser_(parser)
+		{
+		}
+
+		url_view(url_view&&) noexcept = default;
+		url_view(url_view const&) noexcept = default;
+		url_view& operator=(url_view&&) noexcept = default;
+		url_view& operator=(url_view const&) noexcept = default;
+
+		error_code reset(std::string_view str) noexcept
+		{
+			string_ = str;
+
+			std::memset((void*)(std::addressof(parser_)), 0, sizeof(http::parses::http_parser_url));
+
+			if (string_.empty())
+			{
+				return asio::error::invalid_argument;
+			}
+
+			if (0 != http::parses::http_parser_parse_url(
+				string_.data(), string_.size(), 0, std::addressof(parser_)))
+			{
+				std::memset((void*)(std::addressof(parser_)), 0, sizeof(http::parses::http_parser_url));
+
+				return asio::error::invalid_argument;
+			}
+
+			return {};
+		}
+
+		/**
+		 * @brief Gets the content of the "schema" section, maybe empty
+		 */
+		inline std::string_view schema() const noexcept
+		{
+			return this->field(http::parses::url_fields::UF_SCHEMA);
+		}
+
+		/**
+		 * @brief Gets the content of the "host" section, maybe empty
+		 */
+		inline std::string_view host() const noexcept
+		{
+			return this->field(http::parses::url_fields::UF_HOST);
+		}
+
+		/**
+		 * @brief Gets the default port of the schema, "443" for https, otherwise "80".
+		 */
+		inline std::string_view default_port() const noexcept
+		{
+			if (asio::iequals(this->schema(), "https"))
+				return std::string_view{ "443" };
+			return std::string_view{ "80" };
+		}
+
+		/**
+		 * @brief Gets the content of the "port" section, or the default port of the schema.
+		 */
+		inline std::string_view port() const noexcept
+		{
+			std::string_view p = this->field(http::parses::url_fields::UF_PORT);
+			if (p.empty())
+				return this->default_port();
+			return p;
+		}
+
+		/**
+		 * @brief Gets the content of the "path" section, "/" if the path is empty.
+		 * the return value maybe has undecoded char, you can use http::url_decode(...) to decoded it.
+		 */
+		inline std::string_view path() const noexcept
+		{
+			std::string_view p = this->field(http::parses::url_fields::UF_PATH);
+			if (p.empty())
+				return std::string_view{ "/" };
+			return p;
+		}
+
+		/**
+		 * @brief Gets the content of the "query" section, maybe empty
+		 * the return value maybe has undecoded char, use params() to get the decoded values.
+		 */
+		inline std::string_view query() const noexcept
+		{
+			return this->field(http::parses::url_fields::UF_QUERY);
+		}
+
+		/**
+		 * @brief Gets the content of the "fragment" section, maybe empty
+		 */
+		inline std::string_view fragment() const noexcept
+		{
+			return this->field(http::parses::url_fields::UF_FRAGMENT);
+		}
+
+		/**
+		 * @brief Gets the content of the "userinfo" section, maybe empty
+		 */
+		inline std::string_view userinfo() const noexcept
+		{
+			return this->field(http::parses::url_fields::UF_USERINFO);
+		}
+
+		/**
+		 * @brief Gets the "target", which composed by path and query
+		 * the return value maybe has undecoded char, you can use http::url_decode(...) to decoded it.
+		 */
+		inline std::string_view target() const noexcept
+		{
+			if (parser_.field_set & (1 << (int)http::parses::url_fields::UF_PATH))
+			{
+				return string_.substr(parser_.field_data[(int)http::parses::url_fields::UF_PATH].off);
+			}
+
+			return std::string_view{ "/" };
+		}
+
+		/**
+		 * @brief Gets the parameters of the "query" section, which are decoded on the first lookup.
+		 */
+		inline query_view params() const noexcept
+		{
+			return query_view{ this->query() };
+		}
+
+		/**
+		 * @brief Gets the content of the specific section, maybe empty
+		 */
+		inline std::string_view field(http::parses::url_fields f) const noexcept
+		{
+			if (!(parser_.field_set & (1 << int(f))))
+				return std::string_view{};
+
+			return string_.substr(parser_.field_data[int(f)].off, parser_.field_data[int(f)].len);
+		}
+
+		/**
+		 * @brief Returns true if the url is parsed successfully.
+		 */
+		inline bool valid() const noexcept
+		{
+			return parser_.field_set != 0;
+		}
+
+		inline std::string_view                           string() const noexcept { return this->string_; }
+		inline http::parses::http_parser_url const&       parser() const noexcept { return this->parser_; }
+
+	protected:
+		std::string_view                      string_;
+		http::parses::http_parser_url         parser_;
+	};
+
 	/**
 	 * The object wrapped for a url string like "http://www.github.com"
 	 * <scheme>://<user>:<password>@<host>:<port>/<path>;<params>?<query>#<fragment>
@@ -124,12 +532,7 @@ namespace boost::beast::http
 
 		inline std::string_view get_default_port() const noexcept
 		{
-			std::string_view schema = this->schema();
-			if (asio::iequals(schema, "http"))
-				return std::string_view{ "80" };
-			if (asio::iequals(schema, "https"))
-				return std::string_view{ "443" };
-			return std::string_view{ "80" };
+			return this->view().default_port();
 		}
 
 		inline std::string_view default_port() const noexcept
@@ -142,10 +545,7 @@ namespace boost::beast::http
 		 */
 		inline std::string_view get_port() const noexcept
 		{
-			std::string_view p = this->field(http::parses::url_fields::UF_PORT);
-			if (p.empty())
-				return this->default_port();
-			return p;
+			return this->view().port();
 		}
 
 		/**
@@ -163,10 +563,7 @@ namespace boost::beast::http
 		 */
 		inline std::string_view get_path() const noexcept
 		{
-			std::string_view p = this->field(http::parses::url_fields::UF_PATH);
-			if (p.empty())
-				return std::string_view{ "/" };
-			return p;
+			return this->view().path();
 		}
 
 		/**
@@ -204,15 +601,7 @@ namespace boost::beast::http
 		 */
 		inline std::string_view get_target() const noexcept
 		{
-			if (parser_.field_set & (1 << (int)http::parses::url_fields::UF_PATH))
-			{
-				return std::string_view{ &string_[
-					parser_.field_data[(int)http::parses::url_fields::UF_PATH].off],
-					string_.size() -
-					parser_.field_data[(int)http::parses::url_fields::UF_PATH].off };
-			}
-
-			return std::string_view{ "/" };
+			return this->view().target();
 		}
 
 		/**
@@ -230,10 +619,7 @@ namespace boost::beast::http
 		 */
 		inline std::string_view get_field(http::parses::url_fields f) const noexcept
 		{
-			if (!(parser_.field_set & (1 << int(f))))
-				return std::string_view{};
-
-			return std::string_view{ &string_[parser_.field_data[int(f)].off], parser_.field_data[int(f)].len };
+			return this->view().field(f);
 		}
 
 		/**
@@ -245,6 +631,23 @@ namespace boost::beast::http
 			return this->get_field(std::move(f));
 		}
 
+		/**
+		 * @brief Gets the view of the url, the url is not parsed again.
+		 */
+		inline url_view view() const noexcept
+		{
+			return url_view{ this->string_, this->parser_ };
+		}
+
+		/**
+		 * @brief Gets the parameters of the "query" section, which are decoded on the first lookup.
+		 * The url must outlive the returned object.
+		 */
+		inline query_view params() const noexcept
+		{
+			return query_view{ this->get_query() };
+		}
+
 		inline http::parses::http_parser_url &     parser() noexcept { return this->parser_; }
 		inline std::string                   &     string() noexcept { return this->string_; }
 		inline http::parses::http_parser_url & get_parser() noexcept { return this->parser_; }
@@ -26,6 +26,7 @@
 
 #include <asio3/http/detail/parser.h>
 #include <asio3/http/mime_types.hpp>
+#include <asio3/http/url.hpp>
 #include <asio3/http/multipart.hpp>
 
 #ifdef ASIO3_HEADER_ONLY
@@ -384,87 +385,49 @@ namespace boost::beast::http
 		return false;
 	}
 
+	/**
+	 * @brief Gets the host of the url, maybe empty.
+	 * Use http::url_view to get several sections of the url with one parse.
+	 */
 	template<typename = void>
 	std::string_view url_to_host(std::string_view url)
 	{
-		if (url.empty())
-			return std::string_view{};
-
-		http::parses::http_parser_url u;
-		if (0 != http::parses::http_parser_parse_url(url.data(), url.size(), 0, std::addressof(u)))
-			return std::string_view{};
-
-		if (!(u.field_set & (1 << (int)http::parses::url_fields::UF_HOST)))
-			return std::string_view{};
-
-		return std::string_view{ &url[
-			u.field_data[(int)http::parses::url_fields::UF_HOST].off],
-			u.field_data[(int)http::parses::url_fields::UF_HOST].len };
+		return http::url_view{ url }.host();
 	}
 
+	/**
+	 * @brief Gets the port of the url, or the default port of the schema, empty if the url is invalid.
+	 */
 	template<typename = void>
 	std::string_view url_to_port(std::string_view url)
 	{
-		if (url.empty())
-			return std::string_view{};
-
-		http::parses::http_parser_url u;
-		if (0 != http::parses::http_parser_parse_url(url.data(), url.size(), 0, std::addressof(u)))
+		http::url_view v{ url };
+		if (!v.valid())
 			return std::string_view{};
 
-		if (u.field_set & (1 << (int)http::parses::url_fields::UF_PORT))
-			return std::string_view{ &url[
-				u.field_data[(int)http::parses::url_fields::UF_PORT].off],
-				u.field_data[(int)http::parses::url_fields::UF_PORT].len };
-
-		if (u.field_set & (1 << (int)http::parses::url_fields::UF_SCHEMA))
-		{
-			std::string_view schema(&url[
-				u.field_data[(int)http::parses::url_fields::UF_SCHEMA].off],
-				u.field_data[(int)http::parses::url_fields::UF_SCHEMA].len);
-			if (asio::iequals(schema, "http"))
-				return std::string_view{ "80" };
-			if (asio::iequals(schema, "https"))
-				return std::string_view{ "443" };
-		}
-
-		return std::string_view{ "80" };
+		return v.port();
 	}
 
+	/**
+	 * @brief Gets the path of the url, "/" if the path is empty, empty if the url is invalid.
+	 */
 	template<typename = void>
 	std::string_view url_to_path(std::string_view url)
 	{
-		if (url.empty())
+		http::url_view v{ url };
+		if (!v.valid())
 			return std::string_view{};
 
-		http::parses::http_parser_url u;
-		if (0 != http::parses::http_parser_parse_url(url.data(), url.size(), 0, std::addressof(u)))
-			return std::string_view{};
-
-		if (!(u.field_set & (1 << (int)http::parses::url_fields::UF_PATH)))
-			return std::string_view{ "/" };
-
-		return std::string_view{ &url[
-			u.field_data[(int)http::parses::url_fields::UF_PATH].off],
-			u.field_data[(int)http::parses::url_fields::UF_PATH].len };
+		return v.path();
 	}
 
+	/**
+	 * @brief Gets the query of the url, maybe empty.
+	 */
 	template<typename = void>
 	std::string_view url_to_query(std::string_view url)
 	{
-		if (url.empty())
-			return std::string_view{};
-
-		http::parses::http_parser_url u;
-		if (0 != http::parses::http_parser_parse_url(url.data(), url.size(), 0, std::addressof(u)))
-			return std::string_view{};
-
-		if (!(u.field_set & (1 << (int)http::parses::url_fields::UF_QUERY)))
-			return std::string_view{};
-
-		return std::string_view{ &url[
-			u.field_data[(int)http::parses::url_fields::UF_QUERY].off],
-			u.field_data[(int)http::parses::url_fields::UF_QUERY].len };
+		return http::url_view{ url }.query();
 	}
 
 	template<typename = void>
@@ -512,7 +475,7 @@ namespace boost::beast::http
 	template<class HttpMessage, class String = std::string>
 	inline basic_multipart_fields<String> get_multipart(const HttpMessage& msg)
 	{
-		return multipart_parser_execute(msg);
+		return multipart_parser_execute<String>(msg);
 	}
 
 	template<typename T>
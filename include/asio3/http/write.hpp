@@ -18,7 +18,9 @@
 #include <asio3/core/asio_buffer_specialization.hpp>
 #include <asio3/core/data_persist.hpp>
 #include <asio3/core/file.hpp>
+#include <asio3/tcp/write.hpp>
 #include <asio3/http/mime_types.hpp>
+#include <asio3/http/advanced_message_generator.hpp>
 
 #ifdef ASIO_STANDALONE
 namespace asio::detail
@@ -56,6 +58,65 @@ namespace bho::beast::http::detail
 namespace boost::beast::http::detail
 #endif
 {
+	// sendfile is only used on the plain tcp sockets, the tls streams must encrypt the data in
+	// the user space. the io_uring backend doesn't put the sockets in the non-blocking mode,
+	// so sendfile isn't used with it.
+	template<typename T, typename U = std::remove_cvref_t<T>>
+	concept is_sendfile_socket =
+	#if defined(__linux__) && !defined(ASIO3_ENABLE_IO_URING)
+		asio::is_basic_stream_socket<U> && asio::is_tcp_socket<U>;
+	#else
+		false;
+	#endif
+
+	struct no_chunk_callback
+	{
+		inline bool operator()(std::string_view) const noexcept
+		{
+			return true;
+		}
+	};
+
+	/**
+	 * @brief Serialize the header only, the serializer must not have produced any data yet.
+	 */
+	template<class SerializerT>
+	std::string serialize_header(SerializerT& sr, error_code& ec)
+	{
+		std::string head;
+
+		sr.split(true);
+
+		while (!ec && !sr.is_header_done())
+		{
+			sr.next(ec, [&sr, &head](error_code& ec, const auto& buffers) mutable
+			{
+				ec = {};
+
+				std::size_t n = 0;
+				for (auto it = asio::buffer_sequence_begin(buffers); it != asio::buffer_sequence_end(buffers); ++it)
+				{
+					asio::const_buffer b = *it;
+					head.append(static_cast<const char*>(b.data()), b.size());
+					n += b.size();
+				}
+
+				sr.consume(n);
+			});
+		}
+
+		return head;
+	}
+
+	// the data sent with MSG_MORE is held by the kernel until the next send without it, so the
+	// header and the first part of the body are sent in the same segments.
+	inline constexpr asio::socket_base::message_flags msg_more =
+	#if defined(__linux__)
+		MSG_MORE;
+	#else
+		0;
+	#endif
+
 	template<bool isRequest, typename Body, typename Fields>
 	struct async_send_file_op
 	{
@@ -89,6 +150,45 @@ namespace boost::beast::http::detail
 
 			[[maybe_unused]] asio::defer_unlock defered_unlock{ sock };
 
+			// On a plain tcp socket, the body is sent by the kernel from the page cache with
+			// sendfile, instead of being read into the user space buffer chunk by chunk. The
+			// header is sent with MSG_MORE so it's coalesced with the first part of the body.
+			// It isn't used with the chunk callback, the callback needs the data of the body.
+			if constexpr (detail::is_sendfile_socket<decltype(sock)> &&
+				std::same_as<std::decay_t<decltype(chunk_callback)>, detail::no_chunk_callback> &&
+				requires { file.native_handle(); file.size(ec); file.seek(0, asio::file_base::seek_cur, ec); })
+			{
+				std::uint64_t offset = file.seek(0, asio::file_base::seek_cur, ec);
+				std::uint64_t size = ec ? 0 : file.size(ec);
+
+				if (!ec && !msg.chunked() && size > offset)
+				{
+					std::string head = detail::serialize_header(sr, ec);
+					if (ec)
+						co_return{ ec, sent_bytes };
+
+					for (asio::const_buffer b = asio::buffer(head); b.size() > 0;)
+					{
+						auto [e5, n5] = co_await sock.async_send(b, detail::msg_more, asio::use_deferred_executor(sock));
+						sent_bytes += n5;
+						if (e5)
+							co_return{ e5, sent_bytes };
+						b += n5;
+					}
+
+					auto [e6, n6] = co_await asio::async_sendfile(
+						sock, file.native_handle(), offset, size - offset, asio::use_deferred_executor(sock));
+					sent_bytes += n6;
+
+					// keep the position of the file stream as if the body was read from it.
+					file.seek(static_cast<std::int64_t>(offset + n6), asio::file_base::seek_set, ec);
+
+					co_return{ e6, sent_bytes };
+				}
+
+				ec = {};
+			}
+
 			auto [e2, n2] = co_await http::async_write_header(sock, sr, asio::use_deferred_executor(sock));
 			if (e2)
 			{
@@ -159,6 +259,56 @@ namespace boost::beast::http::detail
 			co_return{ error_code{}, sent_bytes };
         }
 	};
+
+	struct async_write_response_op
+	{
+		auto operator()(auto state, auto sock_ref, auto&& response) -> void
+		{
+			auto& sock = sock_ref.get();
+
+			auto rep = std::forward_like<decltype(response)>(response);
+
+			co_await asio::dispatch(asio::use_deferred_executor(sock));
+
+			state.reset_cancellation_state(asio::enable_terminal_cancellation());
+
+			if constexpr (detail::is_sendfile_socket<decltype(sock)>)
+			{
+				// an empty body is written by the serializer, otherwise the header which is sent
+				// with MSG_MORE would be held until the cork timeout of the kernel.
+				if (auto range = rep.split_file_body(); range && range->size > 0)
+				{
+					std::size_t sent_bytes = 0;
+
+					while (!rep.is_header_done())
+					{
+						error_code ec{};
+
+						auto buffers = rep.prepare(ec);
+						if (ec)
+							co_return{ ec, sent_bytes };
+
+						auto [e1, n1] = co_await sock.async_send(
+							buffers, detail::msg_more, asio::use_deferred_executor(sock));
+						sent_bytes += n1;
+						if (e1)
+							co_return{ e1, sent_bytes };
+
+						rep.consume(n1);
+					}
+
+					auto [e2, n2] = co_await asio::async_sendfile(
+						sock, range->native_handle, range->offset, range->size, asio::use_deferred_executor(sock));
+
+					co_return{ e2, sent_bytes + n2 };
+				}
+			}
+
+			auto [e3, n3] = co_await beast::async_write(sock, std::move(rep), asio::use_deferred_executor(sock));
+
+			co_return{ e3, n3 };
+		}
+	};
 }
 
 #ifdef ASIO_STANDALONE
@@ -270,7 +420,34 @@ inline auto async_send_file(
 		token,
 		std::ref(stream),
 		std::ref(file),
-		[](auto) { return true; });
+		detail::no_chunk_callback{});
+}
+
+/**
+ * @brief Start an asynchronous operation to write the response to a stream.
+ * If the stream is a plain tcp socket and the response is a file response (eg: the result of
+ * make_native_file_response), the body is sent with sendfile, otherwise it's same as beast::async_write.
+ * @param stream - The socket stream to which the response is to be written.
+ * @param rep - The response.
+ * @param token - The completion handler to invoke when the operation completes.
+ *	  The equivalent function signature of the handler must be:
+ *    @code
+ *    void handler(const asio::error_code& ec, std::size_t sent_bytes);
+ */
+template<
+	typename AsyncStream,
+	typename WriteToken = asio::default_token_type<AsyncStream>>
+inline auto async_write_response(
+	AsyncStream& stream,
+	http::advanced_message_generator rep,
+	WriteToken&& token = asio::default_token_type<AsyncStream>())
+{
+	return asio::async_initiate<WriteToken, void(asio::error_code, std::size_t)>(
+		asio::experimental::co_composed<void(asio::error_code, std::size_t)>(
+			detail::async_write_response_op{}, stream),
+		token,
+		std::ref(stream),
+		std::move(rep));
 }
 
 }
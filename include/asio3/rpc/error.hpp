@@ -45,6 +45,9 @@ namespace boost::asio::rpc
 
 		// Server error
 		server_error = -32000,
+
+		// The server is overloaded
+		overloaded = -32001,
 	};
 
 	enum class condition
@@ -72,6 +75,9 @@ namespace boost::asio::rpc
 
 		// Server error
 		server_error = -32000,
+
+		// The server is overloaded
+		overloaded = -32001,
 	};
 
 	/// The type of error category used by the library
@@ -100,6 +106,7 @@ namespace boost::asio::rpc
 			case error::invalid_params    : return "Invalid method parameter(s).";
 			case error::internal_error    : return "Internal error.";
 			case error::server_error      : return "Server error.";
+			case error::overloaded        : return "The server is overloaded, try again later.";
 			default                       : return "Unknown error";
 			}
 		}
@@ -140,6 +147,7 @@ namespace boost::asio::rpc
 		case error::invalid_params    : return "Invalid method parameter(s).";
 		case error::internal_error    : return "Internal error.";
 		case error::server_error      : return "Server error.";
+		case error::overloaded        : return "The server is overloaded, try again later.";
 		default                       : return "Unknown error";
 		}
 		return "Unknown error";
@@ -20,6 +20,7 @@
 #include <asio3/core/strutil.hpp>
 #include <asio3/core/stdutil.hpp>
 #include <asio3/core/netutil.hpp>
+#include <asio3/core/admission_controller.hpp>
 
 #include <asio3/rpc/serialization.hpp>
 #include <asio3/rpc/message.hpp>
@@ -40,6 +41,7 @@ namespace boost::asio::rpc
 		using self = basic_invoker<SerializerT, DeserializerT, Ts...>;
 		using serializer_type = SerializerT;
 		using deserializer_type = DeserializerT;
+		using admission_type = asio::admission_controller;
 		using function_type = std::function<
 			asio::awaitable<std::string>(serializer_type&, deserializer_type&, rpc::header, Ts...)>;
 
@@ -231,8 +233,57 @@ namespace boost::asio::rpc
 		#endif
 		}
 
+		/**
+		 * @brief invoke the binded rpc function with admission control.
+		 * If the request has been queued longer than the admission controller allows, it is
+		 * answered with the rpc::error::overloaded immediately, and the function is not called.
+		 * @param parsed_time - The time point when the request was parsed.
+		 */
+		template<typename... TS>
+		inline asio::awaitable<std::tuple<asio::error_code, std::string>> invoke(
+			std::chrono::steady_clock::time_point parsed_time,
+			auto&& sr, auto&& dr, rpc::header head, auto&& data, TS&&... ts)
+		{
+			auto now = std::chrono::steady_clock::now();
+
+			if (this->admission_.admit(now - parsed_time, now))
+			{
+				return this->invoke(
+					std::forward_like<decltype(sr)>(sr),
+					std::forward_like<decltype(dr)>(dr),
+					std::move(head),
+					std::forward_like<decltype(data)>(data),
+					std::forward<TS>(ts)...);
+			}
+
+			return this->_shed(sr, std::move(head));
+		}
+
+		/**
+		 * @brief get the admission controller
+		 */
+		inline admission_type& get_admission_controller()
+		{
+			return this->admission_;
+		}
+
+	protected:
+		inline static asio::awaitable<std::tuple<asio::error_code, std::string>> _shed(
+			auto& sr, rpc::header head)
+		{
+			head.type = rpc::response_mark;
+
+			sr.reset();
+			sr << head;
+			sr << rpc::make_error_code(rpc::error::overloaded);
+
+			co_return std::tuple{ rpc::make_error_code(rpc::error::overloaded), sr.str() };
+		}
+
 	protected:
 		std::unordered_map<std::string, std::shared_ptr<function_type>> invokers_;
+
+		admission_type                                                  admission_;
 	};
 
 	using invoker = basic_invoker<rpc::serializer, rpc::deserializer>;
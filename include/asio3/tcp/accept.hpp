@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2017-2023 zhllxt
+ *
+ * author   : zhllxt
+ * email    : 37792738@qq.com
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <limits>
+
+#include <asio3/core/predef.h>
+#include <asio3/core/asio.hpp>
+#include <asio3/core/netutil.hpp>
+#include <asio3/core/with_lock.hpp>
+#include <asio3/core/timer.hpp>
+#include <asio3/tcp/core.hpp>
+
+#if !ASIO3_OS_WINDOWS
+#	include <fcntl.h>
+#	include <unistd.h>
+#endif
+
+#ifdef ASIO_STANDALONE
+namespace asio
+#else
+namespace boost::asio
+#endif
+{
+	struct tcp_accept_option
+	{
+		// When the count of the connections reaches this value, the server stops accepting,
+		// and the pending connections are left in the listen backlog until a session exits.
+		std::size_t max_connections = (std::numeric_limits<std::size_t>::max)();
+
+		// How many connections are accepted at most for each readiness event of the acceptor.
+		std::size_t max_accepts_per_wakeup = 64;
+
+		// The backoff duration after an accept failure, it is doubled for each successive
+		// failure until the max_backoff, and reset to min_backoff after a successful accept.
+		std::chrono::steady_clock::duration min_backoff = std::chrono::milliseconds(1);
+		std::chrono::steady_clock::duration max_backoff = std::chrono::milliseconds(1000);
+	};
+
+	/**
+	 * @brief The accept statistics of a listener.
+	 * All the fields are only modified in the acceptor's executor.
+	 */
+	struct tcp_accept_metrics
+	{
+		// The total number of accepted connections.
+		std::uint64_t accepted = 0;
+
+		// The total number of failed accept operations.
+		std::uint64_t failed = 0;
+
+		// The connections which are dropped immediately because the file descriptors are exhausted.
+		std::uint64_t dropped = 0;
+
+		// How many times the accepting was paused because of the max_connections limit.
+		std::uint64_t paused = 0;
+
+		// The count of the sessions that are running currently.
+		std::size_t   connections = 0;
+
+		/**
+		 * @brief Get the accepted connections per second.
+		 * The rate is computed when it's read, over the time since the last computing, but
+		 * not more often than once a second, so it drops to zero after the traffic stops.
+		 * Must be called in the acceptor's executor.
+		 */
+		inline double accept_rate() noexcept
+		{
+			auto now = std::chrono::steady_clock::now();
+			auto elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(now - this->window_start_);
+			if (elapsed >= std::chrono::seconds(1))
+			{
+				this->accept_rate_ = double(this->accepted - this->window_accepted_) / elapsed.count();
+
+				this->window_start_ = now;
+				this->window_accepted_ = this->accepted;
+			}
+
+			return this->accept_rate_;
+		}
+
+	protected:
+		std::chrono::steady_clock::time_point window_start_ = std::chrono::steady_clock::now();
+
+		std::uint64_t                         window_accepted_ = 0;
+
+		double                                accept_rate_ = 0.0;
+	};
+}
+
+#ifdef ASIO_STANDALONE
+namespace asio::detail
+#else
+namespace boost::asio::detail
+#endif
+{
+	template<typename = void>
+	inline bool is_descriptor_exhausted(const asio::error_code& ec) noexcept
+	{
+		return ec == asio::error::no_descriptors ||
+			(ec.category() == asio::error::get_system_category() && ec.value() == ENFILE);
+	}
+
+	/**
+	 * @brief A reserved file descriptor, when the process runs out of file descriptors (EMFILE),
+	 * the reserved descriptor is released temporarily to accept and close the pending connection,
+	 * otherwise the acceptor will be readable all the time and the accept loop will be spinning.
+	 */
+	struct spare_descriptor
+	{
+	#if !ASIO3_OS_WINDOWS
+		int fd = -1;
+
+		spare_descriptor() noexcept
+		{
+			fd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+		}
+
+		~spare_descriptor()
+		{
+			if (fd != -1)
+				::close(fd);
+		}
+
+		spare_descriptor(const spare_descriptor&) = delete;
+		spare_descriptor& operator=(const spare_descriptor&) = delete;
+
+		inline bool shed(auto& acceptor) noexcept
+		{
+			if (fd == -1)
+				return false;
+
+			::close(fd);
+			fd = -1;
+
+			asio::error_code ec{};
+			auto sock = acceptor.accept(ec);
+			if (!ec)
+			{
+				sock.shutdown(asio::socket_base::shutdown_both, ec);
+				sock.close(ec);
+			}
+
+			fd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+
+			return true;
+		}
+	#else
+		inline bool shed(auto&) noexcept
+		{
+			return false;
+		}
+	#endif
+	};
+
+	struct tcp_async_serve_op
+	{
+		auto operator()(auto state, auto server_ref, auto&& session_factory) -> void
+		{
+			auto& server = server_ref.get();
+			auto& acceptor = server.acceptor;
+			auto& option = server.accept_option;
+			auto& metrics = server.accept_metrics;
+
+			using server_type = std::remove_cvref_t<decltype(server)>;
+			using socket_type = typename server_type::socket_type;
+
+			auto factory = std::forward_like<decltype(session_factory)>(session_factory);
+
+			co_await asio::dispatch(asio::use_deferred_executor(acceptor));
+
+			state.reset_cancellation_state(asio::enable_terminal_cancellation());
+
+			detail::spare_descriptor spare{};
+
+			asio::error_code ec{};
+
+			// the sync accept below must return would_block instead of blocking when the
+			// backlog is empty, it has no effect on the async accept.
+			acceptor.non_blocking(true, ec);
+
+			// the timer is a member of the server, so the backoff is cancelled by the async_stop.
+			auto& backoff_timer = server.accept_backoff;
+
+			auto backoff = option.min_backoff;
+
+			auto start_session = [&server, &factory](auto&& sock) mutable
+			{
+				++server.accept_metrics.accepted;
+				++server.accept_metrics.connections;
+
+				asio::co_spawn(server.get_executor(), factory(socket_type(std::move(sock))),
+				[&server](std::exception_ptr) mutable
+				{
+					--server.accept_metrics.connections;
+
+					// wake up the accept loop if it is paused by the max_connections limit.
+					asio::cancel_timer(server.accept_gate);
+				});
+			};
+
+			while (acceptor.is_open())
+			{
+				if (!!state.cancelled())
+					co_return asio::error_code{ asio::error::operation_aborted };
+
+				if (metrics.connections >= option.max_connections)
+				{
+					++metrics.paused;
+
+					server.accept_gate.expires_at((asio::steady_timer::time_point::max)());
+
+					co_await server.accept_gate.async_wait(asio::use_deferred_executor(server.accept_gate));
+
+					continue;
+				}
+
+				auto [e1, client] = co_await acceptor.async_accept(asio::use_deferred_executor(acceptor));
+				if (e1)
+				{
+					if (!acceptor.is_open() || e1 == asio::error::operation_aborted)
+						break;
+
+					++metrics.failed;
+
+					if (detail::is_descriptor_exhausted(e1) && spare.shed(acceptor))
+					{
+						++metrics.dropped;
+					}
+
+					backoff_timer.expires_after(backoff);
+
+					co_await backoff_timer.async_wait(asio::use_deferred_executor(backoff_timer));
+
+					backoff = (std::min)(backoff * 2, option.max_backoff);
+
+					continue;
+				}
+
+				backoff = option.min_backoff;
+
+				start_session(std::move(client));
+
+				// Drain the connections which are already in the backlog without waiting for
+				// another readiness event.
+				for (std::size_t i = 1; i < option.max_accepts_per_wakeup; ++i)
+				{
+					if (metrics.connections >= option.max_connections)
+						break;
+
+					auto sock = acceptor.accept(ec);
+					if (ec)
+					{
+						if (detail::is_descriptor_exhausted(ec) && spare.shed(acceptor))
+						{
+							++metrics.failed;
+							++metrics.dropped;
+						}
+						break;
+					}
+
+					start_session(std::move(sock));
+				}
+			}
+
+			co_return asio::error_code{};
+		}
+	};
+}
@@ -13,6 +13,7 @@
 #include <asio3/core/io_context_thread.hpp>
 #include <asio3/core/session_map.hpp>
 #include <asio3/tcp/listen.hpp>
+#include <asio3/tcp/accept.hpp>
 #include <asio3/tcp/tcp_session.hpp>
 
 #ifdef ASIO_STANDALONE
@@ -28,7 +29,7 @@ namespace boost::asio
 		using session_type = SessionT;
 		using socket_type = typename SessionT::socket_type;
 
-		explicit basic_tcp_server(const auto& ex) : acceptor(ex), session_map(ex)
+		explicit basic_tcp_server(const auto& ex) : acceptor(ex), session_map(ex), accept_gate(ex), accept_backoff(ex)
 		{
 		}
 
@@ -55,6 +56,34 @@ namespace boost::asio
 				std::forward<ListenToken>(token));
 		}
 
+		/**
+		 * @brief Asynchronously accept the clients until the server is stopped.
+		 * Connections are accepted in batches for each readiness event, the accepting is paused
+		 * while the count of the sessions reaches the accept_option.max_connections, and accept
+		 * failures (e.g. EMFILE) are retried with exponential backoff.
+		 * @param session_factory - The function which is called with each accepted socket, it
+		 *    must return an awaitable that runs the whole session, the session is counted as
+		 *    closed when the awaitable is completed. eg:
+		 *    @code
+		 *    [](asio::tcp_socket sock) -> asio::awaitable<void> {}
+		 *    @endcode
+		 * @param token - The completion handler to invoke when the operation completes.
+		 *	  The equivalent function signature of the handler must be:
+		 *    @code
+		 *    void handler(const asio::error_code& ec);
+		 */
+		template<typename ServeToken = asio::default_token_type<asio::tcp_acceptor>>
+		inline auto async_serve(
+			auto&& session_factory,
+			ServeToken&& token = asio::default_token_type<asio::tcp_acceptor>())
+		{
+			return asio::async_initiate<ServeToken, void(error_code)>(
+				experimental::co_composed<void(error_code)>(
+					detail::tcp_async_serve_op{}, acceptor),
+				token, std::ref(*this),
+				std::forward_like<decltype(session_factory)>(session_factory));
+		}
+
 		/**
 		 * @brief Asynchronously stop the server.
 		 */
@@ -73,6 +102,8 @@ namespace boost::asio
 						error_code ec{};
 						self.acceptor.close(ec);
 						asio::reset_lock(self.acceptor);
+						asio::cancel_timer(self.accept_gate);
+						asio::cancel_timer(self.accept_backoff);
 
 						co_await self.session_map.async_disconnect_all(asio::use_deferred_executor(self));
 
@@ -151,6 +182,16 @@ namespace boost::asio
 		asio::tcp_acceptor  acceptor;
 
 		session_map<session_type> session_map;
+
+		tcp_accept_option         accept_option{};
+
+		tcp_accept_metrics        accept_metrics{};
+
+		// used to wake up the accept loop when it is paused by the max_connections limit.
+		asio::steady_timer        accept_gate;
+
+		// the accept loop sleeps on it after an accept failure.
+		asio::steady_timer        accept_backoff;
 	};
 
 	using tcp_server = basic_tcp_server<tcp_session>;
@@ -10,6 +10,8 @@
 
 #pragma once
 
+#include <cstdint>
+
 #include <asio3/core/asio.hpp>
 #include <asio3/core/netutil.hpp>
 #include <asio3/core/with_lock.hpp>
@@ -17,6 +19,13 @@
 #include <asio3/core/data_persist.hpp>
 #include <asio3/tcp/core.hpp>
 
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <cerrno>
+#endif
+
 #ifdef ASIO_STANDALONE
 namespace asio::detail
 #else
@@ -45,6 +54,84 @@ namespace boost::asio::detail
 			co_return{ e1, n1 };
 		}
 	};
+
+	struct tcp_async_sendfile_op
+	{
+		auto operator()(
+			auto state, auto sock_ref, auto file_handle, std::uint64_t offset, std::uint64_t count) -> void
+		{
+			auto& sock = sock_ref.get();
+
+			co_await asio::dispatch(asio::use_deferred_executor(sock));
+
+			state.reset_cancellation_state(asio::enable_terminal_cancellation());
+
+			std::uint64_t sent_bytes = 0;
+
+		#if defined(__linux__)
+
+			// sendfile must not block the thread. the mode of the socket isn't changed here, a read
+			// can be pending on it concurrently. asio puts the socket in its internal non-blocking
+			// mode when an async operation is started on it, so if it isn't non-blocking yet, wait
+			// for the writable state once to let asio do it.
+			if (!(::fcntl(sock.native_handle(), F_GETFL, 0) & O_NONBLOCK))
+			{
+				auto [e1] = co_await sock.async_wait(
+					asio::socket_base::wait_write, asio::use_deferred_executor(sock));
+				if (e1)
+					co_return{ e1, 0 };
+
+				// the io_uring backend doesn't use the non-blocking mode.
+				if (!(::fcntl(sock.native_handle(), F_GETFL, 0) & O_NONBLOCK))
+					co_return{ asio::error::operation_not_supported, 0 };
+			}
+
+			off_t off = static_cast<off_t>(offset);
+
+			while (sent_bytes < count)
+			{
+				if (!!state.cancelled())
+					co_return{ asio::error::operation_aborted, static_cast<std::size_t>(sent_bytes) };
+
+				// the kernel sends at most 0x7ffff000 bytes in one call.
+				std::size_t n = static_cast<std::size_t>((std::min)(count - sent_bytes, std::uint64_t(0x7ffff000)));
+
+				ssize_t r = ::sendfile(sock.native_handle(), file_handle, &off, n);
+				if (r > 0)
+				{
+					sent_bytes += static_cast<std::uint64_t>(r);
+					continue;
+				}
+
+				// the file is shorter than the count, it's truncated after the size was got.
+				if (r == 0)
+					co_return{ asio::error::eof, static_cast<std::size_t>(sent_bytes) };
+
+				if (errno == EINTR)
+					continue;
+
+				if (errno == EAGAIN || errno == EWOULDBLOCK)
+				{
+					auto [e1] = co_await sock.async_wait(
+						asio::socket_base::wait_write, asio::use_deferred_executor(sock));
+					if (e1)
+						co_return{ e1, static_cast<std::size_t>(sent_bytes) };
+					continue;
+				}
+
+				co_return{ error_code(errno, asio::error::get_system_category()), static_cast<std::size_t>(sent_bytes) };
+			}
+
+			co_return{ error_code{}, static_cast<std::size_t>(sent_bytes) };
+		#else
+			std::ignore = file_handle;
+			std::ignore = offset;
+			std::ignore = count;
+
+			co_return{ asio::error::operation_not_supported, static_cast<std::size_t>(sent_bytes) };
+		#endif
+		}
+	};
 }
 
 #ifdef ASIO_STANDALONE
@@ -121,4 +208,39 @@ inline auto async_send(
 		detail::data_persist(std::forward_like<decltype(data)>(data)));
 }
 
+/**
+ * @brief Start an asynchronous operation to write a part of a file to a tcp socket with sendfile,
+ * the data is copied from the page cache to the socket by the kernel without user space buffers.
+ * It's only supported on linux, otherwise the error is operation_not_supported.
+ * The writes of the socket are not serialized by this function, no other write can be in progress.
+ * @param sock - The socket to which the data is to be written.
+ * @param file_handle - The native handle of the file which the data is to be read from.
+ * @param offset - The offset of the data in the file.
+ * @param count - The size of the data.
+ * @param token - The completion handler to invoke when the operation completes.
+ *	  The equivalent function signature of the handler must be:
+ *    @code
+ *    void handler(const asio::error_code& ec, std::size_t sent_bytes);
+ */
+template<
+	typename AsyncStream,
+	typename SendToken = asio::default_token_type<AsyncStream>>
+requires (is_basic_stream_socket<AsyncStream> && is_tcp_socket<AsyncStream>)
+inline auto async_sendfile(
+	AsyncStream& sock,
+	auto file_handle,
+	std::uint64_t offset,
+	std::uint64_t count,
+	SendToken&& token = asio::default_token_type<AsyncStream>())
+{
+	return async_initiate<SendToken, void(asio::error_code, std::size_t)>(
+		experimental::co_composed<void(asio::error_code, std::size_t)>(
+			detail::tcp_async_sendfile_op{}, sock),
+		token,
+		std::ref(sock),
+		file_handle,
+		offset,
+		count);
+}
+
 }
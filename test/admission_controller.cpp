@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2017-2023 zhllxt
+ *
+ * author   : zhllxt
+ * email    : 37792738@qq.com
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <asio3/core/admission_controller.hpp>
+
+#include "unit_test.hpp"
+
+#ifdef ASIO_STANDALONE
+namespace net = ::asio;
+#else
+namespace net = boost::asio;
+#endif
+
+using namespace std::chrono_literals;
+
+using time_point = net::admission_controller::time_point;
+using duration = net::admission_controller::duration;
+
+// target 5ms, interval 100ms.
+net::admission_option enabled_option()
+{
+	return net::admission_option{ .enabled = true };
+}
+
+// drive the controller with n requests of the same queue delay, evenly spread in [begin, end),
+// and return the count of the admitted requests.
+std::size_t drive(net::admission_controller& ac, time_point begin, time_point end, std::size_t n, duration delay)
+{
+	std::size_t admitted = 0;
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		if (ac.admit(delay, begin + (end - begin) * i / n))
+			++admitted;
+	}
+	return admitted;
+}
+
+// all the requests are admitted when the controller is disabled.
+void test_disabled()
+{
+	net::admission_controller ac;
+
+	time_point t0 = net::admission_controller::clock_type::now();
+
+	ASIO3_CHECK_EQUAL(drive(ac, t0, t0 + 1s, 1000, 1s), 1000u);
+	ASIO3_CHECK_EQUAL(ac.dropped_count(), 0u);
+}
+
+// a burst which is shorter than the interval is absorbed.
+void test_burst()
+{
+	net::admission_controller ac(enabled_option());
+
+	time_point t0 = net::admission_controller::clock_type::now();
+
+	// the queue is drained in the middle of the interval.
+	ASIO3_CHECK_EQUAL(drive(ac, t0, t0 + 50ms, 100, 50ms), 100u);
+	ASIO3_CHECK_EQUAL(drive(ac, t0 + 50ms, t0 + 100ms, 100, 1ms), 100u);
+	ASIO3_CHECK_EQUAL(drive(ac, t0 + 100ms, t0 + 200ms, 100, 50ms), 100u);
+	ASIO3_CHECK_EQUAL(ac.dropped_count(), 0u);
+}
+
+// under a standing queue, every request which is queued longer than the target is shed,
+// whatever the request rate is.
+void test_standing_queue()
+{
+	for (std::size_t rate : { 10u, 1000u, 100000u })
+	{
+		net::admission_controller ac(enabled_option());
+
+		time_point t0 = net::admission_controller::clock_type::now();
+
+		// the first interval, the delay is above the target, but nothing is known yet.
+		ASIO3_CHECK_EQUAL(drive(ac, t0, t0 + 100ms, rate, 20ms), rate);
+
+		// the next intervals, all the late requests are shed, the prompt ones are admitted.
+		ASIO3_CHECK_EQUAL(drive(ac, t0 + 100ms, t0 + 200ms, rate, 20ms), 0u);
+		ASIO3_CHECK_EQUAL(drive(ac, t0 + 200ms, t0 + 300ms, rate, 20ms), 0u);
+		ASIO3_CHECK(ac.admit(1ms, t0 + 300ms - 1ns));
+		ASIO3_CHECK_EQUAL(ac.dropped_count(), rate * 2);
+	}
+}
+
+// the shedding stops after an interval whose minimum delay is below the target.
+void test_recovery()
+{
+	net::admission_controller ac(enabled_option());
+
+	time_point t0 = net::admission_controller::clock_type::now();
+
+	drive(ac, t0, t0 + 100ms, 100, 20ms);
+	ASIO3_CHECK_EQUAL(drive(ac, t0 + 100ms, t0 + 200ms, 100, 20ms), 0u);
+
+	// the shedding drains the queue, the delay drops below the target.
+	ASIO3_CHECK_EQUAL(drive(ac, t0 + 200ms, t0 + 300ms, 100, 2ms), 100u);
+
+	// a new burst is absorbed again.
+	ASIO3_CHECK_EQUAL(drive(ac, t0 + 300ms, t0 + 400ms, 100, 20ms), 100u);
+	ASIO3_CHECK_EQUAL(drive(ac, t0 + 400ms, t0 + 500ms, 100, 20ms), 0u);
+}
+
+// no request in a whole interval means the queue was empty, the old delays are forgotten.
+void test_idle()
+{
+	net::admission_controller ac(enabled_option());
+
+	time_point t0 = net::admission_controller::clock_type::now();
+
+	drive(ac, t0, t0 + 100ms, 100, 20ms);
+
+	ASIO3_CHECK(ac.admit(20ms, t0 + 350ms));
+	ASIO3_CHECK_EQUAL(ac.dropped_count(), 0u);
+}
+
+int main()
+{
+	test_disabled();
+	test_burst();
+	test_standing_queue();
+	test_recovery();
+	test_idle();
+
+	return ASIO3_TEST_RESULT();
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2017-2023 zhllxt
+ *
+ * author   : zhllxt
+ * email    : 37792738@qq.com
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <asio3/http/file_cache.hpp>
+
+#include <string>
+
+#include "unit_test.hpp"
+
+// parse the ranges, and return them like "0-1,5-9", or "invalid" if the header is ignored,
+// or "" if none of the ranges is satisfiable.
+std::string parse(std::string_view value, std::uint64_t size, std::size_t max_ranges = 16)
+{
+	auto ranges = http::parse_byte_ranges(value, size, max_ranges);
+	if (!ranges)
+		return "invalid";
+
+	std::string r;
+	for (auto& range : *ranges)
+	{
+		if (!r.empty())
+			r += ',';
+		r += std::to_string(range.first);
+		r += '-';
+		r += std::to_string(range.last);
+	}
+	return r;
+}
+
+// the first-last ranges, the last is clamped to the size.
+void test_ranges()
+{
+	ASIO3_CHECK_EQUAL(parse("bytes=0-0", 10), "0-0");
+	ASIO3_CHECK_EQUAL(parse("bytes=0-9", 10), "0-9");
+	ASIO3_CHECK_EQUAL(parse("bytes=2-100", 10), "2-9");
+	ASIO3_CHECK_EQUAL(parse("bytes=5-", 10), "5-9");
+	ASIO3_CHECK_EQUAL(parse("BYTES=1-2", 10), "1-2");
+	ASIO3_CHECK_EQUAL(parse(" bytes=1-2, 4 - 5 ", 10), "1-2,4-5");
+
+	// the unsatisfiable ranges are skipped.
+	ASIO3_CHECK_EQUAL(parse("bytes=10-20", 10), "");
+	ASIO3_CHECK_EQUAL(parse("bytes=10-20,0-1", 10), "0-1");
+
+	// the last is before the first.
+	ASIO3_CHECK_EQUAL(parse("bytes=5-4", 10), "invalid");
+}
+
+// the suffix ranges are the last n bytes of the file.
+void test_suffix()
+{
+	ASIO3_CHECK_EQUAL(parse("bytes=-3", 10), "7-9");
+	ASIO3_CHECK_EQUAL(parse("bytes=-10", 10), "0-9");
+	ASIO3_CHECK_EQUAL(parse("bytes=-100", 10), "0-9");
+	ASIO3_CHECK_EQUAL(parse("bytes=-0", 10), "");
+	ASIO3_CHECK_EQUAL(parse("bytes=-", 10), "invalid");
+	ASIO3_CHECK_EQUAL(parse("bytes=--1", 10), "invalid");
+}
+
+// none of the ranges of the empty file is satisfiable.
+void test_empty_file()
+{
+	ASIO3_CHECK_EQUAL(parse("bytes=5-", 0), "");
+	ASIO3_CHECK_EQUAL(parse("bytes=0-", 0), "");
+	ASIO3_CHECK_EQUAL(parse("bytes=0-0", 0), "");
+	ASIO3_CHECK_EQUAL(parse("bytes=-5", 0), "");
+}
+
+// the numbers which may overflow are invalid.
+void test_overlong_numbers()
+{
+	ASIO3_CHECK_EQUAL(parse("bytes=0-9999999999999999999", 10), "0-9");
+	ASIO3_CHECK_EQUAL(parse("bytes=0-99999999999999999999", 10), "invalid");
+	ASIO3_CHECK_EQUAL(parse("bytes=99999999999999999999-", 10), "invalid");
+	ASIO3_CHECK_EQUAL(parse("bytes=-99999999999999999999", 10), "invalid");
+	ASIO3_CHECK_EQUAL(parse("bytes=00000000000000000001-2", 10), "invalid");
+	ASIO3_CHECK_EQUAL(parse("bytes=1x-2", 10), "invalid");
+	ASIO3_CHECK_EQUAL(parse("bytes=+1-2", 10), "invalid");
+}
+
+// more ranges than the max_ranges are ignored as a whole.
+void test_max_ranges()
+{
+	ASIO3_CHECK_EQUAL(parse("bytes=0-0,1-1,2-2", 10, 3), "0-0,1-1,2-2");
+	ASIO3_CHECK_EQUAL(parse("bytes=0-0,1-1,2-2,3-3", 10, 3), "invalid");
+
+	// the unsatisfiable ranges are counted too.
+	ASIO3_CHECK_EQUAL(parse("bytes=20-,21-,22-,0-0", 10, 3), "invalid");
+
+	// the empty elements are not counted.
+	ASIO3_CHECK_EQUAL(parse("bytes=0-0,,,1-1,,2-2", 10, 3), "0-0,1-1,2-2");
+}
+
+// the empty elements of the list are allowed, but the list must have one range at least.
+void test_empty_elements()
+{
+	ASIO3_CHECK_EQUAL(parse("bytes=0-1,,5-6", 10), "0-1,5-6");
+	ASIO3_CHECK_EQUAL(parse("bytes=,0-1", 10), "0-1");
+	ASIO3_CHECK_EQUAL(parse("bytes=0-1, ,", 10), "0-1");
+	ASIO3_CHECK_EQUAL(parse("bytes=,", 10), "invalid");
+	ASIO3_CHECK_EQUAL(parse("bytes= , ", 10), "invalid");
+	ASIO3_CHECK_EQUAL(parse("bytes=", 10), "invalid");
+	ASIO3_CHECK_EQUAL(parse("items=0-1", 10), "invalid");
+	ASIO3_CHECK_EQUAL(parse("", 10), "invalid");
+}
+
+int main()
+{
+	test_ranges();
+	test_suffix();
+	test_empty_file();
+	test_overlong_numbers();
+	test_max_ranges();
+	test_empty_elements();
+
+	return ASIO3_TEST_RESULT();
+}
@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) 2017-2023 zhllxt
+ *
+ * author   : zhllxt
+ * email    : 37792738@qq.com
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <asio3/http/hpack.hpp>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "unit_test.hpp"
+
+using header_list = std::vector<std::pair<std::string, std::string>>;
+
+// convert the hex string of the examples of RFC 7541 to the bytes, the spaces are skipped.
+std::string unhex(std::string_view hex)
+{
+	auto nibble = [](char c) -> int
+	{
+		return c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10;
+	};
+
+	std::string r;
+	for (std::size_t i = 0; i < hex.size();)
+	{
+		if (hex[i] == ' ')
+		{
+			++i;
+			continue;
+		}
+		r.push_back(static_cast<char>(nibble(hex[i]) * 16 + nibble(hex[i + 1])));
+		i += 2;
+	}
+	return r;
+}
+
+// decode the header block, and return the fields, or "error" if the block is invalid.
+header_list decode(http::hpack_decoder& decoder, std::string_view block)
+{
+	header_list fields;
+
+	if (!decoder.decode(block, [&fields](std::string_view name, std::string_view value)
+		{
+			fields.emplace_back(name, value);
+		}))
+		return { { "error", "" } };
+
+	return fields;
+}
+
+// RFC 7541 Appendix C.2, the literal header field representations.
+void test_literal()
+{
+	{
+		http::hpack_decoder decoder;
+
+		ASIO3_CHECK(decode(decoder, unhex("400a 6375 7374 6f6d 2d6b 6579 0d63 7573 746f 6d2d 6865 6164 6572")) ==
+			(header_list{ { "custom-key", "custom-header" } }));
+		ASIO3_CHECK_EQUAL(decoder.table().size(), 55u);
+	}
+
+	{
+		http::hpack_decoder decoder;
+
+		ASIO3_CHECK(decode(decoder, unhex("040c 2f73 616d 706c 652f 7061 7468")) ==
+			(header_list{ { ":path", "/sample/path" } }));
+		ASIO3_CHECK_EQUAL(decoder.table().size(), 0u);
+	}
+
+	{
+		http::hpack_decoder decoder;
+
+		ASIO3_CHECK(decode(decoder, unhex("1008 7061 7373 776f 7264 0673 6563 7265 74")) ==
+			(header_list{ { "password", "secret" } }));
+		ASIO3_CHECK_EQUAL(decoder.table().size(), 0u);
+	}
+
+	{
+		http::hpack_decoder decoder;
+
+		ASIO3_CHECK(decode(decoder, unhex("82")) == (header_list{ { ":method", "GET" } }));
+		ASIO3_CHECK_EQUAL(decoder.table().size(), 0u);
+	}
+}
+
+// RFC 7541 Appendix C.3 and C.4, the requests on one connection, without and with huffman.
+void test_requests()
+{
+	std::vector<std::string> blocks[2] = {
+		{
+			unhex("8286 8441 0f77 7777 2e65 7861 6d70 6c65 2e63 6f6d"),
+			unhex("8286 84be 5808 6e6f 2d63 6163 6865"),
+			unhex("8287 85bf 400a 6375 7374 6f6d 2d6b 6579 0c63 7573 746f 6d2d 7661 6c75 65"),
+		},
+		{
+			unhex("8286 8441 8cf1 e3c2 e5f2 3a6b a0ab 90f4 ff"),
+			unhex("8286 84be 5886 a8eb 1064 9cbf"),
+			unhex("8287 85bf 4088 25a8 49e9 5ba9 7d7f 8925 a849 e95b b8e8 b4bf"),
+		},
+	};
+
+	for (auto& block : blocks)
+	{
+		http::hpack_decoder decoder;
+
+		ASIO3_CHECK(decode(decoder, block[0]) == (header_list{
+			{ ":method", "GET" }, { ":scheme", "http" }, { ":path", "/" }, { ":authority", "www.example.com" } }));
+		ASIO3_CHECK_EQUAL(decoder.table().size(), 57u);
+
+		ASIO3_CHECK(decode(decoder, block[1]) == (header_list{
+			{ ":method", "GET" }, { ":scheme", "http" }, { ":path", "/" }, { ":authority", "www.example.com" },
+			{ "cache-control", "no-cache" } }));
+		ASIO3_CHECK_EQUAL(decoder.table().size(), 110u);
+
+		ASIO3_CHECK(decode(decoder, block[2]) == (header_list{
+			{ ":method", "GET" }, { ":scheme", "https" }, { ":path", "/index.html" },
+			{ ":authority", "www.example.com" }, { "custom-key", "custom-value" } }));
+		ASIO3_CHECK_EQUAL(decoder.table().size(), 164u);
+
+		auto* e = decoder.table().get(62);
+		ASIO3_CHECK(e && e->first == "custom-key" && e->second == "custom-value");
+		e = decoder.table().get(64);
+		ASIO3_CHECK(e && e->first == ":authority" && e->second == "www.example.com");
+		ASIO3_CHECK(decoder.table().get(65) == nullptr);
+	}
+}
+
+// RFC 7541 Appendix C.6, the responses with huffman, the table of 256 bytes evicts the
+// oldest entries.
+void test_responses()
+{
+	http::hpack_decoder decoder;
+
+	decoder.table().resize(256);
+
+	ASIO3_CHECK(decode(decoder, unhex(
+		"4882 6402 5885 aec3 771a 4b61 96d0 7abe 9410 54d4 44a8 2005 9504 0b81 66e0 82a6"
+		"2d1b ff6e 919d 29ad 1718 63c7 8f0b 97c8 e9ae 82ae 43d3")) == (header_list{
+		{ ":status", "302" }, { "cache-control", "private" }, { "date", "Mon, 21 Oct 2013 20:13:21 GMT" },
+		{ "location", "https://www.example.com" } }));
+	ASIO3_CHECK_EQUAL(decoder.table().size(), 222u);
+
+	ASIO3_CHECK(decode(decoder, unhex("4883 640e ffc1 c0bf")) == (header_list{
+		{ ":status", "307" }, { "cache-control", "private" }, { "date", "Mon, 21 Oct 2013 20:13:21 GMT" },
+		{ "location", "https://www.example.com" } }));
+	ASIO3_CHECK_EQUAL(decoder.table().size(), 222u);
+
+	ASIO3_CHECK(decode(decoder, unhex(
+		"88c1 6196 d07a be94 1054 d444 a820 0595 040b 8166 e084 a62d 1bff c05a 839b d9ab"
+		"77ad 94e7 821d d7f2 e6c7 b335 dfdf cd5b 3960 d5af 2708 7f36 72c1 ab27 0fb5 291f"
+		"9587 3160 65c0 03ed 4ee5 b106 3d50 07")) == (header_list{
+		{ ":status", "200" }, { "cache-control", "private" }, { "date", "Mon, 21 Oct 2013 20:13:22 GMT" },
+		{ "location", "https://www.example.com" }, { "content-encoding", "gzip" },
+		{ "set-cookie", "foo=ASDJKHQKBZXOQWEOPIUAXQWEOIU; max-age=3600; version=1" } }));
+	ASIO3_CHECK_EQUAL(decoder.table().size(), 215u);
+}
+
+// the padding of a huffman string is the most significant bits of the EOS, and shorter than
+// 8 bits, the EOS itself must not be decoded, RFC 7541 section 5.2.
+void test_huffman()
+{
+	std::string out;
+
+	ASIO3_CHECK(http::detail::hpack_huffman_decode(unhex("f1e3 c2e5 f23a 6ba0 ab90 f4ff"), out));
+	ASIO3_CHECK_EQUAL(out, "www.example.com");
+
+	for (std::string_view s : { "", "a", "no-cache", "custom-key", "\x01\xff\x7f" })
+	{
+		std::string encoded, decoded;
+		http::detail::hpack_huffman_encode(s, encoded);
+		ASIO3_CHECK(http::detail::hpack_huffman_decode(encoded, decoded));
+		ASIO3_CHECK_EQUAL(decoded, s);
+	}
+
+	// "a" is 00011, the padding is 111.
+	out.clear();
+	ASIO3_CHECK(http::detail::hpack_huffman_decode(unhex("1f"), out));
+	ASIO3_CHECK_EQUAL(out, "a");
+
+	// the padding which isn't all ones.
+	out.clear();
+	ASIO3_CHECK(!http::detail::hpack_huffman_decode(unhex("18"), out));
+
+	// the padding which is 8 bits or longer.
+	out.clear();
+	ASIO3_CHECK(!http::detail::hpack_huffman_decode(unhex("f1e3 c2e5 f23a 6ba0 ab90 f4ff ff"), out));
+
+	out.clear();
+	ASIO3_CHECK(!http::detail::hpack_huffman_decode(unhex("ff"), out));
+
+	// the EOS (30 ones) in the string.
+	out.clear();
+	ASIO3_CHECK(!http::detail::hpack_huffman_decode(unhex("ffff ffff"), out));
+
+	out.clear();
+	ASIO3_CHECK(!http::detail::hpack_huffman_decode(unhex("1fff ffff ff"), out));
+
+	// the huffman string in a header block.
+	http::hpack_decoder decoder;
+	ASIO3_CHECK(decode(decoder, unhex("0081 1881 1f")) == (header_list{ { "error", "" } }));
+	ASIO3_CHECK(decode(decoder, unhex("0081 1f81 1f")) == (header_list{ { "a", "a" } }));
+}
+
+// the dynamic table size update, RFC 7541 section 4.2 and 6.3.
+void test_table_size_update()
+{
+	auto update = [](std::uint64_t size)
+	{
+		std::string r;
+		http::detail::hpack_encode_integer(r, 0x20, 5, size);
+		return r;
+	};
+
+	std::string first = unhex("8286 8441 0f77 7777 2e65 7861 6d70 6c65 2e63 6f6d");
+
+	{
+		http::hpack_decoder decoder;
+
+		ASIO3_CHECK(decode(decoder, first).size() == 4);
+		ASIO3_CHECK_EQUAL(decoder.table().size(), 57u);
+
+		// the table is emptied by the size 0, the entry 62 is gone.
+		ASIO3_CHECK(decode(decoder, update(0) + unhex("82")) == (header_list{ { ":method", "GET" } }));
+		ASIO3_CHECK_EQUAL(decoder.table().size(), 0u);
+		ASIO3_CHECK_EQUAL(decoder.table().max_size(), 0u);
+		ASIO3_CHECK(decode(decoder, unhex("be")) == (header_list{ { "error", "" } }));
+	}
+
+	{
+		http::hpack_decoder decoder;
+
+		// more than one update at the beginning of the block, the last one wins.
+		ASIO3_CHECK(decode(decoder, update(0) + update(4096) + first).size() == 4);
+		ASIO3_CHECK_EQUAL(decoder.table().max_size(), 4096u);
+		ASIO3_CHECK_EQUAL(decoder.table().size(), 57u);
+
+		// the size which evicts the oldest entries.
+		ASIO3_CHECK(decode(decoder, update(60) + unhex("be")) == (header_list{ { ":authority", "www.example.com" } }));
+		ASIO3_CHECK_EQUAL(decoder.table().size(), 57u);
+	}
+
+	{
+		http::hpack_decoder decoder(256);
+
+		// the size beyond the SETTINGS_HEADER_TABLE_SIZE is a decoding error.
+		ASIO3_CHECK(decode(decoder, update(257)) == (header_list{ { "error", "" } }));
+	}
+
+	{
+		http::hpack_decoder decoder;
+
+		// the update after a field is a decoding error.
+		ASIO3_CHECK(decode(decoder, unhex("82") + update(0)) == (header_list{ { "error", "" } }));
+	}
+}
+
+// the truncated and the invalid blocks are decoding errors.
+void test_invalid()
+{
+	http::hpack_decoder decoder;
+
+	header_list error{ { "error", "" } };
+
+	// the index 0, and the index beyond the tables.
+	ASIO3_CHECK(decode(decoder, unhex("80")) == error);
+	ASIO3_CHECK(decode(decoder, unhex("be")) == error);
+
+	// the truncated integer, string and huffman string.
+	ASIO3_CHECK(decode(decoder, unhex("ff")) == error);
+	ASIO3_CHECK(decode(decoder, unhex("400a 6375 7374")) == error);
+	ASIO3_CHECK(decode(decoder, unhex("0085 f1e3")) == error);
+
+	// the integer which overflows.
+	ASIO3_CHECK(decode(decoder, unhex("ff ffff ffff ffff 0f")) == error);
+}
+
+int main()
+{
+	test_literal();
+	test_requests();
+	test_responses();
+	test_huffman();
+	test_table_size_update();
+	test_invalid();
+
+	return ASIO3_TEST_RESULT();
+}
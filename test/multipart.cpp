@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2017-2023 zhllxt
+ *
+ * author   : zhllxt
+ * email    : 37792738@qq.com
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <asio3/http/multipart.hpp>
+
+#include <string>
+#include <vector>
+
+#include "unit_test.hpp"
+
+const std::string body =
+	"preamble\r\n"
+	"--xyz\r\n"
+	"Content-Disposition: form-data; name=\"a\"\r\n"
+	"\r\n"
+	"1\r\n--xy\r\n-xyz2\r\n"
+	"--xyz\r\n"
+	"Content-Disposition: form-data; name=\"f\"; filename=\"a;b.txt\"\r\n"
+	"Content-Type: text/plain\r\n"
+	"\r\n"
+	"\r\r\n\r\n-\r\n--\r\n--x\r\n"
+	"--xyz--\r\n"
+	"epilogue";
+
+const std::string expected = "begin a;data 1\r\n--xy\r\n-xyz2;end;"
+	"begin f a;b.txt text/plain;data \r\r\n\r\n-\r\n--\r\n--x;end;done";
+
+// feed the pieces to the reader one by one, and return the events like "begin a;data x;end;done",
+// the data of the successive part_data events are joined, "error" is appended if the reader
+// fails, and "incomplete" if all the pieces are consumed before the done event.
+std::string parse(const std::vector<std::string_view>& pieces, std::size_t header_limit = 16 * 1024)
+{
+	http::multipart_reader reader("xyz", header_limit);
+
+	std::string input, r, data;
+	std::size_t next = 0;
+
+	for (;;)
+	{
+		std::size_t consumed = 0;
+		beast::error_code ec{};
+
+		auto ev = reader.parse(input, consumed, ec);
+
+		if (ec)
+			return r + "error";
+
+		if (ev != http::multipart_reader::event::part_data && ev != http::multipart_reader::event::need_more &&
+			!data.empty())
+		{
+			r += "data " + data + ";";
+			data.clear();
+		}
+
+		switch (ev)
+		{
+		case http::multipart_reader::event::part_begin:
+		{
+			auto& part = reader.part();
+			r += "begin ";
+			r += part.name;
+			if (!part.filename.empty())
+				r += " " + std::string(part.filename);
+			if (!part.content_type.empty())
+				r += " " + std::string(part.content_type);
+			r += ";";
+		}
+		break;
+		case http::multipart_reader::event::part_data:
+			data += reader.data();
+			break;
+		case http::multipart_reader::event::part_end:
+			r += "end;";
+			break;
+		case http::multipart_reader::event::done:
+			return r + "done";
+		case http::multipart_reader::event::need_more:
+			input.erase(0, consumed);
+			if (next == pieces.size())
+				return r + (data.empty() ? "" : "data " + data + ";") + "incomplete";
+			input += pieces[next++];
+			continue;
+		}
+
+		// the part and the data are views of the input, they are handled before the consumed
+		// bytes are removed.
+		input.erase(0, consumed);
+	}
+}
+
+// the body which is fed at once, and byte by byte.
+void test_whole()
+{
+	ASIO3_CHECK_EQUAL(parse({ body }), expected);
+
+	std::vector<std::string_view> bytes;
+	for (std::size_t i = 0; i < body.size(); ++i)
+		bytes.emplace_back(std::string_view(body).substr(i, 1));
+
+	ASIO3_CHECK_EQUAL(parse(bytes), expected);
+}
+
+// the delimiters and the CRLFCRLF are split at every offset.
+void test_split()
+{
+	std::string_view s = body;
+
+	bool all = true;
+	for (std::size_t i = 0; i <= s.size(); ++i)
+	{
+		for (std::size_t j = i; j <= s.size(); j += 7)
+		{
+			all = all && parse({ s.substr(0, i), s.substr(i, j - i), s.substr(j) }) == expected;
+		}
+	}
+	ASIO3_CHECK(all);
+}
+
+// the first boundary without the preamble, and the parts without headers or body.
+void test_no_preamble()
+{
+	ASIO3_CHECK_EQUAL(parse({ "--xyz\r\n\r\nv\r\n--xyz\r\n\r\n\r\n--xyz--" }), "begin ;data v;end;begin ;end;done");
+
+	// the preamble which looks like the boundary.
+	ASIO3_CHECK_EQUAL(parse({ "--xy\r\n--xyz\r\n\r\nv\r\n--xyz--" }), "begin ;data v;end;done");
+}
+
+// the transport padding is allowed after the boundary.
+void test_transport_padding()
+{
+	ASIO3_CHECK_EQUAL(parse({ "--xyz \t \r\n\r\nv\r\n--xyz\t\r\n\r\nw\r\n--xyz--" }), "begin ;data v;end;begin ;data w;end;done");
+
+	// the padding which isn't followed by the CRLF.
+	ASIO3_CHECK_EQUAL(parse({ "--xyz x\r\n\r\nv\r\n--xyz--" }), "error");
+
+	// the padding which never ends is limited by the header_limit.
+	ASIO3_CHECK_EQUAL(parse({ "--xyz", std::string(100, ' ') }, 64), "error");
+}
+
+// the body which ends before the close delimiter.
+void test_missing_close_delimiter()
+{
+	ASIO3_CHECK_EQUAL(parse({ "--xyz\r\n\r\nv\r\n--xyz\r\n" }), "begin ;data v;end;incomplete");
+	ASIO3_CHECK_EQUAL(parse({ "--xyz\r\n\r\nv\r\n" }), "begin ;data v;incomplete");
+	ASIO3_CHECK_EQUAL(parse({ "--xyz\r\n\r\nv\r\n--xyz-" }), "begin ;data v;end;incomplete");
+	ASIO3_CHECK_EQUAL(parse({ "no boundary at all" }), "incomplete");
+	ASIO3_CHECK_EQUAL(parse({ "" }), "incomplete");
+}
+
+// the headers of a part are limited by the header_limit.
+void test_header_limit()
+{
+	std::string name(40, 'n');
+	std::string part = "--xyz\r\nContent-Disposition: form-data; name=\"" + name + "\"\r\n\r\nv\r\n--xyz--";
+
+	ASIO3_CHECK_EQUAL(parse({ part }, 128), "begin " + name + ";data v;end;done");
+	ASIO3_CHECK_EQUAL(parse({ part }, 64), "error");
+
+	// the headers which are fed piece by piece.
+	std::vector<std::string_view> bytes;
+	for (std::size_t i = 0; i < part.size(); ++i)
+		bytes.emplace_back(std::string_view(part).substr(i, 1));
+
+	ASIO3_CHECK_EQUAL(parse(bytes, 128), "begin " + name + ";data v;end;done");
+	ASIO3_CHECK_EQUAL(parse(bytes, 64), "error");
+
+	// the headers which never end.
+	ASIO3_CHECK_EQUAL(parse({ "--xyz\r\nContent-Type: ", std::string(100, 'x') }, 64), "error");
+}
+
+// the headers which are malformed.
+void test_bad_header()
+{
+	ASIO3_CHECK_EQUAL(parse({ "--xyz\r\nno colon\r\n\r\nv\r\n--xyz--" }), "error");
+	ASIO3_CHECK_EQUAL(parse({ "--xyz\r\nContent-Disposition: form-data; name=\"a\r\n\r\nv\r\n--xyz--" }), "error");
+}
+
+int main()
+{
+	test_whole();
+	test_split();
+	test_no_preamble();
+	test_transport_padding();
+	test_missing_close_delimiter();
+	test_header_limit();
+	test_bad_header();
+
+	return ASIO3_TEST_RESULT();
+}
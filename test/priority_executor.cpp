@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2017-2023 zhllxt
+ *
+ * author   : zhllxt
+ * email    : 37792738@qq.com
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <asio3/core/priority_executor.hpp>
+
+#include <string>
+#include <thread>
+
+#include "unit_test.hpp"
+
+#ifdef ASIO_STANDALONE
+namespace net = ::asio;
+#else
+namespace net = boost::asio;
+#endif
+
+// the handlers which are queued before the io_context runs are executed by priority.
+void test_ordering()
+{
+	net::io_context ctx;
+	net::priority_scheduler sched(ctx.get_executor());
+
+	std::string order;
+
+	for (char c : std::string("abc"))
+		net::post(sched.get_executor(net::priority::low), [&order, c]() { order += c; });
+	for (char c : std::string("ABC"))
+		net::post(sched.get_executor(net::priority::high), [&order, c]() { order += c; });
+
+	ASIO3_CHECK_EQUAL(sched.queued_count(net::priority::low), 3u);
+	ASIO3_CHECK_EQUAL(sched.queued_count(net::priority::high), 3u);
+
+	ctx.run();
+
+	ASIO3_CHECK_EQUAL(order, "ABCabc");
+	ASIO3_CHECK_EQUAL(sched.queued_count(net::priority::low), 0u);
+}
+
+// a low priority handler is executed after "fairness" high priority handlers in a row.
+void test_fairness()
+{
+	net::io_context ctx;
+	net::priority_scheduler sched(ctx.get_executor(), 2);
+
+	std::string order;
+
+	for (char c : std::string("ab"))
+		net::post(sched.get_executor(net::priority::low), [&order, c]() { order += c; });
+	for (char c : std::string("ABCDE"))
+		net::post(sched.get_executor(net::priority::high), [&order, c]() { order += c; });
+
+	ctx.run();
+
+	ASIO3_CHECK_EQUAL(order, "ABaCDbE");
+}
+
+// the handlers which are posted by a running handler are ordered too.
+void test_nested()
+{
+	net::io_context ctx;
+	net::priority_scheduler sched(ctx.get_executor());
+
+	std::string order;
+
+	net::post(sched.get_executor(), [&]()
+	{
+		order += 'x';
+		net::post(sched.get_executor(net::priority::low), [&order]() { order += 'l'; });
+		net::post(sched.get_executor(net::priority::high), [&order]() { order += 'h'; });
+	});
+
+	ctx.run();
+
+	ASIO3_CHECK_EQUAL(order, "xhl");
+}
+
+// the move only handlers are accepted.
+void test_move_only()
+{
+	net::io_context ctx;
+	net::priority_scheduler sched(ctx.get_executor());
+
+	int value = 0;
+	auto p = std::make_unique<int>(42);
+
+	net::post(sched.get_executor(net::priority::high), [&value, p = std::move(p)]() { value = *p; });
+
+	ctx.run();
+
+	ASIO3_CHECK_EQUAL(value, 42);
+}
+
+// the executor which is required with outstanding_work.tracked keeps the io_context running.
+void test_outstanding_work()
+{
+	net::io_context ctx;
+	net::priority_scheduler sched(ctx.get_executor());
+
+	auto untracked = sched.get_executor(net::priority::high);
+	auto tracked = net::require(untracked, net::execution::outstanding_work.tracked);
+
+	ASIO3_CHECK(net::query(untracked, net::execution::outstanding_work) ==
+		net::execution::outstanding_work.untracked);
+	ASIO3_CHECK(net::query(tracked, net::execution::outstanding_work) ==
+		net::execution::outstanding_work.tracked);
+	ASIO3_CHECK(tracked.get_priority() == net::priority::high);
+
+	bool done = false;
+
+	std::thread t([&ctx]() { ctx.run(); });
+
+	// the io_context can't run out of work while the tracked executor is alive.
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	ASIO3_CHECK(!ctx.stopped());
+
+	net::post(tracked, [&done]() { done = true; });
+
+	{
+		auto released = std::move(tracked);
+	}
+
+	t.join();
+
+	ASIO3_CHECK(done);
+	ASIO3_CHECK(ctx.stopped());
+}
+
+// the priority executor can be used through any_io_executor, eg: by co_spawn.
+void test_any_io_executor()
+{
+	net::io_context ctx;
+	net::priority_scheduler sched(ctx.get_executor());
+
+	net::any_io_executor ex = sched.get_executor(net::priority::high);
+
+	bool done = false;
+
+	net::co_spawn(ex, [&done]() -> net::awaitable<void>
+	{
+		co_await net::post(net::use_awaitable);
+		done = true;
+	}, net::detached);
+
+	ctx.run();
+
+	ASIO3_CHECK(done);
+}
+
+int main()
+{
+	test_ordering();
+	test_fairness();
+	test_nested();
+	test_move_only();
+	test_outstanding_work();
+	test_any_io_executor();
+
+	return ASIO3_TEST_RESULT();
+}
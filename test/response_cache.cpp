@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2017-2023 zhllxt
+ *
+ * author   : zhllxt
+ * email    : 37792738@qq.com
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <asio3/http/router.hpp>
+
+#include <string>
+
+#include "unit_test.hpp"
+
+#ifdef ASIO_STANDALONE
+namespace net = ::asio;
+#else
+namespace net = boost::asio;
+#endif
+
+using router_type = http::basic_router<http::web_request, http::web_response>;
+
+// the compressible body of the cached route.
+const std::string text(4096, 'a');
+
+http::web_request make_request(std::string_view accept_encoding)
+{
+	http::web_request req(http::verb::get, "/text", 11);
+	if (!accept_encoding.empty())
+		req.set(http::field::accept_encoding, accept_encoding);
+	return req;
+}
+
+std::string content_encoding(http::web_response& rep)
+{
+	auto& h = rep.get_response_header();
+	auto it = h.find(http::field::content_encoding);
+	return it == h.end() ? std::string() : std::string(it->value());
+}
+
+// the cached route which compresses the response by the Accept-Encoding of the request.
+void add_text_route(router_type& router, int& calls, bool delay = false)
+{
+	router.add("/text", [&calls, delay](http::web_request& req, http::web_response& rep) -> net::awaitable<bool>
+	{
+		++calls;
+
+		if (delay)
+		{
+			net::steady_timer t(co_await net::this_coro::executor);
+			t.expires_after(std::chrono::milliseconds(50));
+			co_await t.async_wait(net::use_awaitable);
+		}
+
+		rep = http::make_compressed_response(req, http::make_text_response(text));
+
+		co_return true;
+	}, http::enable_cache);
+}
+
+// two requests which differ only in the Accept-Encoding are cached apart.
+void test_accept_encoding()
+{
+	net::io_context ctx;
+
+	router_type router;
+
+	int calls = 0;
+	add_text_route(router, calls);
+
+	std::vector<std::string> codings;
+
+	net::co_spawn(ctx, [&]() -> net::awaitable<void>
+	{
+		for (std::string_view ae : { "gzip", "", "gzip", "", "deflate, gzip;q=0" })
+		{
+			http::web_request req = make_request(ae);
+			http::web_response rep;
+
+			co_await router.route(req, rep);
+
+			codings.emplace_back(content_encoding(rep));
+		}
+	}, net::detached);
+
+	ctx.run();
+
+	ASIO3_CHECK(codings == (std::vector<std::string>{ "gzip", "", "gzip", "", "deflate" }));
+
+	// one call for each content coding, the others are served by the cache.
+	ASIO3_CHECK_EQUAL(calls, 3);
+	ASIO3_CHECK_EQUAL(router.get_cache().get_count(), 3u);
+}
+
+// the concurrent requests which differ only in the Accept-Encoding don't share the flight.
+void test_single_flight()
+{
+	net::io_context ctx;
+
+	router_type router;
+
+	int calls = 0;
+	add_text_route(router, calls, true);
+
+	std::vector<std::string> codings(4);
+
+	for (std::size_t i = 0; i < codings.size(); ++i)
+	{
+		net::co_spawn(ctx, [&, i]() -> net::awaitable<void>
+		{
+			http::web_request req = make_request(i % 2 ? "" : "gzip");
+			http::web_response rep;
+
+			// the requests arrive while the first two are being handled.
+			net::steady_timer t(ctx);
+			t.expires_after(std::chrono::milliseconds(i));
+			co_await t.async_wait(net::use_awaitable);
+
+			co_await router.route(req, rep);
+
+			codings[i] = content_encoding(rep);
+		}, net::detached);
+	}
+
+	ctx.run();
+
+	ASIO3_CHECK(codings == (std::vector<std::string>{ "gzip", "", "gzip", "" }));
+	ASIO3_CHECK_EQUAL(calls, 2);
+}
+
+// the response which sets a cookie, or varies with the other request fields, isn't stored.
+void test_not_shareable()
+{
+	http::cache cache;
+
+	auto make = [](http::field f, std::string_view value)
+	{
+		http::response<http::string_body> res = http::make_text_response(text);
+		if (f != http::field::unknown)
+			res.set(f, value);
+		return http::make_serialized_response(res);
+	};
+
+	ASIO3_CHECK(cache.add("/a", make(http::field::unknown, "")));
+	ASIO3_CHECK(cache.add("/b", make(http::field::vary, "Accept-Encoding")));
+	ASIO3_CHECK(!cache.add("/c", make(http::field::vary, "Accept-Encoding, Cookie")));
+	ASIO3_CHECK(!cache.add("/d", make(http::field::vary, "*")));
+	ASIO3_CHECK(!cache.add("/e", make(http::field::set_cookie, "id=1")));
+
+	ASIO3_CHECK_EQUAL(cache.get_count(), 2u);
+}
+
+// the key contains the content coding which is selected by the Accept-Encoding.
+void test_cache_key()
+{
+	ASIO3_CHECK_EQUAL(http::make_cache_key(make_request("")), "/text");
+	ASIO3_CHECK_EQUAL(http::make_cache_key(make_request("br")), "/text");
+	ASIO3_CHECK_EQUAL(http::make_cache_key(make_request("gzip, deflate")), "/text gzip");
+	ASIO3_CHECK_EQUAL(http::make_cache_key(make_request("deflate")), "/text deflate");
+}
+
+int main()
+{
+	test_accept_encoding();
+	test_single_flight();
+	test_not_shareable();
+	test_cache_key();
+
+	return ASIO3_TEST_RESULT();
+}
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2017-2023 zhllxt
+ *
+ * author   : zhllxt
+ * email    : 37792738@qq.com
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <asio3/http/route_tree.hpp>
+
+#include <string>
+#include <vector>
+
+#include "unit_test.hpp"
+
+// match the path, and return the value of the route and the captured values joined by ','.
+template<class Tree>
+std::string match(Tree& tree, std::string_view path)
+{
+	http::path_params params;
+
+	auto* p = tree.match(path, params);
+	if (!p)
+		return "404";
+
+	std::string r = *p;
+	for (auto& param : params)
+	{
+		r += ',';
+		r += param.name;
+		r += '=';
+		r += param.value;
+	}
+	return r;
+}
+
+// the static routes which share the prefix are split into the child nodes.
+void test_prefix_split()
+{
+	http::basic_route_tree<std::string> tree;
+
+	ASIO3_CHECK(tree.insert("/user", "user"));
+	ASIO3_CHECK(tree.insert("/users", "users"));
+	ASIO3_CHECK(tree.insert("/use", "use"));
+	ASIO3_CHECK(tree.insert("/u", "u"));
+	ASIO3_CHECK(tree.insert("/user/list", "list"));
+	ASIO3_CHECK(tree.insert("/user/login", "login"));
+	ASIO3_CHECK(!tree.insert("/user", "dup"));
+
+	ASIO3_CHECK_EQUAL(tree.size(), 6u);
+
+	ASIO3_CHECK_EQUAL(match(tree, "/user"), "user");
+	ASIO3_CHECK_EQUAL(match(tree, "/users"), "users");
+	ASIO3_CHECK_EQUAL(match(tree, "/use"), "use");
+	ASIO3_CHECK_EQUAL(match(tree, "/u"), "u");
+	ASIO3_CHECK_EQUAL(match(tree, "/user/list"), "list");
+	ASIO3_CHECK_EQUAL(match(tree, "/user/login"), "login");
+	ASIO3_CHECK_EQUAL(match(tree, "/us"), "404");
+	ASIO3_CHECK_EQUAL(match(tree, "/user/lo"), "404");
+	ASIO3_CHECK_EQUAL(match(tree, "/user/logins"), "404");
+	ASIO3_CHECK_EQUAL(match(tree, ""), "404");
+
+	ASIO3_CHECK(tree.find_exact("/user/login") && *tree.find_exact("/user/login") == "login");
+	ASIO3_CHECK(!tree.find_exact("/user/log"));
+
+	std::vector<std::string> paths;
+	tree.for_each_static([&paths](std::string_view path, std::string&) { paths.emplace_back(path); });
+	ASIO3_CHECK_EQUAL(paths.size(), 6u);
+}
+
+// the static text takes precedence over the ":param", which takes precedence over the "*tail".
+void test_precedence()
+{
+	http::basic_route_tree<std::string> tree;
+
+	tree.insert("/user/:id", "param");
+	tree.insert("/user/list", "static");
+	tree.insert("/user/*", "tail");
+	tree.insert("/user/:id/books/:book", "book");
+	tree.insert("/user/*/photos", "photos");
+
+	ASIO3_CHECK_EQUAL(match(tree, "/user/list"), "static");
+	ASIO3_CHECK_EQUAL(match(tree, "/user/42"), "param,id=42");
+	ASIO3_CHECK_EQUAL(match(tree, "/user/lis"), "param,id=lis");
+	ASIO3_CHECK_EQUAL(match(tree, "/user/listing"), "param,id=listing");
+	ASIO3_CHECK_EQUAL(match(tree, "/user/42/x/y"), "tail,=42/x/y");
+	ASIO3_CHECK_EQUAL(match(tree, "/user/42/books/7"), "book,id=42,book=7");
+	ASIO3_CHECK_EQUAL(match(tree, "/user/42/photos"), "photos,=42");
+
+	// the ":param" doesn't match the empty segment.
+	ASIO3_CHECK_EQUAL(match(tree, "/user/"), "tail,=");
+}
+
+// a failed ":param" branch is backtracked to the "*tail" of the parent node.
+void test_backtrack()
+{
+	http::basic_route_tree<std::string> tree;
+
+	tree.insert("/a/:x/c", "c");
+	tree.insert("/a/*rest", "rest");
+
+	ASIO3_CHECK_EQUAL(match(tree, "/a/b/c"), "c,x=b");
+	ASIO3_CHECK_EQUAL(match(tree, "/a/b/d"), "rest,rest=b/d");
+	ASIO3_CHECK_EQUAL(match(tree, "/a/b"), "rest,rest=b");
+}
+
+// "/files/*" matches "/files", whether the "/" is a child of its own or not.
+void test_catch_all_at_split()
+{
+	{
+		http::basic_route_tree<std::string> tree;
+
+		tree.insert("/files/*", "files");
+
+		ASIO3_CHECK_EQUAL(match(tree, "/files"), "files,=");
+		ASIO3_CHECK_EQUAL(match(tree, "/files/a/b"), "files,=a/b");
+	}
+
+	{
+		http::basic_route_tree<std::string> tree;
+
+		tree.insert("/files/*", "files");
+		tree.insert("/filesystem", "fs");
+
+		ASIO3_CHECK_EQUAL(match(tree, "/files"), "files,=");
+		ASIO3_CHECK_EQUAL(match(tree, "/files/a/b"), "files,=a/b");
+		ASIO3_CHECK_EQUAL(match(tree, "/filesystem"), "fs");
+		ASIO3_CHECK_EQUAL(match(tree, "/filesys"), "404");
+	}
+
+	{
+		http::basic_route_tree<std::string> tree;
+
+		tree.insert("/filesystem", "fs");
+		tree.insert("/files/*", "files");
+
+		ASIO3_CHECK_EQUAL(match(tree, "/files"), "files,=");
+		ASIO3_CHECK_EQUAL(match(tree, "/filesystem"), "fs");
+	}
+
+	{
+		http::basic_route_tree<std::string> tree;
+
+		tree.insert("/fil", "fil");
+		tree.insert("/files/*", "files");
+
+		ASIO3_CHECK_EQUAL(match(tree, "/files"), "files,=");
+		ASIO3_CHECK_EQUAL(match(tree, "/fil"), "fil");
+		ASIO3_CHECK_EQUAL(match(tree, "/file"), "404");
+	}
+
+	{
+		http::basic_route_tree<std::string> tree;
+
+		// the route which ends at the split node wins over the "*tail".
+		tree.insert("/files/*", "files");
+		tree.insert("/filesystem", "fs");
+		tree.insert("/files", "exact");
+
+		ASIO3_CHECK_EQUAL(match(tree, "/files"), "exact");
+	}
+}
+
+// the frozen table finds each of the static routes by the method and the path.
+void test_frozen_table()
+{
+	http::basic_frozen_route_table<std::string> table;
+
+	ASIO3_CHECK(table.find(http::verb::get, "/") == nullptr);
+
+	std::vector<http::basic_frozen_route_table<std::string>::entry> entries;
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		std::string path = "/api/v1/item" + std::to_string(i);
+		entries.emplace_back(http::verb::get, path, "get" + std::to_string(i));
+		if (i % 3 == 0)
+			entries.emplace_back(http::verb::post, path, "post" + std::to_string(i));
+	}
+	entries.emplace_back(http::verb::get, "/", "root");
+
+	std::size_t count = entries.size();
+
+	table.build(std::move(entries));
+
+	ASIO3_CHECK_EQUAL(table.size(), count);
+
+	bool all = true;
+	for (int i = 0; i < 1000; ++i)
+	{
+		std::string path = "/api/v1/item" + std::to_string(i);
+
+		auto* g = table.find(http::verb::get, path);
+		all = all && g && *g == "get" + std::to_string(i);
+
+		auto* p = table.find(http::verb::post, path);
+		all = all && (i % 3 == 0 ? (p && *p == "post" + std::to_string(i)) : p == nullptr);
+	}
+	ASIO3_CHECK(all);
+
+	ASIO3_CHECK(table.find(http::verb::get, "/") && *table.find(http::verb::get, "/") == "root");
+	ASIO3_CHECK(table.find(http::verb::put, "/") == nullptr);
+	ASIO3_CHECK(table.find(http::verb::get, "/api/v1/item1000") == nullptr);
+	ASIO3_CHECK(table.find(http::verb::get, "/api/v1/item") == nullptr);
+	ASIO3_CHECK(table.find(http::verb::get, "") == nullptr);
+
+	table.clear();
+	ASIO3_CHECK(table.empty());
+	ASIO3_CHECK(table.find(http::verb::get, "/") == nullptr);
+}
+
+int main()
+{
+	test_prefix_split();
+	test_precedence();
+	test_backtrack();
+	test_catch_all_at_split();
+	test_frozen_table();
+
+	return ASIO3_TEST_RESULT();
+}
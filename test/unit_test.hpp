@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2017-2023 zhllxt
+ *
+ * author   : zhllxt
+ * email    : 37792738@qq.com
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <cstdio>
+
+/**
+ * @brief The minimal check macros of the tests, a failed check is printed and counted, and
+ * the test returns the count of the failed checks by ASIO3_TEST_RESULT().
+ */
+namespace asio3_test
+{
+	inline int& failures() noexcept
+	{
+		static int n = 0;
+		return n;
+	}
+}
+
+#define ASIO3_CHECK(expr)                                                               \
+	do                                                                                  \
+	{                                                                                   \
+		if (!(expr))                                                                    \
+		{                                                                               \
+			++::asio3_test::failures();                                                 \
+			std::fprintf(stderr, "%s(%d): check failed: %s\n", __FILE__, __LINE__, #expr);\
+		}                                                                               \
+	} while (false)
+
+#define ASIO3_CHECK_EQUAL(a, b) ASIO3_CHECK((a) == (b))
+
+#define ASIO3_TEST_RESULT() (::asio3_test::failures() == 0 ? 0 : 1)